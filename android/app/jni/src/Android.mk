@@ -16,15 +16,18 @@ LOCAL_SRC_FILES := \
 	$(PM_SOURCES_ROOT)/common/memory_mapped_file.cpp \
 	$(PM_SOURCES_ROOT)/maps/gps_button.cpp \
 	$(PM_SOURCES_ROOT)/maps/gps_service_android.cpp \
+	$(PM_SOURCES_ROOT)/maps/line_tessellation.cpp \
 	$(PM_SOURCES_ROOT)/maps/main.cpp \
 	$(PM_SOURCES_ROOT)/maps/main_loop.cpp \
 	$(PM_SOURCES_ROOT)/maps/map_drawer.cpp \
 	$(PM_SOURCES_ROOT)/maps/mouse_map_controller.cpp \
+	$(PM_SOURCES_ROOT)/maps/polygon_buffer_pool.cpp \
 	$(PM_SOURCES_ROOT)/maps/shaders.cpp \
 	$(PM_SOURCES_ROOT)/maps/system_window.cpp \
 	$(PM_SOURCES_ROOT)/maps/textures_generation.cpp \
 	$(PM_SOURCES_ROOT)/maps/touch_map_controller.cpp \
 	$(PM_SOURCES_ROOT)/maps/ui_drawer.cpp \
+	$(PM_SOURCES_ROOT)/maps/worker_pool.cpp \
 	$(PM_SOURCES_ROOT)/maps/zoom_controller.cpp \
 	$(PM_SOURCES_ROOT)/panzer_ogl_lib/func_addresses.cpp \
 	$(PM_SOURCES_ROOT)/panzer_ogl_lib/glsl_program.cpp \
@@ -0,0 +1,117 @@
+#include <chrono>
+#include <cmath>
+#include <random>
+#include "../common/log.hpp"
+#include "../exporter/clipping.hpp"
+
+// Benchmark of polylines and convex polygons clipping by chunk boxes, as in final export.
+// Objects are deterministic, so, results of different builds are comparable.
+
+namespace PanzerMaps
+{
+
+static const int32_t c_chunk_size= 64000;
+static const int32_t c_chunks_per_side= 4;
+static const int32_t c_area_size= c_chunk_size * c_chunks_per_side;
+
+static std::vector< std::vector<ProjectionPoint> > GeneratePolylines( const size_t count, std::mt19937& rng )
+{
+	std::vector< std::vector<ProjectionPoint> > result( count );
+	for( std::vector<ProjectionPoint>& polyline : result )
+	{
+		ProjectionPoint point{ int32_t( rng() % uint32_t(c_area_size) ), int32_t( rng() % uint32_t(c_area_size) ) };
+		const size_t vertex_count= 2u + rng() % 30u;
+		for( size_t i= 0u; i < vertex_count; ++i )
+		{
+			polyline.push_back( point );
+			point.x+= int32_t( rng() % 4001u ) - 2000;
+			point.y+= int32_t( rng() % 4001u ) - 2000;
+		}
+	}
+	return result;
+}
+
+static std::vector< std::vector<ProjectionPoint> > GenerateConvexPolygons( const size_t count, std::mt19937& rng )
+{
+	std::vector< std::vector<ProjectionPoint> > result( count );
+	for( std::vector<ProjectionPoint>& polygon : result )
+	{
+		const double center_x= double( rng() % uint32_t(c_area_size) ), center_y= double( rng() % uint32_t(c_area_size) );
+		const double radius= double( 50u + rng() % 3000u );
+		const size_t vertex_count= 4u + rng() % 9u;
+		// Clockwise regular polygon.
+		for( size_t i= 0u; i < vertex_count; ++i )
+		{
+			const double angle= -2.0 * 3.1415926535 * double(i) / double(vertex_count);
+			polygon.push_back( ProjectionPoint{ int32_t( center_x + radius * std::cos(angle) ), int32_t( center_y + radius * std::sin(angle) ) } );
+		}
+	}
+	return result;
+}
+
+static std::vector<ClipBox> GetChunkBoxes()
+{
+	std::vector<ClipBox> result;
+	for( int32_t y= 0; y < c_chunks_per_side; ++y )
+	for( int32_t x= 0; x < c_chunks_per_side; ++x )
+		result.push_back( ClipBox{ x * c_chunk_size, y * c_chunk_size, ( x + 1 ) * c_chunk_size, ( y + 1 ) * c_chunk_size } );
+	return result;
+}
+
+static double GetSecondsSince( const std::chrono::steady_clock::time_point start_time )
+{
+	return std::chrono::duration<double>( std::chrono::steady_clock::now() - start_time ).count();
+}
+
+} // namespace PanzerMaps
+
+int main()
+{
+	using namespace PanzerMaps;
+
+	const size_t c_object_count= 200000u;
+	std::mt19937 rng(42u);
+	const std::vector< std::vector<ProjectionPoint> > polylines= GeneratePolylines( c_object_count, rng );
+	const std::vector< std::vector<ProjectionPoint> > polygons= GenerateConvexPolygons( c_object_count, rng );
+	const std::vector<ClipBox> boxes= GetChunkBoxes();
+
+	// Reuse buffers for all objects, like chunk export does.
+	std::vector<ProjectionPoint> out_vertices, tmp_vertices;
+	std::vector<size_t> out_parts_end;
+
+	{
+		size_t result_vertex_count= 0u, result_part_count= 0u;
+		const auto start_time= std::chrono::steady_clock::now();
+		for( const ClipBox& box : boxes )
+		for( const std::vector<ProjectionPoint>& polyline : polylines )
+		{
+			out_vertices.clear();
+			out_parts_end.clear();
+			ClipPolyline( polyline.data(), polyline.size(), box, out_vertices, out_parts_end );
+			result_vertex_count+= out_vertices.size();
+			result_part_count+= out_parts_end.size();
+		}
+		const double time= GetSecondsSince( start_time );
+		Log::User(
+			"Polylines: ", c_object_count, " x ", boxes.size(), " boxes, ",
+			time * 1.0e9 / double( c_object_count * boxes.size() ), " ns per object and box, ",
+			result_part_count, " result parts, ", result_vertex_count, " result vertices" );
+	}
+	{
+		size_t result_vertex_count= 0u, result_polygon_count= 0u;
+		const auto start_time= std::chrono::steady_clock::now();
+		for( const ClipBox& box : boxes )
+		for( const std::vector<ProjectionPoint>& polygon : polygons )
+		{
+			ClipConvexPolygon( polygon.data(), polygon.size(), box, out_vertices, tmp_vertices );
+			result_vertex_count+= out_vertices.size();
+			if( !out_vertices.empty() )
+				++result_polygon_count;
+		}
+		const double time= GetSecondsSince( start_time );
+		Log::User(
+			"Convex polygons: ", c_object_count, " x ", boxes.size(), " boxes, ",
+			time * 1.0e9 / double( c_object_count * boxes.size() ), " ns per object and box, ",
+			result_polygon_count, " result polygons, ", result_vertex_count, " result vertices" );
+	}
+}
@@ -0,0 +1,165 @@
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include "../common/data_file.hpp"
+#include "../common/log.hpp"
+#include "../common/memory_mapped_file.hpp"
+#include "../maps/line_tessellation.hpp"
+
+// Benchmark of wide lines tessellation on real map data.
+// Runs simplification and tessellation of all wide lines of all chunks of given ".pm" file, as viewer does for chunk preparation.
+
+namespace PanzerMaps
+{
+
+struct TessellationStats
+{
+	size_t chunk_count= 0u;
+	size_t line_count= 0u;
+	size_t in_vertex_count= 0u;
+	size_t out_vertex_count= 0u;
+	size_t out_index_count= 0u;
+};
+
+static void TessellateChunk(
+	const DataFileDescription::Chunk& chunk,
+	const DataFileDescription::LinearObjectStyle* const linear_styles,
+	const float units_in_pixel,
+	LineTessellationCache& cache,
+	std::vector<DataFileDescription::ChunkVertex>& tmp_vertices,
+	std::vector<PolygonalLinearObjectVertex>& textured_vertices,
+	std::vector<ExtrudedLinearObjectVertex>& extruded_vertices,
+	std::vector<VertexIndex>& indices,
+	TessellationStats& stats )
+{
+	const unsigned char* const chunk_data= reinterpret_cast<const unsigned char*>(&chunk);
+	const auto vertices= reinterpret_cast<const DataFileDescription::ChunkVertex*>( chunk_data + chunk.vertices_offset );
+	const auto linear_object_groups= reinterpret_cast<const DataFileDescription::Chunk::LinearObjectGroup*>( chunk_data + chunk.linear_object_groups_offset );
+
+	textured_vertices.clear();
+	extruded_vertices.clear();
+	indices.clear();
+
+	for( uint16_t i= 0u; i < chunk.linear_object_groups_count; ++i )
+	{
+		const DataFileDescription::Chunk::LinearObjectGroup& group= linear_object_groups[i];
+		const DataFileDescription::LinearObjectStyle& style= linear_styles[group.style_index];
+		if( style.width_mul_256 == 0u )
+			continue;
+
+		const bool textured= TextureShaderRequired( style );
+		const float half_width= float(style.width_mul_256) / ( 256.0f * 2.0f );
+		const float pixel_half_width= half_width / units_in_pixel;
+		const float tex_coord_scale= 256.0f / float(style.dash_size_mul_256);
+
+		for( uint32_t v= group.first_vertex; v < group.first_vertex + group.vertex_count; ++v )
+		{
+			const DataFileDescription::ChunkVertex& vertex= vertices[v];
+			if( vertex.x == 65535u )
+			{
+				stats.in_vertex_count+= tmp_vertices.size();
+				++stats.line_count;
+				SimplifyLine( tmp_vertices, half_width * half_width );
+				if( !tmp_vertices.empty() )
+				{
+					if( textured )
+						CreateTexturedPolygonalLine( tmp_vertices.data(), tmp_vertices.size(), half_width, pixel_half_width, tex_coord_scale, cache, textured_vertices, indices );
+					else
+						CreateExtrudedPolygonalLine( tmp_vertices.data(), tmp_vertices.size(), group.style_index, pixel_half_width, cache, extruded_vertices, indices );
+				}
+				tmp_vertices.clear();
+			}
+			else
+				tmp_vertices.push_back( vertex );
+		}
+	}
+
+	++stats.chunk_count;
+	stats.out_vertex_count+= textured_vertices.size() + extruded_vertices.size();
+	stats.out_index_count+= indices.size();
+}
+
+static double GetSecondsSince( const std::chrono::steady_clock::time_point start_time )
+{
+	return std::chrono::duration<double>( std::chrono::steady_clock::now() - start_time ).count();
+}
+
+} // namespace PanzerMaps
+
+int main( int argc, const char* const argv[] )
+{
+	using namespace PanzerMaps;
+
+	if( argc < 2 )
+	{
+		Log::User( "Usage:\n\tLineTessellationBenchmark [map_file] [repeat_count]" );
+		return 0;
+	}
+	const size_t repeat_count= argc >= 3 ? size_t( std::max( 1, std::atoi( argv[2] ) ) ) : 4u;
+
+	const MemoryMappedFilePtr file= MemoryMappedFile::Create( argv[1] );
+	if( file == nullptr )
+	{
+		Log::FatalError( "Error, opening map file" );
+		return -1;
+	}
+	if( file->Size() < sizeof(DataFileDescription::DataFile) )
+	{
+		Log::FatalError( "Map file is too small" );
+		return -1;
+	}
+
+	const unsigned char* const file_content= static_cast<const unsigned char*>(file->Data());
+	const DataFileDescription::DataFile& data_file= *reinterpret_cast<const DataFileDescription::DataFile*>( file_content );
+	if( std::memcmp( data_file.header, DataFileDescription::DataFile::c_expected_header, sizeof(data_file.header) ) != 0 ||
+		data_file.version != DataFileDescription::DataFile::c_expected_version )
+	{
+		Log::FatalError( "Unsupported map file" );
+		return -1;
+	}
+
+	const auto zoom_levels= reinterpret_cast<const DataFileDescription::ZoomLevel*>( file_content + data_file.zoom_levels_offset );
+
+	// Buffers are reused for all chunks, like chunk preparation does.
+	LineTessellationCache cache;
+	std::vector<DataFileDescription::ChunkVertex> tmp_vertices;
+	std::vector<PolygonalLinearObjectVertex> textured_vertices;
+	std::vector<ExtrudedLinearObjectVertex> extruded_vertices;
+	std::vector<VertexIndex> indices;
+
+	// Detail of joins depends on scale, so, run benchmark for some power of two scale buckets.
+	for( int32_t scale_bucket= -1; scale_bucket <= 3; ++scale_bucket )
+	{
+		const float units_in_pixel= std::ldexp( 1.0f, scale_bucket );
+
+		TessellationStats stats;
+		const auto start_time= std::chrono::steady_clock::now();
+		for( size_t i= 0u; i < repeat_count; ++i )
+		for( uint32_t zoom_level_index= 0u; zoom_level_index < data_file.zoom_level_count; ++zoom_level_index )
+		{
+			const DataFileDescription::ZoomLevel& zoom_level= zoom_levels[zoom_level_index];
+			const auto linear_styles= reinterpret_cast<const DataFileDescription::LinearObjectStyle*>( file_content + zoom_level.linear_styles_offset );
+			const auto chunks_description= reinterpret_cast<const DataFileDescription::DataFile::ChunkDescription*>( file_content + zoom_level.chunks_description_offset );
+			for( uint32_t chunk_index= 0u; chunk_index < zoom_level.chunk_count; ++chunk_index )
+				TessellateChunk(
+					*reinterpret_cast<const DataFileDescription::Chunk*>( file_content + chunks_description[chunk_index].offset ),
+					linear_styles,
+					units_in_pixel,
+					cache,
+					tmp_vertices, textured_vertices, extruded_vertices, indices,
+					stats );
+		}
+		const double time= GetSecondsSince( start_time );
+
+		Log::User(
+			"Units in pixel ", units_in_pixel, ": ",
+			double(stats.chunk_count) / time, " chunks/s, ",
+			time * 1.0e9 / double(stats.in_vertex_count), " ns per input vertex; ",
+			stats.chunk_count / repeat_count, " chunks, ",
+			stats.line_count / repeat_count, " lines, ",
+			stats.in_vertex_count / repeat_count, " input vertices, ",
+			stats.out_vertex_count / repeat_count, " output vertices, ",
+			stats.out_index_count / repeat_count, " output indices" );
+	}
+}
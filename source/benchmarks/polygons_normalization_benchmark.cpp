@@ -0,0 +1,115 @@
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <random>
+#include "../common/log.hpp"
+#include "../exporter/geometry_utils.hpp"
+#include "../exporter/polygons_normalization_pass.hpp"
+
+// Benchmark of polygons normalization steps on corpus of generated self-intersecting rings.
+// Rings are deterministic, so, results of different builds are comparable.
+
+namespace PanzerMaps
+{
+
+enum class RingKind
+{
+	// Smooth coast with rare spikes. Few self-intersections.
+	Coastline,
+	// Very noisy circle. Number of self-intersections is comparable with number of vertices.
+	Noisy,
+};
+
+static std::vector<ProjectionPoint> GenerateRing( const RingKind kind, const size_t vertex_count, std::mt19937& rng )
+{
+	const double c_radius= 100000.0;
+
+	std::vector<ProjectionPoint> result;
+	result.reserve( vertex_count );
+	const double angle_step= 2.0 * 3.1415926535 / double(vertex_count);
+	double radius_offset= 0.0;
+	for( size_t i= 0u; i < vertex_count; ++i )
+	{
+		// Angle jitter moves vertices back over previous edges, producing self-intersections.
+		double angle= angle_step * double(i), radius;
+		switch( kind )
+		{
+		case RingKind::Coastline:
+			// Random walk of radius, sometimes - spike, looping back over neighbor edges.
+			radius_offset= 0.98 * radius_offset + std::uniform_real_distribution<double>( -2000.0, 2000.0 )(rng);
+			radius= c_radius + radius_offset;
+			if( rng() % 32u == 0u )
+			{
+				radius+= std::uniform_real_distribution<double>( -20000.0, 20000.0 )(rng);
+				angle+= angle_step * std::uniform_real_distribution<double>( -4.0, 4.0 )(rng);
+			}
+			break;
+		case RingKind::Noisy:
+			radius= c_radius + std::uniform_real_distribution<double>( 0.0, 40000.0 )(rng);
+			angle+= angle_step * std::uniform_real_distribution<double>( -3.0, 3.0 )(rng);
+			break;
+		};
+
+		ProjectionPoint point;
+		point.x= int32_t( radius * std::cos(angle) );
+		point.y= int32_t( radius * std::sin(angle) );
+		if( result.empty() || point != result.back() )
+			result.push_back( point );
+	}
+	return result;
+}
+
+static double GetSecondsSince( const std::chrono::steady_clock::time_point start_time )
+{
+	return std::chrono::duration<double>( std::chrono::steady_clock::now() - start_time ).count();
+}
+
+static void RunBenchmark( const RingKind kind, const char* const kind_name, const size_t vertex_count, const size_t ring_count )
+{
+	std::mt19937 rng( static_cast<uint32_t>(vertex_count) );
+	std::vector< std::vector<ProjectionPoint> > rings;
+	for( size_t i= 0u; i < ring_count; ++i )
+		rings.push_back( GenerateRing( kind, vertex_count, rng ) );
+
+	std::vector< std::vector<ProjectionPoint> > noncrossing_parts;
+	const auto noncrossing_start_time= std::chrono::steady_clock::now();
+	for( const std::vector<ProjectionPoint>& ring : rings )
+		for( std::vector<ProjectionPoint>& part : SplitPolygonIntoNoncrossingPartsForBenchmark( ring ) )
+			if( part.size() >= 3u )
+				noncrossing_parts.push_back( std::move(part) );
+	const double noncrossing_time= GetSecondsSince( noncrossing_start_time );
+
+	size_t convex_part_count= 0u;
+	int64_t double_area= 0;
+	const auto convex_start_time= std::chrono::steady_clock::now();
+	for( const std::vector<ProjectionPoint>& part : noncrossing_parts )
+		for( const std::vector<ProjectionPoint>& convex_part : SplitPolygonIntoConvexPartsForBenchmark( part ) )
+		{
+			++convex_part_count;
+			double_area+= CalculatePolygonDoubleSignedArea( convex_part.data(), convex_part.size() );
+		}
+	const double convex_time= GetSecondsSince( convex_start_time );
+
+	Log::User(
+		kind_name, " rings, ", vertex_count, " vertices x ", ring_count, ": ",
+		"noncrossing split ", noncrossing_time * 1000.0 / double(ring_count), " ms/ring, ", noncrossing_parts.size(), " parts; ",
+		"convex split ", convex_time * 1000.0 / double(ring_count), " ms/ring, ", convex_part_count, " parts, ",
+		"area ", std::abs(double_area) / 2 );
+}
+
+} // namespace PanzerMaps
+
+int main( int argc, const char* const argv[] )
+{
+	using namespace PanzerMaps;
+
+	// Optional argument - maximum ring size.
+	const size_t max_vertex_count= argc >= 2 ? size_t( std::max( 0, std::atoi( argv[1] ) ) ) : 4000u;
+
+	for( size_t vertex_count= 250u; vertex_count <= max_vertex_count; vertex_count*= 2u )
+	{
+		const size_t ring_count= std::max( size_t(4u), 64000u / vertex_count );
+		RunBenchmark( RingKind::Coastline, "coastline", vertex_count, ring_count );
+		RunBenchmark( RingKind::Noisy, "noisy", vertex_count, ring_count );
+	}
+}
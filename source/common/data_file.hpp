@@ -34,36 +34,56 @@ struct Chunk
 
 	using StyleIndex= uint8_t;
 
+	// Bounding box of group vertices, relative to chunk coord start. Used for culling of groups inside visible chunk.
+	struct GroupBoundingBox
+	{
+		ChunkCoordType min_x;
+		ChunkCoordType min_y;
+		ChunkCoordType max_x;
+		ChunkCoordType max_y;
+	};
+	static_assert( sizeof(GroupBoundingBox) == 8u, "wrong size" );
+
 	struct PointObjectGroup
 	{
 		StyleIndex style_index;
 		uint8_t padding[3u];
-		uint16_t first_vertex;
-		uint16_t vertex_count;
+		uint32_t first_vertex;
+		uint32_t vertex_count;
 	};
-	static_assert( sizeof(PointObjectGroup) == 8u, "wrong size" );
+	static_assert( sizeof(PointObjectGroup) == 12u, "wrong size" );
 
 	struct LinearObjectGroup
 	{
 		StyleIndex style_index;
 		uint8_t padding[1u];
 		uint16_t z_level;
-		uint16_t first_vertex;
-		uint16_t vertex_count;
+		uint32_t first_vertex;
+		uint32_t vertex_count;
 		// vertex with x= 65535 is break primitive vertex.
+		GroupBoundingBox bounding_box;
+		// Maximum extent of single line in group, in units. Group may be skipped, if it is smaller, than pixel (and line width).
+		uint16_t visible_size;
+		uint8_t padding2[2u];
 	};
-	static_assert( sizeof(LinearObjectGroup) == 8u, "wrong size" );
+	static_assert( sizeof(LinearObjectGroup) == 24u, "wrong size" );
 
 	struct ArealObjectGroup
 	{
-		uint16_t first_vertex;
-		uint16_t vertex_count;
+		uint32_t first_vertex;
+		uint32_t vertex_count;
+		uint32_t first_index;
+		uint32_t index_count;
 		uint16_t z_level;
-		uint8_t padding[2u];
-		// vertex with x= 65535 is break primitive vertex.
-		// "y" of this vertex is style index.
+		StyleIndex style_index;
+		uint8_t padding[1u];
+		// Indexed triangle list. Indices are relative to "first_vertex", so, group contains less, than 65535 vertices.
+		GroupBoundingBox bounding_box;
+		// Square root of total area of group polygons, in units. Group may be skipped, if it is smaller, than pixel.
+		uint16_t visible_size;
+		uint8_t padding2[2u];
 	};
-	static_assert( sizeof(ArealObjectGroup) == 8u, "wrong size" );
+	static_assert( sizeof(ArealObjectGroup) == 32u, "wrong size" );
 
 	GlobalCoordType coord_start_x;
 	GlobalCoordType coord_start_y;
@@ -82,13 +102,16 @@ struct Chunk
 	uint32_t linear_object_groups_offset;
 	uint32_t areal_object_groups_offset;
 	uint32_t vertices_offset;
+	uint32_t indices_offset; // uint16_t indices.
 
 	uint16_t point_object_groups_count;
 	uint16_t linear_object_groups_count;
 	uint16_t areal_object_groups_count;
-	uint16_t vertex_count;
+	uint8_t padding[2u];
+	uint32_t vertex_count;
+	uint32_t index_count;
 };
-static_assert( sizeof(Chunk) == 52u, "wrong size" );
+static_assert( sizeof(Chunk) == 64u, "wrong size" );
 
 
 using ColorRGBA= unsigned char[4];
@@ -188,7 +211,7 @@ struct DataFile
 	// All offsets - from start of file.
 
 	static constexpr const char c_expected_header[16]= "PanzerMaps-Data";
-	static constexpr const uint32_t c_expected_version= 5u; // Change this each time, when DataFileDescripton structs changed.
+	static constexpr const uint32_t c_expected_version= 8u; // Change this each time, when DataFileDescripton structs changed.
 
 	uint8_t header[16];
 	uint32_t version;
@@ -208,8 +231,13 @@ struct DataFile
 	uint32_t zoom_level_count;
 
 	CommonStyle common_style;
+
+	// Size of vertex index, required for drawing of chunks - 2 or 4 bytes.
+	// If it is 4, chunks may contain more, than 65535 vertices.
+	uint32_t vertex_index_size;
+	uint8_t padding[4u];
 };
-static_assert( sizeof(DataFile) == 96u, "wrong size" );
+static_assert( sizeof(DataFile) == 104u, "wrong size" );
 
 } // namespace DataFile
 
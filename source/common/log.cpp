@@ -7,6 +7,7 @@ namespace PanzerMaps
 {
 
 std::ofstream Log::log_file_{ "panzer_maps.log" };
+std::mutex Log::mutex_;
 
 void Log::ShowFatalMessageBox( const std::string& error_message )
 {
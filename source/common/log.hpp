@@ -3,6 +3,7 @@
 #include <fstream>
 #include <functional>
 #include <iostream>
+#include <mutex>
 #include <sstream>
 
 #ifdef __ANDROID__
@@ -13,7 +14,7 @@ namespace PanzerMaps
 {
 
 // Simple logger. You can write messages to it.
-// Not thread-safe.
+// Thread-safe - messages from different threads are not mixed.
 class Log
 {
 public:
@@ -51,6 +52,7 @@ private:
 
 private:
 	static std::ofstream log_file_;
+	static std::mutex mutex_;
 };
 
 template<class...Args>
@@ -78,12 +80,14 @@ void Log::FatalError( const Args&... args )
 	Print( stream, args... );
 	const std::string str= stream.str();
 
+	std::unique_lock<std::mutex> lock( mutex_ );
 #ifdef __ANDROID__
 	__android_log_print( ANDROID_LOG_FATAL, __FILE__, ": %s", str.c_str() );
 #else
 	std::cerr << str << std::endl;
 	log_file_ << str << std::endl;
 #endif
+	lock.unlock();
 	ShowFatalMessageBox( str );
 
 	std::exit(-1);
@@ -104,6 +108,7 @@ void Log::PrinLine( const LogLevel log_level, const Args&... args )
 	Print( stream, args... );
 	const std::string str= stream.str();
 
+	std::lock_guard<std::mutex> lock( mutex_ );
 #ifdef __ANDROID__
 	auto android_log_level= ANDROID_LOG_INFO;
 	if( log_level == LogLevel::User || log_level == LogLevel::Info )
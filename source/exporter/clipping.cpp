@@ -0,0 +1,177 @@
+#include "clipping.hpp"
+
+namespace PanzerMaps
+{
+
+enum class BoxRelation
+{
+	Inside,
+	Outside,
+	Intersects,
+};
+
+static void GetVerticesBoundingBox( const ProjectionPoint* const vertices, const size_t vertex_count, ProjectionPoint& out_min, ProjectionPoint& out_max )
+{
+	PM_ASSERT( vertex_count >= 1u );
+	out_min= out_max= vertices[0u];
+	for( size_t i= 1u; i < vertex_count; ++i )
+	{
+		out_min.x= std::min( out_min.x, vertices[i].x );
+		out_min.y= std::min( out_min.y, vertices[i].y );
+		out_max.x= std::max( out_max.x, vertices[i].x );
+		out_max.y= std::max( out_max.y, vertices[i].y );
+	}
+}
+
+static BoxRelation GetBoundingBoxRelation( const ProjectionPoint& min, const ProjectionPoint& max, const ClipBox& box )
+{
+	if( max.x < box.min_x || max.y < box.min_y || min.x > box.max_x || min.y > box.max_y )
+		return BoxRelation::Outside;
+	if( min.x >= box.min_x && min.y >= box.min_y && max.x <= box.max_x && max.y <= box.max_y )
+		return BoxRelation::Inside;
+	return BoxRelation::Intersects;
+}
+
+static BoxRelation GetVerticesBoxRelation( const ProjectionPoint* const vertices, const size_t vertex_count, const ClipBox& box )
+{
+	ProjectionPoint min, max;
+	GetVerticesBoundingBox( vertices, vertex_count, min, max );
+	return GetBoundingBoxRelation( min, max, box );
+}
+
+void ClipPolyline(
+	const ProjectionPoint* const polyline,
+	const size_t vertex_count,
+	const ClipBox& box,
+	std::vector<ProjectionPoint>& out_vertices,
+	std::vector<size_t>& out_parts_end )
+{
+	PM_ASSERT( vertex_count >= 1u );
+
+	switch( GetVerticesBoxRelation( polyline, vertex_count, box ) )
+	{
+	case BoxRelation::Outside:
+		return;
+	case BoxRelation::Inside:
+		out_vertices.insert( out_vertices.end(), polyline, polyline + vertex_count );
+		out_parts_end.push_back( out_vertices.size() );
+		return;
+	case BoxRelation::Intersects:
+		break;
+	};
+
+	static const size_t c_no_plane= ~size_t(0u);
+	bool part_started= false;
+	for( size_t i= 0u; i + 1u < vertex_count; ++i )
+	{
+		const ProjectionPoint& v0= polyline[i];
+		const ProjectionPoint& v1= polyline[i + 1u];
+
+		// Visible part of segment is v0 + ( v1 - v0 ) * t, where t in range [ t_enter, t_exit ].
+		double t_enter= 0.0, t_exit= 1.0;
+		size_t enter_plane= c_no_plane, exit_plane= c_no_plane;
+		bool visible= true;
+		for( size_t plane= 0u; plane < ClipBox::c_plane_count && visible; ++plane )
+		{
+			const int64_t dist0= box.PlaneSignedDistance( v0, plane );
+			const int64_t dist1= box.PlaneSignedDistance( v1, plane );
+			if( dist0 < 0 && dist1 < 0 )
+				visible= false;
+			else if( dist0 < 0 )
+			{
+				const double t= double(-dist0) / double( dist1 - dist0 );
+				if( t > t_enter )
+				{
+					t_enter= t;
+					enter_plane= plane;
+				}
+			}
+			else if( dist1 < 0 )
+			{
+				const double t= double(dist0) / double( dist0 - dist1 );
+				if( t < t_exit )
+				{
+					t_exit= t;
+					exit_plane= plane;
+				}
+			}
+		}
+
+		if( !visible || t_enter > t_exit )
+		{
+			if( part_started )
+			{
+				out_parts_end.push_back( out_vertices.size() );
+				part_started= false;
+			}
+			continue;
+		}
+
+		if( !part_started )
+		{
+			// Clamp intersection points, because rounding may move them outside box near corners.
+			out_vertices.push_back( enter_plane == c_no_plane ? v0 : box.Clamp( box.PlaneIntersection( v0, v1, enter_plane ) ) );
+			part_started= true;
+		}
+		out_vertices.push_back( exit_plane == c_no_plane ? v1 : box.Clamp( box.PlaneIntersection( v0, v1, exit_plane ) ) );
+		if( exit_plane != c_no_plane )
+		{
+			out_parts_end.push_back( out_vertices.size() );
+			part_started= false;
+		}
+	}
+
+	if( part_started )
+		out_parts_end.push_back( out_vertices.size() );
+}
+
+void ClipConvexPolygon(
+	const ProjectionPoint* const polygon,
+	const size_t vertex_count,
+	const ClipBox& box,
+	std::vector<ProjectionPoint>& out_polygon,
+	std::vector<ProjectionPoint>& tmp_polygon )
+{
+	PM_ASSERT( vertex_count >= 3u );
+	out_polygon.clear();
+
+	ProjectionPoint min, max;
+	GetVerticesBoundingBox( polygon, vertex_count, min, max );
+	const BoxRelation relation= GetBoundingBoxRelation( min, max, box );
+	if( relation == BoxRelation::Outside )
+		return;
+	out_polygon.insert( out_polygon.end(), polygon, polygon + vertex_count );
+	if( relation == BoxRelation::Inside )
+		return;
+
+	// Clipping result lies inside source polygon, so, planes, which source polygon does not cross, are not crossed by result too.
+	const bool plane_crossed[ClipBox::c_plane_count]= { min.x < box.min_x, max.x > box.max_x, min.y < box.min_y, max.y > box.max_y };
+	for( size_t plane= 0u; plane < ClipBox::c_plane_count; ++plane )
+	{
+		if( !plane_crossed[plane] )
+			continue;
+		tmp_polygon.clear();
+
+		int64_t prev_dist= box.PlaneSignedDistance( out_polygon.back(), plane );
+		for( size_t i= 0u; i < out_polygon.size(); ++i )
+		{
+			const ProjectionPoint& prev_vertex= out_polygon[ i == 0u ? out_polygon.size() - 1u : i - 1u ];
+			const ProjectionPoint& vertex= out_polygon[i];
+			const int64_t dist= box.PlaneSignedDistance( vertex, plane );
+			if( ( prev_dist >= 0 ) != ( dist >= 0 ) )
+				tmp_polygon.push_back( box.PlaneIntersection( prev_vertex, vertex, plane ) );
+			if( dist >= 0 )
+				tmp_polygon.push_back( vertex );
+			prev_dist= dist;
+		}
+
+		out_polygon.swap( tmp_polygon );
+		if( out_polygon.size() < 3u )
+		{
+			out_polygon.clear();
+			return;
+		}
+	}
+}
+
+} // namespace PanzerMaps
@@ -0,0 +1,74 @@
+#pragma once
+#include <algorithm>
+#include <cstdlib>
+#include <vector>
+#include "../common/assert.hpp"
+#include "../common/coordinates_conversion.hpp"
+
+namespace PanzerMaps
+{
+
+// Box for clipping, borders are inclusive.
+struct ClipBox
+{
+	int32_t min_x;
+	int32_t min_y;
+	int32_t max_x;
+	int32_t max_y;
+
+	static const size_t c_plane_count= 4u;
+
+	// Planes: min x, max x, min y, max y. Distance is positive inside box.
+	int64_t PlaneSignedDistance( const ProjectionPoint& vertex, const size_t plane ) const
+	{
+		switch( plane )
+		{
+		case 0u: return int64_t(vertex.x) - int64_t(min_x);
+		case 1u: return int64_t(max_x) - int64_t(vertex.x);
+		case 2u: return int64_t(vertex.y) - int64_t(min_y);
+		case 3u: return int64_t(max_y) - int64_t(vertex.y);
+		};
+		PM_ASSERT(false);
+		return 0;
+	}
+
+	// Intersection of segment with plane. Segment vertices must be at different sides of plane.
+	ProjectionPoint PlaneIntersection( const ProjectionPoint& v0, const ProjectionPoint& v1, const size_t plane ) const
+	{
+		const int64_t dist0= std::abs( PlaneSignedDistance( v0, plane ) );
+		const int64_t dist1= std::abs( PlaneSignedDistance( v1, plane ) );
+		const int64_t dist_sum= dist0 + dist1;
+		if( dist_sum == 0 )
+			return v0;
+
+		ProjectionPoint result;
+		result.x= int32_t( ( int64_t(v0.x) * dist1 + int64_t(v1.x) * dist0 ) / dist_sum );
+		result.y= int32_t( ( int64_t(v0.y) * dist1 + int64_t(v1.y) * dist0 ) / dist_sum );
+		return result;
+	}
+
+	ProjectionPoint Clamp( const ProjectionPoint& vertex ) const
+	{
+		return ProjectionPoint{ std::min( std::max( vertex.x, min_x ), max_x ), std::min( std::max( vertex.y, min_y ), max_y ) };
+	}
+};
+
+// Clip polyline by box, using Liang-Barsky algorithm for each segment.
+// Polyline may be splitted into several parts. Result parts are appended to "out_vertices", end of each part is appended to "out_parts_end".
+void ClipPolyline(
+	const ProjectionPoint* polyline,
+	size_t vertex_count,
+	const ClipBox& box,
+	std::vector<ProjectionPoint>& out_vertices,
+	std::vector<size_t>& out_parts_end );
+
+// Clip convex polygon by box, using Sutherland-Hodgman algorithm. Polygon is clipped only by planes, which it crosses.
+// Result is written into "out_polygon" (empty, if polygon is outside box), "tmp_polygon" is used as scratch buffer.
+void ClipConvexPolygon(
+	const ProjectionPoint* polygon,
+	size_t vertex_count,
+	const ClipBox& box,
+	std::vector<ProjectionPoint>& out_polygon,
+	std::vector<ProjectionPoint>& tmp_polygon );
+
+} // namespace PanzerMaps
@@ -8,6 +8,7 @@ namespace PanzerMaps
 
 ObjectsData TransformCoordinates(
 	const OSMParseResult& prepared_data,
+	const Styles::ZoomLevel& zoom_level,
 	const size_t additional_scale_log2 )
 {
 	ObjectsData result;
@@ -16,6 +17,8 @@ ObjectsData TransformCoordinates(
 	{
 		result.min_point.x= result.max_point.x= result.min_point.y= result.max_point.y= 0;
 		result.coordinates_scale= 1;
+		result.meters_in_unit= 1.0f;
+		result.zoom_level= additional_scale_log2;
 		return result;
 	}
 
@@ -103,23 +106,72 @@ ObjectsData TransformCoordinates(
 	result.max_point= projection.GetMaxPoint();
 	result.zoom_level= additional_scale_log2;
 
+	// Select classes, used in this zoom level. Objects of other classes will be dropped in phase sort pass, so, skip them now.
+	bool point_class_used[ size_t(PointObjectClass::Last) ]= { false };
+	bool linear_class_used[ size_t(LinearObjectClass::Last) ]= { false };
+	bool areal_class_used[ size_t(ArealObjectClass::Last) ]= { false };
+	for( const PointObjectClass object_class : zoom_level.point_classes_ordered )
+		point_class_used[ size_t(object_class) ]= true;
+	for( const LinearObjectClass object_class : zoom_level.linear_classes_ordered )
+		linear_class_used[ size_t(object_class) ]= true;
+	for( const Styles::ArealObjectPhase& phase : zoom_level.areal_object_phases )
+	for( const ArealObjectClass object_class : phase.classes )
+		areal_class_used[ size_t(object_class) ]= true;
+
+	// Replace linear classes with aliases now, before linear objects merging.
+	LinearObjectClass linear_class_alias[ size_t(LinearObjectClass::Last) ];
+	for( size_t i= 0u; i < size_t(LinearObjectClass::Last); ++i )
+		linear_class_alias[i]= static_cast<LinearObjectClass>(i);
+	for( const auto& alias : zoom_level.linear_class_aliases )
+		linear_class_alias[ size_t(alias.first) ]= alias.second;
+
 	// Start transformation.
 
-	result.point_objects.reserve( prepared_data.point_objects.size() );
-	result.linear_objects.reserve( prepared_data.linear_objects.size() );
-	result.areal_objects.reserve( prepared_data.areal_objects.size() );
+	// Reserve memory for all vertices of used objects - result can not be bigger.
+	size_t linear_object_count= 0u, linear_vertex_count= 0u;
+	for( const BaseDataRepresentation::LinearObject& in_object : prepared_data.linear_objects )
+	{
+		if( !linear_class_used[ size_t( linear_class_alias[ size_t(in_object.class_) ] ) ] )
+			continue;
+		++linear_object_count;
+		linear_vertex_count+= in_object.vertex_count;
+	}
+	size_t areal_object_count= 0u, areal_vertex_count= 0u, ring_count= 0u;
+	for( const BaseDataRepresentation::ArealObject& in_object : prepared_data.areal_objects )
+	{
+		if( !areal_class_used[ size_t(in_object.class_) ] )
+			continue;
+		++areal_object_count;
+		areal_vertex_count+= in_object.vertex_count;
+		for( uint32_t r= in_object.first_ring_index; r < in_object.first_ring_index + in_object.outer_ring_count + in_object.inner_ring_count; ++r )
+			areal_vertex_count+= prepared_data.multipolygons_rings[r].vertex_count;
+		ring_count+= in_object.outer_ring_count + in_object.inner_ring_count;
+	}
+	result.linear_objects.reserve( linear_object_count );
+	result.linear_objects_vertices.reserve( linear_vertex_count );
+	result.areal_objects.reserve( areal_object_count );
+	result.areal_objects_vertices.reserve( areal_vertex_count );
+	result.multipolygons_rings.reserve( ring_count );
 
-	result.point_objects= prepared_data.point_objects;
-	for( const GeoPoint& point_vertex : prepared_data.point_objects_vertices )
-		result.point_objects_vertices.push_back( projection.Project( point_vertex ) );
+	for( size_t i= 0u; i < prepared_data.point_objects.size(); ++i )
+	{
+		if( !point_class_used[ size_t(prepared_data.point_objects[i].class_) ] )
+			continue;
+		result.point_objects.push_back( prepared_data.point_objects[i] );
+		result.point_objects_vertices.push_back( projection.Project( prepared_data.point_objects_vertices[i] ) );
+	}
 
 	// Remove equal adjusted vertices of linear objects.
 	for( const BaseDataRepresentation::LinearObject& in_object : prepared_data.linear_objects )
 	{
+		const LinearObjectClass object_class= linear_class_alias[ size_t(in_object.class_) ];
+		if( !linear_class_used[ size_t(object_class) ] )
+			continue;
+
 		BaseDataRepresentation::LinearObject out_object;
-		out_object.class_= in_object.class_;
+		out_object.class_= object_class;
 		out_object.z_level= in_object.z_level;
-		out_object.first_vertex_index= result.linear_objects_vertices.size();
+		out_object.first_vertex_index= static_cast<ObjectsData::VertexIndex>( result.linear_objects_vertices.size() );
 		out_object.vertex_count= 1u;
 		result.linear_objects_vertices.push_back( projection.Project( prepared_data.linear_objects_vertices[ in_object.first_vertex_index ] ) );
 
@@ -139,10 +191,13 @@ ObjectsData TransformCoordinates(
 	// Remove equal adjusted vertices of areal objects. Remove too small areal objects.
 	for( const BaseDataRepresentation::ArealObject& in_object : prepared_data.areal_objects )
 	{
+		if( !areal_class_used[ size_t(in_object.class_) ] )
+			continue;
+
 		const auto transform_polygon=
-		[&]( const size_t in_first_vertex, const size_t in_vertex_count, size_t& out_first_vertex, size_t& out_vertex_count )
+		[&]( const size_t in_first_vertex, const size_t in_vertex_count, ObjectsData::VertexIndex& out_first_vertex, ObjectsData::VertexIndex& out_vertex_count )
 		{
-			out_first_vertex= result.areal_objects_vertices.size();
+			out_first_vertex= static_cast<ObjectsData::VertexIndex>( result.areal_objects_vertices.size() );
 			out_vertex_count= 1u;
 
 			result.areal_objects_vertices.push_back( projection.Project( prepared_data.areal_objects_vertices[in_first_vertex] ) );
@@ -170,43 +225,45 @@ ObjectsData TransformCoordinates(
 			}
 		};
 
-		if( in_object.multipolygon != nullptr )
+		BaseDataRepresentation::ArealObject out_object;
+		out_object.class_= in_object.class_;
+		out_object.z_level= in_object.z_level;
+		out_object.osm_id= in_object.osm_id;
+
+		if( in_object.IsMultipolygon() )
 		{
-			BaseDataRepresentation::Multipolygon out_multipolygon;
-			for( const BaseDataRepresentation::Multipolygon::Part& inner_ring : in_object.multipolygon->inner_rings )
-			{
-				BaseDataRepresentation::Multipolygon::Part out_part;
-				transform_polygon( inner_ring.first_vertex_index, inner_ring.vertex_count, out_part.first_vertex_index, out_part.vertex_count );
-				if( out_part.vertex_count > 0u )
-					out_multipolygon.inner_rings.push_back(out_part);
-			}
-			for( const BaseDataRepresentation::Multipolygon::Part& outer_ring : in_object.multipolygon->outer_rings )
-			{
-				BaseDataRepresentation::Multipolygon::Part out_part;
-				transform_polygon( outer_ring.first_vertex_index, outer_ring.vertex_count, out_part.first_vertex_index, out_part.vertex_count );
-				if( out_part.vertex_count > 0u )
-					out_multipolygon.outer_rings.push_back(out_part);
-			}
+			out_object.first_vertex_index= out_object.vertex_count= 0u;
+			out_object.first_ring_index= static_cast<uint32_t>( result.multipolygons_rings.size() );
 
-			if( !out_multipolygon.outer_rings.empty() )
+			const BaseDataRepresentation::MultipolygonRing* const in_rings= prepared_data.multipolygons_rings.data() + in_object.first_ring_index;
+			const auto transform_ring=
+			[&]( const BaseDataRepresentation::MultipolygonRing& in_ring ) -> bool
 			{
-				BaseDataRepresentation::ArealObject out_object;
-				out_object.class_= in_object.class_;
-				out_object.z_level= in_object.z_level;
-				out_object.first_vertex_index= out_object.vertex_count= 0u;
-				out_object.multipolygon.reset( new BaseDataRepresentation::Multipolygon( std::move(out_multipolygon) ) );
-				result.areal_objects.push_back( std::move(out_object) );
-			}
+				BaseDataRepresentation::MultipolygonRing out_ring;
+				transform_polygon( in_ring.first_vertex_index, in_ring.vertex_count, out_ring.first_vertex_index, out_ring.vertex_count );
+				if( out_ring.vertex_count == 0u )
+					return false;
+				result.multipolygons_rings.push_back( out_ring );
+				return true;
+			};
+
+			for( uint32_t r= 0u; r < in_object.outer_ring_count; ++r )
+				if( transform_ring( in_rings[r] ) )
+					++out_object.outer_ring_count;
+			if( out_object.outer_ring_count == 0u )
+				continue;
+
+			for( uint32_t r= in_object.outer_ring_count; r < in_object.outer_ring_count + in_object.inner_ring_count; ++r )
+				if( transform_ring( in_rings[r] ) )
+					++out_object.inner_ring_count;
+
+			result.areal_objects.push_back( out_object );
 		}
 		else
 		{
-			BaseDataRepresentation::ArealObject out_object;
-			out_object.class_= in_object.class_;
-			out_object.z_level= in_object.z_level;
-
 			transform_polygon( in_object.first_vertex_index, in_object.vertex_count, out_object.first_vertex_index, out_object.vertex_count );
 			if( out_object.vertex_count > 0u )
-				result.areal_objects.push_back( std::move(out_object) );
+				result.areal_objects.push_back( out_object );
 		}
 	} // for areal objects
 
@@ -2,6 +2,7 @@
 #include "../common/coordinates_conversion.hpp"
 #include  "../common/data_file.hpp"
 #include "primary_export.hpp"
+#include "styles.hpp"
 
 namespace PanzerMaps
 {
@@ -31,8 +32,11 @@ struct ObjectsData : BaseDataRepresentation
 	std::vector<VertexTransformed> areal_objects_vertices;
 };
 
+// Objects of classes, not used in zoom level, are skipped. Aliases of linear classes are applied.
+// Bounding box and projection are calculated for all objects, so, they are same for all zoom levels.
 ObjectsData TransformCoordinates(
 	const OSMParseResult& prepared_data,
+	const Styles::ZoomLevel& zoom_level,
 	size_t additional_scale_log2 );
 
 } // namespace PanzerMaps
@@ -1,208 +1,49 @@
 ﻿#include <algorithm>
+#include <cmath>
 #include <cstdio>
+#include <cstdlib>
 #include <cstring>
 #include <limits>
+#include <unordered_map>
 
 #include "../common/assert.hpp"
 #include "../common/data_file.hpp"
 #include "../common/log.hpp"
+#include "clipping.hpp"
 #include "final_export.hpp"
+#include "vertex_cache_optimization.hpp"
 
 namespace PanzerMaps
 {
 
 static const int32_t c_max_chunk_size= 64000; // Near to 65536
 static const int32_t c_min_chunk_size= c_max_chunk_size / 512;
+static const size_t c_max_chunk_vertices_with_32_bit_indices= 1u << 18u;
 
-static std::vector< std::vector<ProjectionPoint> > SplitPolyline(
-	const std::vector<ProjectionPoint> &polyline,
-	const int32_t distance,
-	const int32_t normal_x,
-	const int32_t normal_y )
+struct ChunkVertexHasher
 {
-	PM_ASSERT( polyline.size() >= 1u );
-	std::vector< std::vector<ProjectionPoint> > polylines;
-
-	const auto vertex_signed_plane_distance=
-	[&]( const ProjectionPoint& vertex ) -> int32_t
-	{
-		return vertex.x * normal_x + vertex.y * normal_y - distance;
-	};
-
-	const auto split_segment=
-	[&]( const size_t segment_index ) -> ProjectionPoint
-	{
-		const ProjectionPoint& v0= polyline[ segment_index ];
-		const ProjectionPoint& v1= polyline[ segment_index + 1u ];
-		const int64_t dist0= int64_t( std::abs( vertex_signed_plane_distance(v0) ) );
-		const int64_t dist1= int64_t( std::abs( vertex_signed_plane_distance(v1) ) );
-		const int64_t dist_sum= dist0 + dist1;
-		ProjectionPoint result;
-		if( dist_sum > 0 )
-		{
-			result.x= int32_t( ( int64_t(v0.x) * dist1 + int64_t(v1.x) * dist0 ) / dist_sum );
-			result.y= int32_t( ( int64_t(v0.y) * dist1 + int64_t(v1.y) * dist0 ) / dist_sum );
-		}
-		else
-			result= v0;
-
-		return result;
-	};
-
-	int32_t prev_vertex_pos= vertex_signed_plane_distance( polyline.front() );
-	std::vector<ProjectionPoint> result_polyline;
-	if( prev_vertex_pos >= 0 )
-		result_polyline.push_back( polyline.front() );
-
-	for( size_t i= 1u; i < polyline.size(); ++i )
+	size_t operator()( const DataFileDescription::ChunkVertex& v ) const
 	{
-		const int32_t cur_vertex_pos= vertex_signed_plane_distance( polyline[i] );
-			 if( prev_vertex_pos >= 0 && cur_vertex_pos >= 0 )
-			result_polyline.push_back( polyline[i] );
-		else if( prev_vertex_pos >= 0 && cur_vertex_pos < 0 )
-		{
-			result_polyline.push_back( split_segment(i-1u) );
-			PM_ASSERT( result_polyline.size() >= 2u );
-			polylines.emplace_back();
-			polylines.back().swap( result_polyline );
-		}
-		else if( prev_vertex_pos < 0 && cur_vertex_pos >= 0 )
-		{
-			result_polyline.push_back( split_segment(i-1u) );
-			result_polyline.push_back( polyline[i] );
-		}
-		else if( prev_vertex_pos < 0 && cur_vertex_pos < 0 )
-		{}
-		prev_vertex_pos= cur_vertex_pos;
+		return std::hash<uint32_t>()( uint32_t(v.x) | ( uint32_t(v.y) << 16u ) );
 	}
+};
 
-	if( result_polyline.size() >= 1u )
-		polylines.push_back( std::move( result_polyline ) );
+static const DataFileDescription::Chunk::GroupBoundingBox c_empty_group_bounding_box{
+	std::numeric_limits<DataFileDescription::ChunkCoordType>::max(),
+	std::numeric_limits<DataFileDescription::ChunkCoordType>::max(),
+	0u, 0u };
 
-	return polylines;
-}
-
-static std::vector< std::vector<ProjectionPoint> > SplitPolyline(
-	const std::vector<ProjectionPoint>& polyline,
-	const int32_t bb_min_x,
-	const int32_t bb_min_y,
-	const int32_t bb_max_x,
-	const int32_t bb_max_y )
+static void ExtendGroupBoundingBox( DataFileDescription::Chunk::GroupBoundingBox& bounding_box, const DataFileDescription::Chunk::GroupBoundingBox& other )
 {
-	PM_ASSERT( polyline.size() >= 1u );
-	std::vector< std::vector<ProjectionPoint> > polylines;
-
-	polylines.push_back( polyline );
-
-	const int32_t normals[4][2]{ { +1, 0 }, { -1, 0 }, { 0, +1 }, { 0, -1 }, };
-	const int32_t distances[4]{ +bb_min_x, -bb_max_x, +bb_min_y, -bb_max_y };
-	for( size_t i= 0u; i < 4u; ++i )
-	{
-		std::vector< std::vector<ProjectionPoint> > new_polylines;
-		for( const std::vector<ProjectionPoint>& polyline : polylines )
-		{
-			std::vector< std::vector<ProjectionPoint> > polyline_splitted= SplitPolyline( polyline, distances[i], normals[i][0], normals[i][1] );
-			for( std::vector<ProjectionPoint>& polyline_part : polyline_splitted )
-				new_polylines.push_back( std::move( polyline_part ) );
-		}
-		polylines= std::move( new_polylines );
-	}
-
-	return polylines;
+	bounding_box.min_x= std::min( bounding_box.min_x, other.min_x );
+	bounding_box.min_y= std::min( bounding_box.min_y, other.min_y );
+	bounding_box.max_x= std::max( bounding_box.max_x, other.max_x );
+	bounding_box.max_y= std::max( bounding_box.max_y, other.max_y );
 }
 
-static std::vector<ProjectionPoint> SplitConvexPolygon(
-	const std::vector<ProjectionPoint>& polygon,
-	const int32_t distance,
-	const int32_t normal_x,
-	const int32_t normal_y )
+static void ExtendGroupBoundingBox( DataFileDescription::Chunk::GroupBoundingBox& bounding_box, const DataFileDescription::ChunkVertex& vertex )
 {
-	PM_ASSERT( polygon.size() >= 3u );
-
-	const auto vertex_signed_plane_distance=
-	[&]( const ProjectionPoint& vertex ) -> int32_t
-	{
-		return vertex.x * normal_x + vertex.y * normal_y - distance;
-	};
-
-	const auto split_segment=
-	[&]( const size_t segment_index ) -> ProjectionPoint
-	{
-		const ProjectionPoint& v0= polygon[ segment_index ];
-		const ProjectionPoint& v1= polygon[ ( segment_index + 1u ) % polygon.size() ];
-		const int64_t dist0= int64_t( std::abs( vertex_signed_plane_distance(v0) ) );
-		const int64_t dist1= int64_t( std::abs( vertex_signed_plane_distance(v1) ) );
-		const int64_t dist_sum= dist0 + dist1;
-		ProjectionPoint result;
-		if( dist_sum > 0 )
-		{
-			result.x= int32_t( ( int64_t(v0.x) * dist1 + int64_t(v1.x) * dist0 ) / dist_sum );
-			result.y= int32_t( ( int64_t(v0.y) * dist1 + int64_t(v1.y) * dist0 ) / dist_sum );
-		}
-		else
-			result= v0;
-
-		return result;
-	};
-
-	const int32_t first_vertex_pos= vertex_signed_plane_distance( polygon.front() );
-	int32_t prev_vertex_pos= first_vertex_pos;
-	std::vector<ProjectionPoint> result_polygon;
-	if( prev_vertex_pos >= 0 )
-		result_polygon.push_back( polygon.front() );
-
-	for( size_t i= 1u; i < polygon.size(); ++i )
-	{
-		const int32_t cur_vertex_pos= vertex_signed_plane_distance( polygon[i] );
-			 if( prev_vertex_pos >= 0 && cur_vertex_pos >= 0 )
-			result_polygon.push_back( polygon[i] );
-		else if( prev_vertex_pos >= 0 && cur_vertex_pos < 0 )
-			result_polygon.push_back( split_segment(i-1u) );
-		else if( prev_vertex_pos < 0 && cur_vertex_pos >= 0 )
-		{
-			result_polygon.push_back( split_segment(i-1u) );
-			result_polygon.push_back( polygon[i] );
-		}
-		else if( prev_vertex_pos < 0 && cur_vertex_pos < 0 )
-		{}
-		prev_vertex_pos= cur_vertex_pos;
-	}
-
-	if( ( first_vertex_pos >= 0 && prev_vertex_pos < 0 ) || ( first_vertex_pos < 0 && prev_vertex_pos >= 0 ) )
-		result_polygon.push_back( split_segment( polygon.size() - 1u ) );
-
-	PM_ASSERT( result_polygon.size() == 0u || result_polygon.size() >= 3u );
-
-	return std::move(result_polygon);
-}
-
-static std::vector< std::vector<ProjectionPoint> > SplitConvexPolygon(
-	const std::vector<ProjectionPoint>& polygon,
-	const int32_t bb_min_x,
-	const int32_t bb_min_y,
-	const int32_t bb_max_x,
-	const int32_t bb_max_y )
-{
-	PM_ASSERT( polygon.size() >= 3u );
-	std::vector< std::vector<ProjectionPoint> > polygons;
-
-	polygons.push_back( polygon );
-
-	const int32_t normals[4][2]{ { +1, 0 }, { -1, 0 }, { 0, +1 }, { 0, -1 }, };
-	const int32_t distances[4]{ +bb_min_x, -bb_max_x, +bb_min_y, -bb_max_y };
-	for( size_t i= 0u; i < 4u; ++i )
-	{
-		std::vector< std::vector<ProjectionPoint> > new_polygons;
-		for( const std::vector<ProjectionPoint>& polygon : polygons )
-		{
-			std::vector<ProjectionPoint> polygon_splitted= SplitConvexPolygon( polygon, distances[i], normals[i][0], normals[i][1] );
-			if( polygon_splitted.size() >= 3u )
-				new_polygons.push_back( std::move( polygon_splitted ) );
-		}
-		polygons= std::move( new_polygons );
-	}
-
-	return polygons;
+	ExtendGroupBoundingBox( bounding_box, DataFileDescription::Chunk::GroupBoundingBox{ vertex.x, vertex.y, vertex.x, vertex.y } );
 }
 
 using ChunkData= std::vector<unsigned char>;
@@ -212,10 +53,15 @@ static ChunksData DumpDataChunk(
 	const ObjectsData& prepared_data,
 	const int32_t chunk_offset_x,
 	const int32_t chunk_offset_y,
-	const int32_t chunk_size ) // Offset and size - in scaled coordinates.
+	const int32_t chunk_size, // Offset and size - in scaled coordinates.
+	const bool use_32_bit_indices )
 {
 	using namespace DataFileDescription;
 
+	// With 16-bit indices we have vertex limit= 2^16.
+	// 32-bit indices allow much bigger chunks, but chunks are still limited, for reasonable chunk preparation time in viewer.
+	const size_t max_vertices= use_32_bit_indices ? c_max_chunk_vertices_with_32_bit_indices : 65535u;
+
 	std::vector<unsigned char> result;
 	result.resize( sizeof(Chunk), 0 );
 
@@ -236,6 +82,11 @@ static ChunksData DumpDataChunk(
 	get_chunk().min_z_level= 100u;
 	get_chunk().max_z_level=  0u;
 
+	const ClipBox clip_box{ chunk_offset_x, chunk_offset_y, chunk_offset_x + chunk_size, chunk_offset_y + chunk_size };
+	// Scratch buffers for clipping, reused for all objects of chunk.
+	std::vector<ProjectionPoint> clipped_vertices, clipped_tmp_vertices;
+	std::vector<size_t> clipped_parts_end;
+
 	std::vector<ChunkVertex> vertices;
 	size_t linear_vertex_count= 0u;
 	const ChunkVertex break_primitive_vertex{ std::numeric_limits<ChunkCoordType>::max(), 0 };
@@ -250,7 +101,7 @@ static ChunksData DumpDataChunk(
 			{
 				if( prev_class != PointObjectClass::None )
 				{
-					group.vertex_count= static_cast<uint16_t>( vertices.size() - group.first_vertex );
+					group.vertex_count= static_cast<uint32_t>( vertices.size() - group.first_vertex );
 					result.insert(
 						result.end(),
 						reinterpret_cast<const unsigned char*>(&group),
@@ -258,7 +109,7 @@ static ChunksData DumpDataChunk(
 					++get_chunk().point_object_groups_count;
 				}
 
-				group.first_vertex= static_cast<uint16_t>( vertices.size() );
+				group.first_vertex= static_cast<uint32_t>( vertices.size() );
 				group.style_index= static_cast<Chunk::StyleIndex>( object.class_ );
 
 				prev_class= object.class_;
@@ -275,7 +126,7 @@ static ChunksData DumpDataChunk(
 		}
 		if( prev_class != PointObjectClass::None )
 		{
-			group.vertex_count= static_cast<uint16_t>( vertices.size() - group.first_vertex );
+			group.vertex_count= static_cast<uint32_t>( vertices.size() - group.first_vertex );
 			result.insert(
 				result.end(),
 				reinterpret_cast<const unsigned char*>(&group),
@@ -295,7 +146,7 @@ static ChunksData DumpDataChunk(
 			{
 				if( prev_class != LinearObjectClass::None )
 				{
-					group.vertex_count= static_cast<uint16_t>( vertices.size() - group.first_vertex );
+					group.vertex_count= static_cast<uint32_t>( vertices.size() - group.first_vertex );
 					result.insert(
 						result.end(),
 						reinterpret_cast<const unsigned char*>(&group),
@@ -303,9 +154,11 @@ static ChunksData DumpDataChunk(
 					++get_chunk().linear_object_groups_count;
 				}
 
-				group.first_vertex= static_cast<uint16_t>( vertices.size() );
+				group.first_vertex= static_cast<uint32_t>( vertices.size() );
 				group.style_index= static_cast<Chunk::StyleIndex>( object.class_ );
 				group.z_level= static_cast<uint16_t>(object.z_level);
+				group.bounding_box= c_empty_group_bounding_box;
+				group.visible_size= 0u;
 
 				get_chunk().min_z_level= std::min( get_chunk().min_z_level, group.z_level );
 				get_chunk().max_z_level= std::max( get_chunk().max_z_level, group.z_level );
@@ -314,27 +167,37 @@ static ChunksData DumpDataChunk(
 				prev_z_level= object.z_level;
 			}
 
-			std::vector<ProjectionPoint> polyline_vertices;
-			polyline_vertices.reserve( object.vertex_count );
-			for( size_t v= object.first_vertex_index; v < object.first_vertex_index + object.vertex_count; ++v )
-				polyline_vertices.push_back( prepared_data.linear_objects_vertices[v] );
+			clipped_vertices.clear();
+			clipped_parts_end.clear();
+			ClipPolyline( prepared_data.linear_objects_vertices.data() + object.first_vertex_index, object.vertex_count, clip_box, clipped_vertices, clipped_parts_end );
 
-			for( const std::vector<ProjectionPoint>& polyline_part : SplitPolyline( polyline_vertices, chunk_offset_x, chunk_offset_y, chunk_offset_x + chunk_size, chunk_offset_y + chunk_size ) )
+			size_t part_start= 0u;
+			for( const size_t part_end : clipped_parts_end )
 			{
-				for( const ProjectionPoint& polyline_part_vertex : polyline_part )
+				Chunk::GroupBoundingBox part_bounding_box= c_empty_group_bounding_box;
+				for( size_t v= part_start; v < part_end; ++v )
 				{
-					const int32_t vertex_x= polyline_part_vertex.x - min_point.x;
-					const int32_t vertex_y= polyline_part_vertex.y - min_point.y;
+					const int32_t vertex_x= clipped_vertices[v].x - min_point.x;
+					const int32_t vertex_y= clipped_vertices[v].y - min_point.y;
 					vertices.push_back( ChunkVertex{ static_cast<ChunkCoordType>(vertex_x), static_cast<ChunkCoordType>(vertex_y) } );
+					ExtendGroupBoundingBox( part_bounding_box, vertices.back() );
 					++linear_vertex_count;
 				}
+				ExtendGroupBoundingBox( group.bounding_box, part_bounding_box );
+				group.visible_size=
+					std::max(
+						group.visible_size,
+						std::max(
+							static_cast<uint16_t>( part_bounding_box.max_x - part_bounding_box.min_x ),
+							static_cast<uint16_t>( part_bounding_box.max_y - part_bounding_box.min_y ) ) );
 				vertices.push_back(break_primitive_vertex);
 				++linear_vertex_count;
+				part_start= part_end;
 			}
 		}
 		if( prev_class != LinearObjectClass::None )
 		{
-			group.vertex_count= static_cast<uint16_t>( vertices.size() - group.first_vertex );
+			group.vertex_count= static_cast<uint32_t>( vertices.size() - group.first_vertex );
 			result.insert(
 				result.end(),
 				reinterpret_cast<const unsigned char*>(&group),
@@ -342,67 +205,136 @@ static ChunksData DumpDataChunk(
 			++get_chunk().linear_object_groups_count;
 		}
 	}
+	std::vector<uint16_t> indices;
 	{
 		get_chunk().areal_object_groups_offset= static_cast<uint32_t>(result.size());
 
-		size_t prev_z_level= ~0u;
+		// Areal objects are convex polygons. Triangulate them, merge same vertices of adjacent polygons and optimize triangles order for vertex cache.
+		// Polygons with different styles may overlap, so, reorder triangles only inside groups with same style and z_level.
 		Chunk::ArealObjectGroup group;
-		group.first_vertex= static_cast<uint16_t>(vertices.size());
-		for( const OSMParseResult::ArealObject& object : prepared_data.areal_objects )
+		std::vector<ChunkVertex> group_vertices;
+		std::vector<uint16_t> group_indices;
+		std::unordered_map< ChunkVertex, uint16_t, ChunkVertexHasher > group_vertices_map;
+
+		const auto flush_group=
+		[&]
 		{
-			if( object.z_level != prev_z_level )
+			if( group_indices.empty() )
+				return;
+
+			std::vector<size_t> vertices_order;
+			if( vertices.size() + group_vertices.size() < max_vertices )
+				vertices_order= OptimizeTrianglesForVertexCache( group_indices, group_vertices.size() );
+			else
 			{
-				if( prev_z_level != ~0u )
-				{
-					group.vertex_count= static_cast<uint16_t>( vertices.size() - group.first_vertex );
-					result.insert(
-						result.end(),
-						reinterpret_cast<const unsigned char*>(&group),
-						reinterpret_cast<const unsigned char*>(&group) + sizeof(group) );
-					++get_chunk().areal_object_groups_count;
-				}
+				// Chunk will be splitted, do not waste time for optimization.
+				for( size_t v= 0u; v < group_vertices.size(); ++v )
+					vertices_order.push_back(v);
+			}
 
-				group.first_vertex= static_cast<uint16_t>( vertices.size() );
-				group.z_level= static_cast<uint16_t>(object.z_level);
+			group.first_vertex= static_cast<uint32_t>( vertices.size() );
+			group.vertex_count= static_cast<uint32_t>( group_vertices.size() );
+			for( const size_t v : vertices_order )
+				vertices.push_back( group_vertices[v] );
 
-				get_chunk().min_z_level= std::min( get_chunk().min_z_level, group.z_level );
-				get_chunk().max_z_level= std::max( get_chunk().max_z_level, group.z_level );
+			group.bounding_box= c_empty_group_bounding_box;
+			for( const ChunkVertex& vertex : group_vertices )
+				ExtendGroupBoundingBox( group.bounding_box, vertex );
 
-				prev_z_level= object.z_level;
+			// Sum areas of all triangles. Overlapping of polygons is ignored, so, result may be greater, than real covered area.
+			double double_area= 0.0;
+			for( size_t i= 0u; i < group_indices.size(); i+= 3u )
+			{
+				const ChunkVertex& v0= group_vertices[ vertices_order[ group_indices[i] ] ];
+				const ChunkVertex& v1= group_vertices[ vertices_order[ group_indices[i + 1u] ] ];
+				const ChunkVertex& v2= group_vertices[ vertices_order[ group_indices[i + 2u] ] ];
+				const int64_t cross=
+					( int64_t(v1.x) - int64_t(v0.x) ) * ( int64_t(v2.y) - int64_t(v0.y) ) -
+					( int64_t(v1.y) - int64_t(v0.y) ) * ( int64_t(v2.x) - int64_t(v0.x) );
+				double_area+= double( std::abs(cross) );
 			}
+			group.visible_size= static_cast<uint16_t>( std::min( std::ceil( std::sqrt( double_area * 0.5 ) ), 65535.0 ) );
 
-			std::vector<ProjectionPoint> polygon_vertices;
-			polygon_vertices.reserve( object.vertex_count );
-			for( size_t v= object.first_vertex_index; v < object.first_vertex_index + object.vertex_count; ++v )
-				polygon_vertices.push_back( prepared_data.areal_objects_vertices[v] );
+			group.first_index= static_cast<uint32_t>( indices.size() );
+			group.index_count= static_cast<uint32_t>( group_indices.size() );
+			indices.insert( indices.end(), group_indices.begin(), group_indices.end() );
 
-			for( const std::vector<ProjectionPoint> ploygon_part_bbox_splitted : SplitConvexPolygon( polygon_vertices, chunk_offset_x, chunk_offset_y, chunk_offset_x + chunk_size, chunk_offset_y + chunk_size ) )
-			{
-				for( const ProjectionPoint& polygon_part_vertex : ploygon_part_bbox_splitted )
-				{
-					const int32_t vertex_x= polygon_part_vertex.x - min_point.x;
-					const int32_t vertex_y= polygon_part_vertex.y - min_point.y;
-					vertices.push_back( ChunkVertex{ static_cast<ChunkCoordType>(vertex_x), static_cast<ChunkCoordType>(vertex_y) } );
-				}
-				vertices.push_back(break_primitive_vertex);
-				vertices.back().y= static_cast<uint16_t>( object.class_ );
-			}
-		}
-		if( prev_z_level != -~0u )
-		{
-			group.vertex_count= static_cast<uint16_t>( vertices.size() - group.first_vertex );
 			result.insert(
 				result.end(),
 				reinterpret_cast<const unsigned char*>(&group),
 				reinterpret_cast<const unsigned char*>(&group) + sizeof(group) );
 			++get_chunk().areal_object_groups_count;
+
+			get_chunk().min_z_level= std::min( get_chunk().min_z_level, group.z_level );
+			get_chunk().max_z_level= std::max( get_chunk().max_z_level, group.z_level );
+
+			group_vertices.clear();
+			group_indices.clear();
+			group_vertices_map.clear();
+		};
+
+		const auto get_vertex_index=
+		[&]( const ChunkVertex& vertex ) -> uint16_t
+		{
+			const auto it= group_vertices_map.find( vertex );
+			if( it != group_vertices_map.end() )
+				return it->second;
+
+			const uint16_t index= static_cast<uint16_t>( group_vertices.size() );
+			group_vertices.push_back( vertex );
+			group_vertices_map.emplace( vertex, index );
+			return index;
+		};
+
+		ArealObjectClass prev_class= ArealObjectClass::None;
+		size_t prev_z_level= ~0u;
+		std::vector<uint16_t> polygon_indices;
+		for( const OSMParseResult::ArealObject& object : prepared_data.areal_objects )
+		{
+			if( object.class_ != prev_class || object.z_level != prev_z_level )
+			{
+				flush_group();
+
+				group.z_level= static_cast<uint16_t>(object.z_level);
+				group.style_index= static_cast<Chunk::StyleIndex>( object.class_ );
+
+				prev_class= object.class_;
+				prev_z_level= object.z_level;
+			}
+
+			// Indices inside group are 16-bit, start new group with same style, if group is too big.
+			// Clipping by box adds no more, than 4 vertices.
+			if( group_vertices.size() + object.vertex_count + 4u >= 65535u )
+				flush_group();
+
+			ClipConvexPolygon( prepared_data.areal_objects_vertices.data() + object.first_vertex_index, object.vertex_count, clip_box, clipped_vertices, clipped_tmp_vertices );
+
+			polygon_indices.clear();
+			for( const ProjectionPoint& polygon_vertex : clipped_vertices )
+			{
+				const int32_t vertex_x= polygon_vertex.x - min_point.x;
+				const int32_t vertex_y= polygon_vertex.y - min_point.y;
+				polygon_indices.push_back( get_vertex_index( ChunkVertex{ static_cast<ChunkCoordType>(vertex_x), static_cast<ChunkCoordType>(vertex_y) } ) );
+			}
+
+			// Triangulate convex polygon as fan.
+			for( size_t i= 1u; i + 1u < polygon_indices.size(); ++i )
+			{
+				const uint16_t i0= polygon_indices[0u], i1= polygon_indices[i], i2= polygon_indices[i + 1u];
+				if( i0 == i1 || i1 == i2 || i2 == i0 )
+					continue;
+				group_indices.push_back(i0);
+				group_indices.push_back(i1);
+				group_indices.push_back(i2);
+			}
 		}
+		flush_group();
 	}
 
-	// We have vertex limit= 2^16. But we split chunks with vertices > 32k, for better GPU perfomance.
+	// We split big chunks with vertices > half of limit, for better GPU perfomance.
 	// For linear objects we limit vertex count, using approximation 4 vertices for each line vertex.
-	const size_t size_limit= chunk_size >= c_min_chunk_size * 4 ? 32768u : 65535u;
-	if( vertices.size() >= size_limit || linear_vertex_count >= 65535u / 4u )
+	const size_t size_limit= chunk_size >= c_min_chunk_size * 4 ? ( max_vertices + 1u ) / 2u : max_vertices;
+	if( vertices.size() >= size_limit || linear_vertex_count >= max_vertices / 4u )
 	{
 		Log::Info( "Split chunk ", chunk_offset_x, " ", chunk_offset_y, " into 4 parts with size ", chunk_size / 2 );
 
@@ -418,7 +350,8 @@ static ChunksData DumpDataChunk(
 					prepared_data,
 					chunk_offset_x + x * half_chunk_size,
 					chunk_offset_y + y * half_chunk_size,
-					half_chunk_size );
+					half_chunk_size,
+					use_32_bit_indices );
 			for( ChunkData& sub_chunk : sub_chunks )
 				result.push_back( std::move( sub_chunk ) );
 		}
@@ -429,13 +362,22 @@ static ChunksData DumpDataChunk(
 		get_chunk().min_z_level= get_chunk().max_z_level;
 
 	get_chunk().vertices_offset= static_cast<uint32_t>( result.size() );
-	get_chunk().vertex_count= static_cast<uint16_t>( vertices.size() );
+	get_chunk().vertex_count= static_cast<uint32_t>( vertices.size() );
 
 	result.insert(
 		result.end(),
 		reinterpret_cast<const unsigned char*>( vertices.data() ),
 		reinterpret_cast<const unsigned char*>( vertices.data() + vertices.size() ) );
 
+	get_chunk().indices_offset= static_cast<uint32_t>( result.size() );
+	get_chunk().index_count= static_cast<uint32_t>( indices.size() );
+
+	result.insert(
+		result.end(),
+		reinterpret_cast<const unsigned char*>( indices.data() ),
+		reinterpret_cast<const unsigned char*>( indices.data() + indices.size() ) );
+	result.resize( ( result.size() + 3u ) & ~size_t(3u), 0u ); // Align to 4 bytes.
+
 	if( vertices.empty() )
 	{
 		// Chunk without geomery.
@@ -450,7 +392,8 @@ static ChunksData DumpDataChunk(
 static std::vector<unsigned char> DumpDataFile(
 	const std::vector<ObjectsData>& prepared_data,
 	const Styles& styles,
-	const ImageRGBA& copyright_image )
+	const ImageRGBA& copyright_image,
+	const bool use_32_bit_indices )
 {
 	Log::Info( "Final export: " );
 
@@ -474,6 +417,7 @@ static std::vector<unsigned char> DumpDataFile(
 	get_data_file().max_x= prepared_data.front().max_point.x;
 	get_data_file().max_y= prepared_data.front().max_point.y;
 	get_data_file().unit_size= prepared_data.front().coordinates_scale;
+	get_data_file().vertex_index_size= use_32_bit_indices ? 4u : 2u;
 
 	get_data_file().zoom_levels_offset= static_cast<uint32_t>( result.size() );
 	get_data_file().zoom_level_count= static_cast<uint32_t>( prepared_data.size() );
@@ -507,7 +451,8 @@ static std::vector<unsigned char> DumpDataFile(
 					zoom_level_data,
 					x * used_chunk_size,
 					y * used_chunk_size,
-					used_chunk_size );
+					used_chunk_size,
+					use_32_bit_indices );
 			for( ChunkData& chunk_data : chunks_data )
 				if( !chunk_data.empty() )
 					final_chunks_data.push_back( std::move( chunk_data ) );
@@ -689,9 +634,10 @@ void CreateDataFile(
 	const std::vector<ObjectsData>& prepared_data,
 	const Styles& styles,
 	const ImageRGBA& copyright_image,
+	const bool use_32_bit_indices,
 	const char* const file_name )
 {
-	WriteFile( DumpDataFile( prepared_data, styles, copyright_image ), file_name );
+	WriteFile( DumpDataFile( prepared_data, styles, copyright_image, use_32_bit_indices ), file_name );
 }
 
 } // namespace PanzerMaps
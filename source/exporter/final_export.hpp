@@ -9,6 +9,7 @@ void CreateDataFile(
 	const std::vector<ObjectsData>& prepared_data,
 	const Styles& styles,
 	const ImageRGBA& copyright_image,
+	bool use_32_bit_indices, // Allows bigger chunks, but such file can not be opened on OpenGL ES devices.
 	const char* const file_name );
 
 } // namespace PanzerMaps
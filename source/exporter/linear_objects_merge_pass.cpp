@@ -1,5 +1,4 @@
 #include <unordered_map>
-#include <unordered_set>
 #include "../common/assert.hpp"
 #include "../common/log.hpp"
 #include "linear_objects_merge_pass.hpp"
@@ -7,13 +6,21 @@
 namespace PanzerMaps
 {
 
+// Merged object is chain of source objects. Adjacent parts of chain have common vertex.
 struct LinearObjectForMerge
 {
-	std::vector<ObjectsData::VertexTransformed> vertices;
+	struct Part
+	{
+		uint32_t source_object_index;
+		bool reversed;
+	};
+
+	std::vector<Part> parts;
+	ObjectsData::VertexTransformed front, back;
 	LinearObjectClass class_= LinearObjectClass::None;
-	size_t z_level= g_zero_z_level;
+	uint8_t z_level= g_zero_z_level;
+	bool merged_into_other= false;
 };
-using LinearObjectForMergePtr= std::shared_ptr<LinearObjectForMerge>;
 
 struct LinearObjectKey
 {
@@ -35,15 +42,16 @@ struct LinearObjectKeyHasher
 	}
 };
 
-using LinearObjectsMap= std::unordered_map< LinearObjectKey, LinearObjectForMergePtr, LinearObjectKeyHasher >;
+// Value - index of object.
+using LinearObjectsMap= std::unordered_map< LinearObjectKey, size_t, LinearObjectKeyHasher >;
 
-static void EraseObjectFromMap( LinearObjectsMap& linear_objects_map, const LinearObjectForMergePtr& object )
+static void EraseObjectFromMap( LinearObjectsMap& linear_objects_map, const LinearObjectForMerge& object )
 {
 	LinearObjectKey key_front, key_back;
-	key_front.class_ = key_back.class_ = object->class_ ;
-	key_front.z_level= key_back.z_level= object->z_level;
-	key_front.vertex= object->vertices.front();
-	key_back .vertex= object->vertices.back ();
+	key_front.class_ = key_back.class_ = object.class_ ;
+	key_front.z_level= key_back.z_level= object.z_level;
+	key_front.vertex= object.front;
+	key_back .vertex= object.back ;
 
 	PM_ASSERT( linear_objects_map.count( key_front ) == 1 );
 	PM_ASSERT( linear_objects_map.count( key_back  ) == 1 );
@@ -52,90 +60,144 @@ static void EraseObjectFromMap( LinearObjectsMap& linear_objects_map, const Line
 	linear_objects_map.erase( key_back  );
 }
 
-static void PutObjectToMap( LinearObjectsMap& linear_objects_map, const LinearObjectForMergePtr& object )
+static void AppendParts( std::vector<LinearObjectForMerge::Part>& dst, const std::vector<LinearObjectForMerge::Part>& src, const bool reverse )
 {
+	if( reverse )
+		for( auto it= src.rbegin(); it != src.rend(); ++it )
+			dst.push_back( LinearObjectForMerge::Part{ it->source_object_index, !it->reversed } );
+	else
+		dst.insert( dst.end(), src.begin(), src.end() );
+}
+
+static void PrependParts( std::vector<LinearObjectForMerge::Part>& dst, const std::vector<LinearObjectForMerge::Part>& src, const bool reverse )
+{
+	std::vector<LinearObjectForMerge::Part> result;
+	result.reserve( src.size() + dst.size() );
+	AppendParts( result, src, reverse );
+	result.insert( result.end(), dst.begin(), dst.end() );
+	dst.swap( result );
+}
+
+static void PutObjectToMap( LinearObjectsMap& linear_objects_map, std::vector<LinearObjectForMerge>& objects, const size_t object_index )
+{
+	LinearObjectForMerge& object= objects[object_index];
+
 	LinearObjectKey key_front, key_back;
-	key_front.class_ = key_back.class_ = object->class_ ;
-	key_front.z_level= key_back.z_level= object->z_level;
-	key_front.vertex= object->vertices.front();
-	key_back .vertex= object->vertices.back ();
+	key_front.class_ = key_back.class_ = object.class_ ;
+	key_front.z_level= key_back.z_level= object.z_level;
+	key_front.vertex= object.front;
+	key_back .vertex= object.back ;
 
 	const auto front_it= linear_objects_map.find( key_front );
 	const auto back_it = linear_objects_map.find( key_back  );
 	if( front_it != linear_objects_map.end() )
 	{
-		LinearObjectForMergePtr out_object= front_it->second;
-		PM_ASSERT( out_object != object );
+		const size_t out_object_index= front_it->second;
+		PM_ASSERT( out_object_index != object_index );
+		LinearObjectForMerge& out_object= objects[out_object_index];
 		EraseObjectFromMap( linear_objects_map, out_object );
 
-		if( key_front.vertex == out_object->vertices.front() )
-			out_object->vertices.insert( out_object->vertices.begin(), object->vertices.rbegin(), object->vertices.rend() - 1 );
+		if( key_front.vertex == out_object.front )
+		{
+			PrependParts( out_object.parts, object.parts, true );
+			out_object.front= object.back;
+		}
 		else
 		{
-			PM_ASSERT( key_front.vertex == out_object->vertices.back() );
-			out_object->vertices.insert( out_object->vertices.end(), object->vertices.begin() + 1, object->vertices.end() );
+			PM_ASSERT( key_front.vertex == out_object.back );
+			AppendParts( out_object.parts, object.parts, false );
+			out_object.back= object.back;
 		}
+		object.merged_into_other= true;
+		object.parts.clear();
+		object.parts.shrink_to_fit();
 
-		PutObjectToMap( linear_objects_map, out_object );
+		PutObjectToMap( linear_objects_map, objects, out_object_index );
 	}
 	else if( back_it != linear_objects_map.end() )
 	{
-		LinearObjectForMergePtr out_object= back_it->second;
-		PM_ASSERT( out_object != object );
+		const size_t out_object_index= back_it->second;
+		PM_ASSERT( out_object_index != object_index );
+		LinearObjectForMerge& out_object= objects[out_object_index];
 		EraseObjectFromMap( linear_objects_map, out_object );
 
-		if( key_back.vertex == out_object->vertices.front() )
-			out_object->vertices.insert( out_object->vertices.begin(), object->vertices.begin(), object->vertices.end() - 1 );
+		if( key_back.vertex == out_object.front )
+		{
+			PrependParts( out_object.parts, object.parts, false );
+			out_object.front= object.front;
+		}
 		else
 		{
-			PM_ASSERT( key_back.vertex == out_object->vertices.back() );
-			out_object->vertices.insert( out_object->vertices.end(), object->vertices.rbegin() + 1, object->vertices.rend() );
+			PM_ASSERT( key_back.vertex == out_object.back );
+			AppendParts( out_object.parts, object.parts, true );
+			out_object.back= object.front;
 		}
+		object.merged_into_other= true;
+		object.parts.clear();
+		object.parts.shrink_to_fit();
 
-		PutObjectToMap( linear_objects_map, out_object );
+		PutObjectToMap( linear_objects_map, objects, out_object_index );
 	}
 	else
 	{
-		linear_objects_map[ key_front ]= object;
-		linear_objects_map[ key_back  ]= object;
+		linear_objects_map[ key_front ]= object_index;
+		linear_objects_map[ key_back  ]= object_index;
 	}
 }
 
 void MergeLinearObjects( ObjectsData& data )
 {
+	// Merge chains of source objects and than copy vertices of each chain only once.
+	std::vector<LinearObjectForMerge> objects( data.linear_objects.size() );
 	LinearObjectsMap linear_objects_map;
 
-	for( const ObjectsData::LinearObject& in_object : data.linear_objects )
+	for( size_t i= 0u; i < data.linear_objects.size(); ++i )
 	{
-		std::vector<ObjectsData::VertexTransformed> vertices(
-			data.linear_objects_vertices.data() + in_object.first_vertex_index,
-			data.linear_objects_vertices.data() + in_object.first_vertex_index + in_object.vertex_count );
-
-		const LinearObjectForMergePtr out_object= std::make_shared<LinearObjectForMerge>();
-		out_object->class_= in_object.class_;
-		out_object->z_level= in_object.z_level;
-		out_object->vertices= std::move(vertices);
-		PutObjectToMap( linear_objects_map, out_object );
+		const ObjectsData::LinearObject& in_object= data.linear_objects[i];
+
+		LinearObjectForMerge& object= objects[i];
+		object.class_= in_object.class_;
+		object.z_level= in_object.z_level;
+		object.front= data.linear_objects_vertices[ in_object.first_vertex_index ];
+		object.back = data.linear_objects_vertices[ in_object.first_vertex_index + in_object.vertex_count - 1u ];
+		object.parts.push_back( LinearObjectForMerge::Part{ static_cast<uint32_t>(i), false } );
+		PutObjectToMap( linear_objects_map, objects, i );
 	}
 
-	std::unordered_set<LinearObjectForMergePtr> linear_objects_unique;
-	for( const auto& map_value : linear_objects_map )
-		linear_objects_unique.insert(map_value.second);
-
-	data.linear_objects.clear();
-	data.linear_objects_vertices.clear();
+	std::vector<ObjectsData::LinearObject> result_linear_objects;
+	std::vector<ObjectsData::VertexTransformed> result_linear_objects_vertices;
+	result_linear_objects_vertices.reserve( data.linear_objects_vertices.size() );
 
-	for( const LinearObjectForMergePtr& in_object : linear_objects_unique )
+	for( const LinearObjectForMerge& object : objects )
 	{
+		if( object.merged_into_other )
+			continue;
+
 		ObjectsData::LinearObject out_object;
-		out_object.class_= in_object->class_;
-		out_object.z_level= in_object->z_level;
-		out_object.first_vertex_index= data.linear_objects_vertices.size();
-		out_object.vertex_count= in_object->vertices.size();
-		data.linear_objects_vertices.insert( data.linear_objects_vertices.end(), in_object->vertices.begin(), in_object->vertices.end() );
-		data.linear_objects.push_back(out_object);
+		out_object.class_= object.class_;
+		out_object.z_level= object.z_level;
+		out_object.first_vertex_index= static_cast<ObjectsData::VertexIndex>( result_linear_objects_vertices.size() );
+
+		for( const LinearObjectForMerge::Part& part : object.parts )
+		{
+			const ObjectsData::LinearObject& in_object= data.linear_objects[ part.source_object_index ];
+			const ObjectsData::VertexTransformed* const in_vertices= data.linear_objects_vertices.data() + in_object.first_vertex_index;
+
+			// Skip first vertex of each part except first, because it is same as last vertex of previous part.
+			const size_t skip= &part == object.parts.data() ? 0u : 1u;
+			if( part.reversed )
+				for( size_t v= skip; v < in_object.vertex_count; ++v )
+					result_linear_objects_vertices.push_back( in_vertices[ in_object.vertex_count - 1u - v ] );
+			else
+				result_linear_objects_vertices.insert( result_linear_objects_vertices.end(), in_vertices + skip, in_vertices + in_object.vertex_count );
+		}
+
+		out_object.vertex_count= static_cast<ObjectsData::VertexIndex>( result_linear_objects_vertices.size() - out_object.first_vertex_index );
+		result_linear_objects.push_back(out_object);
 	}
 
+	data.linear_objects= std::move(result_linear_objects);
+	data.linear_objects_vertices= std::move(result_linear_objects_vertices);
 
 	Log::Info( "Linear objects merge pass: " );
 	Log::Info( data.linear_objects.size(), " linear objects" );
@@ -3,6 +3,7 @@
 #include "coordinates_transformation_pass.hpp"
 #include "linear_objects_merge_pass.hpp"
 #include "phase_sort_pass.hpp"
+#include "polygons_dissolve_pass.hpp"
 #include "polygons_normalization_pass.hpp"
 #include "primary_export.hpp"
 #include "simplification_pass.hpp"
@@ -15,12 +16,14 @@ int main( int argc, const char* const argv[] )
 	std::vector<std::string> input_files;
 	std::string output_file;
 	std::string styles_dir= "styles";
+	bool use_32_bit_indices= false;
 
 	static const char help_message[]=
 	R"(
 PanzerMaps Exporter. Input file format - .osm
 Usage:
-	Exporter -i [input_file] -o [output_file] --styles [styles_dir])";
+	Exporter -i [input_file] -o [output_file] --styles [styles_dir] [--32-bit-indices]
+	--32-bit-indices - allow bigger chunks with fewer draw calls, result file is not supported on Android.)";
 
 	if( argc <= 1 )
 	{
@@ -44,6 +47,11 @@ Usage:
 			styles_dir= argv[ i + 1 ];
 			i+= 2;
 		}
+		else if( std::strcmp( argv[i], "--32-bit-indices" ) == 0 )
+		{
+			use_32_bit_indices= true;
+			++i;
+		}
 		else if( std::strcmp( argv[i], "-h" ) == 0 || std::strcmp( argv[i], "--help" ) == 0 )
 		{
 			Log::User( help_message );
@@ -105,11 +113,12 @@ Usage:
 			}
 		}
 
-		ObjectsData objects_data= TransformCoordinates( osm_parse_result, zoom_level_scale_log2 );
+		ObjectsData objects_data= TransformCoordinates( osm_parse_result, zoom_level, zoom_level_scale_log2 );
 
 		MergeLinearObjects( objects_data );
+		DissolvePolygons( objects_data, zoom_level );
 		SortByPhase( objects_data, zoom_level );
-		SimplificationPass( objects_data, zoom_level.simplification_distance );
+		SimplificationPass( objects_data, zoom_level );
 		NormalizePolygons( objects_data );
 		ou_data_by_zoom_level.push_back( std::move(objects_data) );
 
@@ -122,5 +131,6 @@ Usage:
 		ou_data_by_zoom_level,
 		styles,
 		copyright_image,
+		use_32_bit_indices,
 		output_file.c_str() );
 }
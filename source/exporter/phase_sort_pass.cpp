@@ -9,10 +9,12 @@ namespace PanzerMaps
 
 void SortByPhase( ObjectsData& data, const Styles::ZoomLevel& zoom_level )
 {
-	ObjectsData result;
+	// Only objects are reordered here, vertices stay in place. Simplification pass later writes vertices in new order of objects.
 
 	// Currently, point and linear object not splitted by phase.
 
+	std::vector<BaseDataRepresentation::PointObject> result_point_objects;
+	std::vector<ObjectsData::VertexTransformed> result_point_objects_vertices;
 	for( const PointObjectClass& object_class : zoom_level.point_classes_ordered )
 	{
 		for( const BaseDataRepresentation::PointObject& in_object : data.point_objects )
@@ -20,131 +22,84 @@ void SortByPhase( ObjectsData& data, const Styles::ZoomLevel& zoom_level )
 			if( in_object.class_ != object_class )
 				continue;
 
-			BaseDataRepresentation::PointObject out_object;
-			out_object.class_= in_object.class_;
-			result.point_objects_vertices.push_back( data.point_objects_vertices[ &in_object - data.point_objects.data() ] );
-			result.point_objects.push_back( out_object );
+			result_point_objects_vertices.push_back( data.point_objects_vertices[ &in_object - data.point_objects.data() ] );
+			result_point_objects.push_back( in_object );
 		}
 	}
 
-	std::unordered_map< LinearObjectClass, size_t > linear_classes_order;
+	size_t linear_classes_order[ size_t(LinearObjectClass::Last) ];
+	std::fill( linear_classes_order, linear_classes_order + size_t(LinearObjectClass::Last), ~size_t(0u) );
 	for( const LinearObjectClass& object_class : zoom_level.linear_classes_ordered )
-	{
-		linear_classes_order[ object_class ]= &object_class - zoom_level.linear_classes_ordered.data();
-
-		for( const BaseDataRepresentation::LinearObject& in_object : data.linear_objects )
-		{
-			if( in_object.class_ != object_class )
-				continue;
-
-			BaseDataRepresentation::LinearObject out_object;
-			out_object.class_= in_object.class_;
-			out_object.z_level= in_object.z_level;
-			out_object.first_vertex_index= result.linear_objects_vertices.size();
-			out_object.vertex_count= in_object.vertex_count;
+		linear_classes_order[ size_t(object_class) ]= size_t( &object_class - zoom_level.linear_classes_ordered.data() );
 
-			for( size_t v= 0u; v < in_object.vertex_count; ++v )
-				result.linear_objects_vertices.push_back( data.linear_objects_vertices[ in_object.first_vertex_index + v ] );
-
-			result.linear_objects.push_back( out_object );
-		}
-	}
+	std::vector<BaseDataRepresentation::LinearObject> result_linear_objects;
+	result_linear_objects.reserve( data.linear_objects.size() );
+	for( const BaseDataRepresentation::LinearObject& in_object : data.linear_objects )
+		if( linear_classes_order[ size_t(in_object.class_) ] != ~size_t(0u) )
+			result_linear_objects.push_back( in_object );
 
 	// Sort lines by z_level.
-	std::sort(
-		result.linear_objects.begin(),
-		result.linear_objects.end(),
+	std::stable_sort(
+		result_linear_objects.begin(),
+		result_linear_objects.end(),
 		[&]( const BaseDataRepresentation::LinearObject& l, const BaseDataRepresentation::LinearObject& r )
 		{
 			if( l.z_level != r.z_level )
 				return l.z_level < r.z_level;
-			return linear_classes_order[l.class_] < linear_classes_order[r.class_];
+			return linear_classes_order[ size_t(l.class_) ] < linear_classes_order[ size_t(r.class_) ];
 		} );
 
-	for( size_t z_level= 0u; z_level <= g_max_z_level; ++z_level )
-	for( const Styles::ArealObjectPhase& phase : zoom_level.areal_object_phases )
+	// Calculate areas only once, not in each comparison.
+	std::vector<int64_t> areal_objects_double_area( data.areal_objects.size() );
+	for( size_t i= 0u; i < data.areal_objects.size(); ++i )
 	{
-		std::vector< ObjectsData::ArealObject > areal_objects;
-		for( const BaseDataRepresentation::ArealObject& in_object : data.areal_objects )
+		const ObjectsData::ArealObject& polygon= data.areal_objects[i];
+		if( polygon.IsMultipolygon() )
 		{
-			if( in_object.z_level != z_level || phase.classes.count(in_object.class_) == 0 )
-				continue;
-
-			BaseDataRepresentation::ArealObject out_object;
-			out_object.class_= in_object.class_;
-			out_object.z_level= in_object.z_level;
-
-			if( in_object.multipolygon != nullptr )
-			{
-				out_object.multipolygon.reset( new BaseDataRepresentation::Multipolygon );
-				out_object.first_vertex_index= out_object.vertex_count= 0u;
-
-				for( const BaseDataRepresentation::Multipolygon::Part& inner_ring : in_object.multipolygon->inner_rings )
-				{
-					out_object.multipolygon->inner_rings.emplace_back();
-					BaseDataRepresentation::Multipolygon::Part& out_ring= out_object.multipolygon->inner_rings.back();
-
-					out_ring.first_vertex_index= result.areal_objects_vertices.size();
-					out_ring.vertex_count= inner_ring.vertex_count;
-					result.areal_objects_vertices.insert( result.areal_objects_vertices.end(), data.areal_objects_vertices.data() + inner_ring.first_vertex_index, data.areal_objects_vertices.data() + inner_ring.first_vertex_index + inner_ring.vertex_count );
-				}
-				for( const BaseDataRepresentation::Multipolygon::Part& outer_ring : in_object.multipolygon->outer_rings )
-				{
-					out_object.multipolygon->outer_rings.emplace_back();
-					BaseDataRepresentation::Multipolygon::Part& out_ring= out_object.multipolygon->outer_rings.back();
-
-					out_ring.first_vertex_index= result.areal_objects_vertices.size();
-					out_ring.vertex_count= outer_ring.vertex_count;
-					result.areal_objects_vertices.insert( result.areal_objects_vertices.end(), data.areal_objects_vertices.data() + outer_ring.first_vertex_index, data.areal_objects_vertices.data() + outer_ring.first_vertex_index + outer_ring.vertex_count );
-				}
-			}
-			else
-			{
-				out_object.first_vertex_index= result.areal_objects_vertices.size();
-				out_object.vertex_count= in_object.vertex_count;
-				for( size_t v= 0u; v < in_object.vertex_count; ++v )
-					result.areal_objects_vertices.push_back( data.areal_objects_vertices[ in_object.first_vertex_index + v ] );
-			}
-			areal_objects.push_back( std::move(out_object) );
+			int64_t accumulated_area= 0;
+			// Area = total area of outer polygons - area of holes.
+			const ObjectsData::MultipolygonRing* const rings= data.multipolygons_rings.data() + polygon.first_ring_index;
+			for( uint32_t r= 0u; r < polygon.outer_ring_count; ++r )
+				accumulated_area+= std::abs( CalculatePolygonDoubleSignedArea( data.areal_objects_vertices.data() + rings[r].first_vertex_index, rings[r].vertex_count ) );
+			for( uint32_t r= polygon.outer_ring_count; r < polygon.outer_ring_count + polygon.inner_ring_count; ++r )
+				accumulated_area-= std::abs( CalculatePolygonDoubleSignedArea( data.areal_objects_vertices.data() + rings[r].first_vertex_index, rings[r].vertex_count ) );
+			areal_objects_double_area[i]= accumulated_area;
 		}
+		else
+			areal_objects_double_area[i]= std::abs( CalculatePolygonDoubleSignedArea( data.areal_objects_vertices.data() + polygon.first_vertex_index, polygon.vertex_count ) );
+	}
 
-		const auto calculate_polyon_double_area=
-		[&]( const  ObjectsData::ArealObject& polygon ) -> int64_t
+	std::vector<BaseDataRepresentation::ArealObject> result_areal_objects;
+	result_areal_objects.reserve( data.areal_objects.size() );
+	std::vector<size_t> phase_objects;
+	for( size_t z_level= 0u; z_level <= g_max_z_level; ++z_level )
+	for( const Styles::ArealObjectPhase& phase : zoom_level.areal_object_phases )
+	{
+		phase_objects.clear();
+		for( size_t i= 0u; i < data.areal_objects.size(); ++i )
 		{
-			if( polygon.multipolygon != nullptr )
-			{
-				int64_t accumulated_area= 0;
-				// Area = total area of outer polygons - area of holes.
-				for( const ObjectsData::Multipolygon::Part& outer_ring : polygon.multipolygon->outer_rings )
-					accumulated_area+= std::abs( CalculatePolygonDoubleSignedArea( result.areal_objects_vertices.data() + outer_ring.first_vertex_index, outer_ring.vertex_count ) );
-
-				for( const ObjectsData::Multipolygon::Part& inner_ring : polygon.multipolygon->inner_rings )
-					accumulated_area-= std::abs( CalculatePolygonDoubleSignedArea( result.areal_objects_vertices.data() + inner_ring.first_vertex_index, inner_ring.vertex_count ) );
-				return accumulated_area;
-			}
-			else
-				return std::abs( CalculatePolygonDoubleSignedArea( result.areal_objects_vertices.data() + polygon.first_vertex_index, polygon.vertex_count ) );
-		};
+			const BaseDataRepresentation::ArealObject& in_object= data.areal_objects[i];
+			if( in_object.z_level == z_level && phase.classes.count(in_object.class_) != 0 )
+				phase_objects.push_back(i);
+		}
 
 		// Sort by area in descent order.
-		std::sort(
-			areal_objects.begin(),
-			areal_objects.end(),
-			[&]( const ObjectsData::ArealObject& l, const ObjectsData::ArealObject& r )
+		std::stable_sort(
+			phase_objects.begin(),
+			phase_objects.end(),
+			[&]( const size_t l, const size_t r )
 			{
-				return calculate_polyon_double_area(l) > calculate_polyon_double_area(r);
+				return areal_objects_double_area[l] > areal_objects_double_area[r];
 			} );
 
-		for( auto& areal_object : areal_objects )
-			result.areal_objects.push_back( std::move(areal_object) );
+		for( const size_t object_index : phase_objects )
+			result_areal_objects.push_back( data.areal_objects[object_index] );
 	}
 
-	data.point_objects= std::move(result.point_objects);
-	data.point_objects_vertices= std::move(result.point_objects_vertices);
-	data.linear_objects= std::move(result.linear_objects);
-	data.linear_objects_vertices= std::move(result.linear_objects_vertices);
-	data.areal_objects= std::move(result.areal_objects);
-	data.areal_objects_vertices= std::move(result.areal_objects_vertices);
+	data.point_objects= std::move(result_point_objects);
+	data.point_objects_vertices= std::move(result_point_objects_vertices);
+	data.linear_objects= std::move(result_linear_objects);
+	data.areal_objects= std::move(result_areal_objects);
 
 	PM_ASSERT( data.point_objects.size() == data.point_objects_vertices.size() );
 
@@ -8,6 +8,7 @@ namespace PanzerMaps
 // Point objects ordered by class in specified in styles order.
 // Linear ordered by z_level, then, by class in specified in styles order.
 // Areal objects in output sorted by z_level, inside z_level sorded by phase, inside phase it's sorted by area in descent order.
+// Vertices of linear and areal objects are not moved, so, objects after this pass refer to vertices in arbitrary order.
 void SortByPhase( ObjectsData& data, const Styles::ZoomLevel& zoom_level );
 
 } // namespace PanzerMaps
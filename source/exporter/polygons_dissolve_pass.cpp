@@ -0,0 +1,537 @@
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <unordered_map>
+#include "../common/assert.hpp"
+#include "../common/log.hpp"
+#include "polygons_dissolve_pass.hpp"
+
+namespace PanzerMaps
+{
+
+// Closing is performed tile by tile, boundary edges of all tiles are traced together, so, result objects are not cut by tiles.
+static const int32_t c_tile_size_cells= 512;
+static const int32_t c_max_cell_size_units= 16;
+static const int32_t c_max_dissolve_radius_cells= 16;
+
+// Directions of boundary edges. Filled cells are always at left side of edge.
+static const int32_t c_direction_x[4]= { 1, 0, -1, 0 };
+static const int32_t c_direction_y[4]= { 0, 1, 0, -1 };
+
+// Filled cells [column_start; column_end) of row of source object.
+struct CellsSpan
+{
+	int32_t row;
+	int32_t column_start;
+	int32_t column_end;
+	int32_t object_index;
+};
+
+// Outgoing boundary edges of grid corner.
+struct CornerEdges
+{
+	uint8_t directions= 0u;
+	int32_t left_cell_object_index[4]; // Source object of filled cell at left side of edge, or -1, if cell is filled by closing.
+};
+
+// Step of ring tracing - boundary edge, starting at grid corner.
+struct RingStep
+{
+	int32_t x;
+	int32_t y;
+	uint32_t direction;
+};
+
+// Ring vertex in half-cell units.
+struct HalfCellPoint
+{
+	int64_t x;
+	int64_t y;
+};
+
+static int32_t FloorDiv( const int64_t x, const int32_t y )
+{
+	return static_cast<int32_t>( x >= 0 ? x / y : -( ( -x + y - 1 ) / y ) );
+}
+
+static uint64_t GetCornerKey( const int32_t x, const int32_t y )
+{
+	return ( uint64_t( uint32_t(y) ) << 32 ) | uint64_t( uint32_t(x) );
+}
+
+// Returns positive value for rings with filled cells at left side.
+static double CalculateRingDoubleSignedArea( const std::vector<HalfCellPoint>& ring )
+{
+	double area= 0.0;
+	for( size_t i= 0u; i < ring.size(); ++i )
+	{
+		const HalfCellPoint& v0= ring[i];
+		const HalfCellPoint& v1= ring[ ( i + 1u ) % ring.size() ];
+		area+= double(v0.x) * double(v1.y) - double(v1.x) * double(v0.y);
+	}
+	return area;
+}
+
+static bool IsPointInsideRing( const HalfCellPoint& point, const std::vector<HalfCellPoint>& ring )
+{
+	bool inside= false;
+	for( size_t i= 0u; i < ring.size(); ++i )
+	{
+		const HalfCellPoint& v0= ring[i];
+		const HalfCellPoint& v1= ring[ ( i + 1u ) % ring.size() ];
+		if( ( v0.y > point.y ) == ( v1.y > point.y ) )
+			continue;
+		const double crossing_x= double(v0.x) + double( point.y - v0.y ) * double( v1.x - v0.x ) / double( v1.y - v0.y );
+		if( double(point.x) < crossing_x )
+			inside= !inside;
+	}
+	return inside;
+}
+
+// Dilation/erosion with square structuring element, performed along one axis. Cells outside grid are empty.
+static void ApplyMorphologyOperation(
+	const std::vector<uint8_t>& src,
+	std::vector<uint8_t>& dst,
+	const int32_t size,
+	const int32_t radius,
+	const bool along_x,
+	const bool erode )
+{
+	const int32_t window_size= radius * 2 + 1;
+	for( int32_t line= 0; line < size; ++line )
+	{
+		const auto cell_index=
+		[&]( const int32_t i ) -> size_t
+		{
+			return along_x ? size_t( line * size + i ) : size_t( i * size + line );
+		};
+
+		// Count of filled cells in window [i - radius; i + radius].
+		int32_t filled_in_window= 0;
+		for( int32_t i= 0; i < std::min( radius, size ); ++i )
+			filled_in_window+= src[ cell_index(i) ];
+
+		for( int32_t i= 0; i < size; ++i )
+		{
+			if( i + radius < size )
+				filled_in_window+= src[ cell_index( i + radius ) ];
+			if( i - radius - 1 >= 0 )
+				filled_in_window-= src[ cell_index( i - radius - 1 ) ];
+
+			dst[ cell_index(i) ]= erode ? ( filled_in_window == window_size ) : ( filled_in_window > 0 );
+		}
+	}
+}
+
+void DissolvePolygons( ObjectsData& data, const Styles::ZoomLevel& zoom_level )
+{
+	// Select classes for dissolving.
+	float dissolve_distance_m[ size_t(ArealObjectClass::Last) ];
+	int32_t cell_size[ size_t(ArealObjectClass::Last) ];
+	bool any_class_dissolved= false;
+	for( size_t i= 0u; i < size_t(ArealObjectClass::Last); ++i )
+	{
+		dissolve_distance_m[i]= -1.0f;
+		cell_size[i]= std::max( 1, zoom_level.simplification_distance );
+
+		const auto style_it= zoom_level.areal_object_styles.find( static_cast<ArealObjectClass>(i) );
+		if( style_it == zoom_level.areal_object_styles.end() )
+			continue;
+
+		dissolve_distance_m[i]= style_it->second.dissolve_distance_m;
+		any_class_dissolved= any_class_dissolved || dissolve_distance_m[i] >= 0.0f;
+		if( style_it->second.simplification_distance_m >= 0.0f && data.meters_in_unit > 0.0f )
+			cell_size[i]= std::max( 1, std::min( int32_t( style_it->second.simplification_distance_m / data.meters_in_unit ), c_max_cell_size_units ) );
+	}
+	if( !any_class_dissolved )
+		return;
+
+	// Group objects by class and z_level.
+	std::map< std::pair<ArealObjectClass, uint8_t>, std::vector<size_t> > groups;
+	std::vector<ObjectsData::ArealObject> result_areal_objects;
+	for( const ObjectsData::ArealObject& object : data.areal_objects )
+	{
+		if( dissolve_distance_m[ size_t(object.class_) ] >= 0.0f )
+			groups[ std::make_pair( object.class_, object.z_level ) ].push_back( size_t( &object - data.areal_objects.data() ) );
+		else
+			result_areal_objects.push_back( object );
+	}
+
+	const size_t source_object_count= data.areal_objects.size();
+	size_t dissolved_object_count= 0u;
+
+	std::vector<ObjectsData::MultipolygonRing> object_rings;
+	std::vector< std::pair<int32_t, double> > row_crossings; // Row, x in cells.
+	std::vector<uint8_t> grid, grid_tmp;
+	std::vector<int32_t> grid_object_index;
+	std::unordered_map<uint64_t, CornerEdges> corners;
+	std::vector<uint64_t> corners_keys;
+	std::vector<RingStep> ring_steps;
+	std::vector<HalfCellPoint> ring_points;
+
+	struct Ring
+	{
+		std::vector<HalfCellPoint> points;
+		HalfCellPoint min, max;
+		double area; // Positive for outer rings, negative for holes.
+		HalfCellPoint inner_point; // Center of any filled cell near ring.
+		int32_t object_index; // Any source object near ring, or -1.
+		std::vector<size_t> holes;
+	};
+	std::vector<Ring> rings;
+
+	for( const auto& group : groups )
+	{
+		const ArealObjectClass object_class= group.first.first;
+		const int32_t cell= cell_size[ size_t(object_class) ];
+		const float dissolve_distance_units= data.meters_in_unit > 0.0f ? dissolve_distance_m[ size_t(object_class) ] / data.meters_in_unit : 0.0f;
+		// Closing with radius r fills gaps with width up to 2 * r.
+		const int32_t radius= std::min( int32_t( std::ceil( dissolve_distance_units / float( 2 * cell ) ) ), c_max_dissolve_radius_cells );
+		// Erosion of dilated cells needs source cells in radius 2 * r. One more cell is needed for neighbors of tile border cells.
+		const int32_t margin= 2 * radius + 1;
+		const int32_t grid_size= c_tile_size_cells + 2 * margin;
+
+		// Rasterize each object once, into spans of cells. Cell is filled, if its center is inside object.
+		std::map< std::pair<int32_t, int32_t>, std::vector<CellsSpan> > tiles_spans;
+		for( const size_t object_index : group.second )
+		{
+			const ObjectsData::ArealObject& object= data.areal_objects[object_index];
+			object_rings.clear();
+			if( object.IsMultipolygon() )
+				object_rings.insert(
+					object_rings.end(),
+					data.multipolygons_rings.begin() + std::ptrdiff_t(object.first_ring_index),
+					data.multipolygons_rings.begin() + std::ptrdiff_t(object.first_ring_index + object.outer_ring_count + object.inner_ring_count) );
+			else
+				object_rings.push_back( ObjectsData::MultipolygonRing{ object.first_vertex_index, object.vertex_count } );
+
+			row_crossings.clear();
+			for( const ObjectsData::MultipolygonRing& ring : object_rings )
+			for( size_t v= 0u; v < ring.vertex_count; ++v )
+			{
+				const ObjectsData::VertexTransformed& v0= data.areal_objects_vertices[ ring.first_vertex_index + v ];
+				const ObjectsData::VertexTransformed& v1= data.areal_objects_vertices[ ring.first_vertex_index + ( v + 1u ) % ring.vertex_count ];
+				const double x0= double( int64_t(v0.x) - data.min_point.x ) / double(cell);
+				const double y0= double( int64_t(v0.y) - data.min_point.y ) / double(cell);
+				const double x1= double( int64_t(v1.x) - data.min_point.x ) / double(cell);
+				const double y1= double( int64_t(v1.y) - data.min_point.y ) / double(cell);
+				if( y0 == y1 )
+					continue;
+
+				const int32_t row_start= int32_t( std::ceil ( std::min( y0, y1 ) - 0.5 ) );
+				const int32_t row_end  = int32_t( std::floor( std::max( y0, y1 ) - 0.5 ) );
+				for( int32_t row= row_start; row <= row_end; ++row )
+				{
+					const double row_center= double(row) + 0.5;
+					if( ( y0 <= row_center ) != ( y1 <= row_center ) )
+						row_crossings.emplace_back( row, x0 + ( row_center - y0 ) * ( x1 - x0 ) / ( y1 - y0 ) );
+				}
+			}
+
+			// Fill cells between pairs of crossings. Crossings of all rings are used together - holes are not filled.
+			std::sort( row_crossings.begin(), row_crossings.end() );
+			for( size_t i= 0u; i + 1u < row_crossings.size(); )
+			{
+				if( row_crossings[i].first != row_crossings[i + 1u].first )
+				{
+					++i; // Broken object, skip unpaired crossing.
+					continue;
+				}
+
+				CellsSpan span;
+				span.row= row_crossings[i].first;
+				span.column_start= int32_t( std::ceil( row_crossings[i     ].second - 0.5 ) );
+				span.column_end  = int32_t( std::ceil( row_crossings[i + 1u].second - 0.5 ) );
+				span.object_index= int32_t(object_index);
+				i+= 2u;
+				if( span.column_start >= span.column_end )
+					continue;
+
+				// Put span into each tile, which grid (with margins) contains it.
+				for( int32_t tile_y= FloorDiv( span.row - margin, c_tile_size_cells ); tile_y <= FloorDiv( span.row + margin, c_tile_size_cells ); ++tile_y )
+				for( int32_t tile_x= FloorDiv( span.column_start - margin, c_tile_size_cells ); tile_x <= FloorDiv( span.column_end - 1 + margin, c_tile_size_cells ); ++tile_x )
+					tiles_spans[ std::make_pair( tile_x, tile_y ) ].push_back( span );
+			}
+		}
+
+		// Perform closing for each tile and collect boundary edges of tile cells.
+		corners.clear();
+		for( const auto& tile : tiles_spans )
+		{
+			// Cell coordinates of tile start and grid start.
+			const int32_t tile_x= tile.first.first  * c_tile_size_cells;
+			const int32_t tile_y= tile.first.second * c_tile_size_cells;
+			const int32_t grid_x= tile_x - margin;
+			const int32_t grid_y= tile_y - margin;
+
+			grid.clear();
+			grid.resize( size_t( grid_size * grid_size ), 0u );
+			grid_object_index.clear();
+			grid_object_index.resize( grid.size(), -1 );
+			for( const CellsSpan& span : tile.second )
+			{
+				const int32_t row= span.row - grid_y;
+				const int32_t column_start= std::max( 0, span.column_start - grid_x );
+				const int32_t column_end= std::min( grid_size, span.column_end - grid_x );
+				for( int32_t column= column_start; column < column_end; ++column )
+				{
+					grid[ size_t( row * grid_size + column ) ]= 1u;
+					grid_object_index[ size_t( row * grid_size + column ) ]= span.object_index;
+				}
+			}
+
+			// Morphological closing - merge near objects, fill small holes.
+			if( radius > 0 )
+			{
+				grid_tmp.resize( grid.size() );
+				ApplyMorphologyOperation( grid, grid_tmp, grid_size, radius, true , false );
+				ApplyMorphologyOperation( grid_tmp, grid, grid_size, radius, false, false );
+				ApplyMorphologyOperation( grid, grid_tmp, grid_size, radius, true , true  );
+				ApplyMorphologyOperation( grid_tmp, grid, grid_size, radius, false, true  );
+			}
+
+			// Coordinates are relative to tile start. Cells near tile are valid too, because margin is big enough.
+			const auto is_filled=
+			[&]( const int32_t x, const int32_t y ) -> bool
+			{
+				return grid[ size_t( ( y + margin ) * grid_size + ( x + margin ) ) ] != 0u;
+			};
+
+			// Each edge is produced only by tile of its filled cell.
+			const auto add_edge=
+			[&]( const int32_t corner_x, const int32_t corner_y, const uint32_t direction, const int32_t object_index )
+			{
+				CornerEdges& corner_edges= corners[ GetCornerKey( tile_x + corner_x, tile_y + corner_y ) ];
+				corner_edges.directions|= static_cast<uint8_t>( 1u << direction );
+				corner_edges.left_cell_object_index[direction]= object_index;
+			};
+
+			for( int32_t y= 0; y < c_tile_size_cells; ++y )
+			for( int32_t x= 0; x < c_tile_size_cells; ++x )
+			{
+				if( !is_filled( x, y ) )
+					continue;
+				const int32_t object_index= grid_object_index[ size_t( ( y + margin ) * grid_size + ( x + margin ) ) ];
+				if( !is_filled( x, y - 1 ) )
+					add_edge( x, y, 0u, object_index );
+				if( !is_filled( x + 1, y ) )
+					add_edge( x + 1, y, 1u, object_index );
+				if( !is_filled( x, y + 1 ) )
+					add_edge( x + 1, y + 1, 2u, object_index );
+				if( !is_filled( x - 1, y ) )
+					add_edge( x, y + 1, 3u, object_index );
+			}
+		}
+
+		// Trace rings. On each corner try to turn left first - this keeps diagonally adjacent cells separate.
+		corners_keys.clear();
+		for( const auto& corner : corners )
+			corners_keys.push_back( corner.first );
+		std::sort( corners_keys.begin(), corners_keys.end() ); // Make result independent on hash map order.
+
+		rings.clear();
+		for( const uint64_t start_key : corners_keys )
+		{
+			CornerEdges& start_corner_edges= corners[start_key];
+			while( start_corner_edges.directions != 0u )
+			{
+				uint32_t start_direction= 0u;
+				while( ( start_corner_edges.directions & ( 1u << start_direction ) ) == 0u )
+					++start_direction;
+
+				const int32_t start_x= int32_t( uint32_t( start_key ) ), start_y= int32_t( uint32_t( start_key >> 32 ) );
+				const int32_t left_cell_x= start_direction == 0u || start_direction == 3u ? start_x : start_x - 1;
+				const int32_t left_cell_y= start_direction == 0u || start_direction == 1u ? start_y : start_y - 1;
+
+				Ring ring;
+				ring.inner_point= HalfCellPoint{ 2 * int64_t(left_cell_x) + 1, 2 * int64_t(left_cell_y) + 1 };
+				ring.object_index= -1;
+
+				ring_steps.clear();
+				int32_t x= start_x, y= start_y;
+				uint32_t direction= start_direction;
+				CornerEdges* corner_edges= &start_corner_edges;
+				while(true)
+				{
+					ring_steps.push_back( RingStep{ x, y, direction } );
+					if( ring.object_index < 0 )
+						ring.object_index= corner_edges->left_cell_object_index[direction];
+					corner_edges->directions&= static_cast<uint8_t>( ~( 1u << direction ) );
+					x+= c_direction_x[direction];
+					y+= c_direction_y[direction];
+
+					const auto it= corners.find( GetCornerKey( x, y ) );
+					PM_ASSERT( it != corners.end() );
+					if( it == corners.end() )
+						break;
+					corner_edges= &it->second;
+
+					bool closed= false, found= false;
+					for( const uint32_t turn : { 1u, 0u, 3u } )
+					{
+						const uint32_t next_direction= ( direction + turn ) & 3u;
+						if( x == start_x && y == start_y && next_direction == start_direction )
+						{
+							closed= true;
+							break;
+						}
+						if( ( corner_edges->directions & ( 1u << next_direction ) ) != 0u )
+						{
+							direction= next_direction;
+							found= true;
+							break;
+						}
+					}
+					if( closed || !found )
+						break;
+				}
+
+				// Use middles of boundary edges as vertices, so, steps of cells become straight lines.
+				// Keep corners between straight runs longer than one cell - sides of rectangular objects are not cut.
+				size_t first_step= 0u;
+				while( first_step < ring_steps.size() && ring_steps[first_step].direction == ring_steps[ ( first_step + ring_steps.size() - 1u ) % ring_steps.size() ].direction )
+					++first_step;
+				if( first_step == ring_steps.size() )
+					continue;
+
+				ring_points.clear();
+				size_t prev_run_length= 0u;
+				for( size_t run_start= 0u; run_start < ring_steps.size(); )
+				{
+					size_t run_length= 1u;
+					const RingStep& step= ring_steps[ ( first_step + run_start ) % ring_steps.size() ];
+					while( run_start + run_length < ring_steps.size() && ring_steps[ ( first_step + run_start + run_length ) % ring_steps.size() ].direction == step.direction )
+						++run_length;
+					if( run_start == 0u )
+					{
+						// Length of last run is needed for first corner.
+						prev_run_length= 1u;
+						while( ring_steps[ ( first_step + ring_steps.size() - 1u - prev_run_length ) % ring_steps.size() ].direction == ring_steps[ ( first_step + ring_steps.size() - 1u ) % ring_steps.size() ].direction )
+							++prev_run_length;
+					}
+
+					if( prev_run_length >= 2u && run_length >= 2u )
+						ring_points.push_back( HalfCellPoint{ 2 * int64_t(step.x), 2 * int64_t(step.y) } );
+					for( size_t i= 0u; i < run_length; ++i )
+					{
+						const RingStep& run_step= ring_steps[ ( first_step + run_start + i ) % ring_steps.size() ];
+						ring_points.push_back(
+							HalfCellPoint{
+								2 * int64_t(run_step.x) + c_direction_x[run_step.direction],
+								2 * int64_t(run_step.y) + c_direction_y[run_step.direction] } );
+					}
+
+					prev_run_length= run_length;
+					run_start+= run_length;
+				}
+
+				// Remove middle points of straight segments.
+				for( size_t i= 0u; i < ring_points.size(); ++i )
+				{
+					const HalfCellPoint& prev= ring_points[ ( i + ring_points.size() - 1u ) % ring_points.size() ];
+					const HalfCellPoint& cur= ring_points[i];
+					const HalfCellPoint& next= ring_points[ ( i + 1u ) % ring_points.size() ];
+					if( ( cur.x - prev.x ) * ( next.y - cur.y ) != ( cur.y - prev.y ) * ( next.x - cur.x ) )
+						ring.points.push_back( cur );
+				}
+				if( ring.points.size() < 3u )
+					continue;
+
+				ring.min= ring.max= ring.points.front();
+				for( const HalfCellPoint& point : ring.points )
+				{
+					ring.min.x= std::min( ring.min.x, point.x );
+					ring.min.y= std::min( ring.min.y, point.y );
+					ring.max.x= std::max( ring.max.x, point.x );
+					ring.max.y= std::max( ring.max.y, point.y );
+				}
+				ring.area= CalculateRingDoubleSignedArea( ring.points );
+				rings.push_back( std::move(ring) );
+			}
+		}
+
+		// Put each hole into smallest outer ring, containing it.
+		std::vector<size_t> outer_rings;
+		for( size_t i= 0u; i < rings.size(); ++i )
+			if( rings[i].area > 0.0 )
+				outer_rings.push_back(i);
+		std::sort(
+			outer_rings.begin(), outer_rings.end(),
+			[&]( const size_t l, const size_t r ) { return rings[l].area < rings[r].area; } );
+
+		for( size_t i= 0u; i < rings.size(); ++i )
+		{
+			if( rings[i].area > 0.0 )
+				continue;
+			const HalfCellPoint& point= rings[i].inner_point;
+			for( const size_t outer_ring_index : outer_rings )
+			{
+				const Ring& outer_ring= rings[outer_ring_index];
+				if( point.x >= outer_ring.min.x && point.x <= outer_ring.max.x && point.y >= outer_ring.min.y && point.y <= outer_ring.max.y &&
+					IsPointInsideRing( point, outer_ring.points ) )
+				{
+					rings[outer_ring_index].holes.push_back(i);
+					break;
+				}
+			}
+		}
+
+		// Create objects.
+		const auto put_ring=
+		[&]( const Ring& ring )
+		{
+			for( const HalfCellPoint& point : ring.points )
+				data.areal_objects_vertices.push_back(
+					ObjectsData::VertexTransformed{
+						static_cast<int32_t>( data.min_point.x + FloorDiv( point.x * cell, 2 ) ),
+						static_cast<int32_t>( data.min_point.y + FloorDiv( point.y * cell, 2 ) ) } );
+		};
+
+		for( const Ring& ring : rings )
+		{
+			if( ring.area <= 0.0 )
+				continue;
+
+			ObjectsData::ArealObject out_object;
+			out_object.class_= object_class;
+			out_object.z_level= group.first.second;
+			// Result object is union of many source objects, take id of one of them.
+			out_object.osm_id= ring.object_index >= 0 ? data.areal_objects[ size_t(ring.object_index) ].osm_id : 0u;
+			if( ring.holes.empty() )
+			{
+				out_object.first_vertex_index= static_cast<ObjectsData::VertexIndex>( data.areal_objects_vertices.size() );
+				out_object.vertex_count= static_cast<ObjectsData::VertexIndex>( ring.points.size() );
+				put_ring( ring );
+			}
+			else
+			{
+				out_object.first_vertex_index= out_object.vertex_count= 0u;
+				out_object.first_ring_index= static_cast<uint32_t>( data.multipolygons_rings.size() );
+				out_object.outer_ring_count= 1u;
+				out_object.inner_ring_count= static_cast<uint32_t>( ring.holes.size() );
+				for( size_t i= 0u; i <= ring.holes.size(); ++i )
+				{
+					const Ring& out_ring_source= i == 0u ? ring : rings[ ring.holes[ i - 1u ] ];
+					ObjectsData::MultipolygonRing out_ring;
+					out_ring.first_vertex_index= static_cast<ObjectsData::VertexIndex>( data.areal_objects_vertices.size() );
+					out_ring.vertex_count= static_cast<ObjectsData::VertexIndex>( out_ring_source.points.size() );
+					data.multipolygons_rings.push_back( out_ring );
+					put_ring( out_ring_source );
+				}
+			}
+			result_areal_objects.push_back( out_object );
+			++dissolved_object_count;
+		}
+	}
+
+	// Vertices of source objects are not removed here - simplification pass compacts vertices.
+	data.areal_objects= std::move(result_areal_objects);
+
+	Log::Info( "Polygons dissolve pass: " );
+	Log::Info( groups.size(), " groups of dissolved objects" );
+	Log::Info( source_object_count, " areal objects before" );
+	Log::Info( data.areal_objects.size(), " areal objects after, ", dissolved_object_count, " of them are dissolved" );
+	Log::Info( "" );
+}
+
+} // namespace PanzerMaps
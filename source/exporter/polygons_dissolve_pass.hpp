@@ -0,0 +1,14 @@
+#pragma once
+#include "coordinates_transformation_pass.hpp"
+#include "styles.hpp"
+
+namespace PanzerMaps
+{
+
+// Union areal objects with same class and z_level, if "dissolve_distance_m" is specified for class in zoom level styles.
+// Objects, closer to each other than dissolve distance, are merged too, holes, smaller than this distance, are filled.
+// Union is performed on raster with cell size equal to simplification distance, so, result is approximate.
+// Result outlines pass through middles of raster cells edges.
+void DissolvePolygons( ObjectsData& data, const Styles::ZoomLevel& zoom_level );
+
+} // namespace PanzerMaps
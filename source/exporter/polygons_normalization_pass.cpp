@@ -1,4 +1,9 @@
 #include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <set>
+#include <thread>
+#include <unordered_map>
 #include "../common/assert.hpp"
 #include "../common/log.hpp"
 #include "geometry_utils.hpp"
@@ -39,20 +44,20 @@ static int32_t SegemntsIntersects(
 	const ProjectionPoint& e0v0, const ProjectionPoint& e0v1,
 	const ProjectionPoint& e1v0, const ProjectionPoint& e1v1 )
 {
-	const int32_t e0_dx= e0v1.x - e0v0.x;
-	const int32_t e0_dy= e0v1.y - e0v0.y;
+	const int64_t e0_dx= int64_t(e0v1.x) - int64_t(e0v0.x);
+	const int64_t e0_dy= int64_t(e0v1.y) - int64_t(e0v0.y);
 
-	const int32_t e1_dx= e1v1.x - e1v0.x;
-	const int32_t e1_dy= e1v1.y - e1v0.y;
+	const int64_t e1_dx= int64_t(e1v1.x) - int64_t(e1v0.x);
+	const int64_t e1_dy= int64_t(e1v1.y) - int64_t(e1v0.y);
 
-	const int64_t denom= int64_t(e1_dx) * int64_t(e0_dy) - int64_t(e0_dx) * int64_t(e1_dy);
+	const int64_t denom= e1_dx * e0_dy - e0_dx * e1_dy;
 	if( denom == 0 )
 		return -1;
 	const int64_t abs_denom= std::abs(denom);
 	const int64_t denom_sign= denom > 0 ? +1 : -1;
 
-	const int32_t dx0= e1v0.x - e0v0.x;
-	const int32_t dy0= e1v0.y - e0v0.y;
+	const int64_t dx0= int64_t(e1v0.x) - int64_t(e0v0.x);
+	const int64_t dy0= int64_t(e1v0.y) - int64_t(e0v0.y);
 	const int64_t s= ( -e0_dy * dx0 + e0_dx * dy0 ) * denom_sign;
 	const int64_t t= ( +e1_dx * dy0 - e1_dy * dx0 ) * denom_sign;
 
@@ -77,200 +82,848 @@ static bool VertexOnEdge( const ProjectionPoint& ev0, const ProjectionPoint& ev1
 
 }
 
-static std::vector< std::vector<ProjectionPoint> > SplitPolygonIntNoncrossingParts( const std::vector<ProjectionPoint>& vertices )
+struct ProjectionPointHasher
 {
-	for( size_t e0= 0u; e0 < vertices.size(); ++e0 )
-	for( size_t e1= 0u; e1 < vertices.size(); ++e1 )
+	size_t operator()( const ProjectionPoint& point ) const
 	{
-		if( e0 == e1 ||
-			( e0 + 1u ) % vertices.size() == e1 ||
-			( e1 + 1u ) % vertices.size() == e0 ||
-			( e0 + 1u ) % vertices.size() == (e1 + 1u)  % vertices.size() )
-			continue;
+		return std::hash<int32_t>()(point.x) ^ ( std::hash<int32_t>()(point.y) * 31u );
+	}
+};
 
-		const ProjectionPoint& e0v0= vertices[e0];
-		const ProjectionPoint& e0v1= vertices[ (e0+1u) % vertices.size() ];
+struct EdgeIntersection
+{
+	int64_t position; // Position along edge. Used only for sorting of intersections.
+	ProjectionPoint point;
+};
 
-		const ProjectionPoint& e1v0= vertices[e1];
-		const ProjectionPoint& e1v1= vertices[ (e1+1u) % vertices.size() ];
+// Returns true, if edges crosses or touches.
+static bool GetEdgesIntersection(
+	const ProjectionPoint& e0v0, const ProjectionPoint& e0v1,
+	const ProjectionPoint& e1v0, const ProjectionPoint& e1v1,
+	ProjectionPoint& out_point )
+{
+	const int64_t e0_dx= int64_t(e0v1.x) - int64_t(e0v0.x);
+	const int64_t e0_dy= int64_t(e0v1.y) - int64_t(e0v0.y);
 
-		const int32_t e0_dx= e0v1.x - e0v0.x;
-		const int32_t e0_dy= e0v1.y - e0v0.y;
+	const int64_t e1_dx= int64_t(e1v1.x) - int64_t(e1v0.x);
+	const int64_t e1_dy= int64_t(e1v1.y) - int64_t(e1v0.y);
 
-		const int32_t e1_dx= e1v1.x - e1v0.x;
-		const int32_t e1_dy= e1v1.y - e1v0.y;
+	const int64_t denom= e1_dx * e0_dy - e0_dx * e1_dy;
+	if( denom == 0 )
+		return false;
+	const int64_t abs_denom= std::abs(denom);
+	const int64_t denom_sign= denom > 0 ? +1 : -1;
 
-		const int64_t denom= int64_t(e1_dx) * int64_t(e0_dy) - int64_t(e0_dx) * int64_t(e1_dy);
-		if( denom == 0 )
-			continue;
-		const int64_t abs_denom= std::abs(denom);
-		const int64_t denom_sign= denom > 0 ? +1 : -1;
-
-		const int32_t dx0= e1v0.x - e0v0.x;
-		const int32_t dy0= e1v0.y - e0v0.y;
-		const int64_t s= ( -e0_dy * dx0 + e0_dx * dy0 ) * denom_sign;
-		const int64_t t= ( +e1_dx * dy0 - e1_dy * dx0 ) * denom_sign;
-
-		if( s >= 0 && s <= abs_denom && t >= 0 && t <= abs_denom )
-		{
-			const ProjectionPoint inersection_point{
-				int32_t( e0v0.x + e0_dx * t / abs_denom ),
-				int32_t( e0v0.y + e0_dy * t / abs_denom ) };
-
-			std::vector<ProjectionPoint> res0;
-			const size_t res0_vertex_count= ( vertices.size() + e1 - e0 ) % vertices.size();
-			PM_ASSERT( res0_vertex_count >= 2u );
-			for( size_t i= 0u; i < res0_vertex_count; ++i )
-				res0.push_back( vertices[ ( e0 + 1u + i ) % vertices.size() ] );
-			if( res0.front() != inersection_point && res0.back() != inersection_point )
-				res0.push_back( inersection_point );
-
-			std::vector<ProjectionPoint> res1;
-			const size_t res1_vertex_count= ( vertices.size() + e0 - e1 ) % vertices.size();
-			PM_ASSERT( res1_vertex_count >= 2u );
-			for( size_t i= 0u; i < res1_vertex_count; ++i )
-				res1.push_back( vertices[ ( e1 + 1u + i ) % vertices.size() ] );
-			if( res1.front() != inersection_point && res1.back() != inersection_point )
-				res1.push_back( inersection_point );
-
-			std::vector< std::vector<ProjectionPoint> > res_total;
-			if( res0.size() >= 3u )
-				res_total= SplitPolygonIntNoncrossingParts( res0 );
-
-			if( res1.size() >= 3u )
+	const int64_t dx0= int64_t(e1v0.x) - int64_t(e0v0.x);
+	const int64_t dy0= int64_t(e1v0.y) - int64_t(e0v0.y);
+	const int64_t s= ( -e0_dy * dx0 + e0_dx * dy0 ) * denom_sign;
+	const int64_t t= ( +e1_dx * dy0 - e1_dy * dx0 ) * denom_sign;
+
+	if( !( s >= 0 && s <= abs_denom && t >= 0 && t <= abs_denom ) )
+		return false;
+
+	out_point.x= int32_t( e0v0.x + e0_dx * t / abs_denom );
+	out_point.y= int32_t( e0v0.y + e0_dy * t / abs_denom );
+	return true;
+}
+
+// Some algorithms here have quadratic (or worse) complexity for broken or very complex polygons.
+// Limit amount of work for each object, use fast approximate normalization if this limit is exceeded.
+static const uint64_t c_normalization_operations_per_object= uint64_t(1u) << 26u;
+static const uint64_t c_edges_intersection_operations= 32u; // Intersection point insertion and loops cutting are much more expensive, than edges check.
+// Approximate normalization has its own budget. After it is exceeded, rest of object is dropped.
+static const uint64_t c_trapezoids_operations_per_object= uint64_t(1u) << 28u;
+static const uint64_t c_trapezoid_operations= 64u; // Limit also count of result parts.
+
+struct NormalizationBudget
+{
+	uint64_t operations_left;
+	bool exceeded;
+
+	// Returns false, if budget is exceeded.
+	bool Spend( const uint64_t operations )
+	{
+		if( operations > operations_left )
+		{
+			operations_left= 0u;
+			exceeded= true;
+		}
+		else
+			operations_left-= operations;
+		return !exceeded;
+	}
+};
+
+// Split polygon with self-intersections into parts without self-intersections.
+// Finds all intersections in one sweep over edges, sorted by x, inserts intersection points into edges,
+// than cuts loops, starting and ending in same vertex.
+// Rounding of intersection points may produce new intersections, so, repeat splitting for result parts, but only few times.
+static std::vector< std::vector<ProjectionPoint> > SplitPolygonIntNoncrossingParts(
+	const std::vector<ProjectionPoint>& vertices,
+	NormalizationBudget& budget,
+	const size_t iterations_left= 4u )
+{
+	const size_t vertex_count= vertices.size();
+	if( vertex_count <= 3u )
+		return { vertices };
+
+	std::vector<size_t> edges_sorted( vertex_count );
+	for( size_t i= 0u; i < vertex_count; ++i )
+		edges_sorted[i]= i;
+	const auto edge_min_x= [&]( const size_t e ) { return std::min( vertices[e].x, vertices[ (e+1u) % vertex_count ].x ); };
+	const auto edge_max_x= [&]( const size_t e ) { return std::max( vertices[e].x, vertices[ (e+1u) % vertex_count ].x ); };
+	const auto edge_min_y= [&]( const size_t e ) { return std::min( vertices[e].y, vertices[ (e+1u) % vertex_count ].y ); };
+	const auto edge_max_y= [&]( const size_t e ) { return std::max( vertices[e].y, vertices[ (e+1u) % vertex_count ].y ); };
+	std::sort(
+		edges_sorted.begin(), edges_sorted.end(),
+		[&]( const size_t l, const size_t r ) { return edge_min_x(l) < edge_min_x(r); } );
+
+	// Sweep edges, check only edges with intersected bounding boxes.
+	std::vector< std::vector<EdgeIntersection> > edges_intersections( vertex_count );
+	bool have_intersections= false;
+	std::vector<size_t> active_edges;
+	for( const size_t e0 : edges_sorted )
+	{
+		if( !budget.Spend( active_edges.size() + 1u ) )
+			return { vertices };
+
+		const int32_t e0_min_x= edge_min_x(e0);
+		const int32_t e0_min_y= edge_min_y(e0);
+		const int32_t e0_max_y= edge_max_y(e0);
+		const ProjectionPoint& e0v0= vertices[e0];
+		const ProjectionPoint& e0v1= vertices[ (e0+1u) % vertex_count ];
+
+		for( size_t i= 0u; i < active_edges.size(); )
+		{
+			const size_t e1= active_edges[i];
+			if( edge_max_x(e1) < e0_min_x )
 			{
-				std::vector< std::vector<ProjectionPoint> > res1_splitted= SplitPolygonIntNoncrossingParts( res1 );
-				for( std::vector<ProjectionPoint>& split_result : res1_splitted )
-					res_total.push_back( std::move( split_result ) );
+				// Edge is behind sweep line, remove it.
+				active_edges[i]= active_edges.back();
+				active_edges.pop_back();
+				continue;
 			}
+			++i;
+
+			if( ( e0 + 1u ) % vertex_count == e1 || ( e1 + 1u ) % vertex_count == e0 )
+				continue; // Skip adjusted edges.
+			if( edge_min_y(e1) > e0_max_y || edge_max_y(e1) < e0_min_y )
+				continue;
+
+			const ProjectionPoint& e1v0= vertices[e1];
+			const ProjectionPoint& e1v1= vertices[ (e1+1u) % vertex_count ];
 
-			return res_total;
+			ProjectionPoint intersection_point;
+			if( !GetEdgesIntersection( e0v0, e0v1, e1v0, e1v1, intersection_point ) )
+				continue;
+			if( !budget.Spend( c_edges_intersection_operations ) )
+				return { vertices };
+
+			edges_intersections[e0].push_back(
+				EdgeIntersection{
+					( int64_t(intersection_point.x) - int64_t(e0v0.x) ) * ( int64_t(e0v1.x) - int64_t(e0v0.x) ) +
+					( int64_t(intersection_point.y) - int64_t(e0v0.y) ) * ( int64_t(e0v1.y) - int64_t(e0v0.y) ),
+					intersection_point } );
+			edges_intersections[e1].push_back(
+				EdgeIntersection{
+					( int64_t(intersection_point.x) - int64_t(e1v0.x) ) * ( int64_t(e1v1.x) - int64_t(e1v0.x) ) +
+					( int64_t(intersection_point.y) - int64_t(e1v0.y) ) * ( int64_t(e1v1.y) - int64_t(e1v0.y) ),
+					intersection_point } );
+			have_intersections= true;
 		}
+
+		active_edges.push_back(e0);
 	}
 
-	return { vertices };
+	if( !have_intersections )
+		return { vertices };
+
+	// Build contour with intersection points.
+	std::vector<ProjectionPoint> contour;
+	contour.reserve( vertex_count * 2u );
+	for( size_t e= 0u; e < vertex_count; ++e )
+	{
+		if( contour.empty() || contour.back() != vertices[e] )
+			contour.push_back( vertices[e] );
+
+		std::vector<EdgeIntersection>& intersections= edges_intersections[e];
+		std::sort(
+			intersections.begin(), intersections.end(),
+			[]( const EdgeIntersection& l, const EdgeIntersection& r ) { return l.position < r.position; } );
+		for( const EdgeIntersection& intersection : intersections )
+			if( contour.back() != intersection.point )
+				contour.push_back( intersection.point );
+	}
+	while( contour.size() > 1u && contour.back() == contour.front() )
+		contour.pop_back();
+
+	// Cut loops. Each vertex, visited twice, is start and end of loop.
+	std::vector< std::vector<ProjectionPoint> > result;
+	std::vector<ProjectionPoint> stack;
+	std::unordered_map< ProjectionPoint, size_t, ProjectionPointHasher > stack_vertices; // Vertex to position in stack.
+	stack.reserve( contour.size() );
+	for( const ProjectionPoint& vertex : contour )
+	{
+		const auto it= stack_vertices.find( vertex );
+		if( it == stack_vertices.end() )
+		{
+			stack_vertices.emplace( vertex, stack.size() );
+			stack.push_back( vertex );
+			continue;
+		}
+
+		const size_t loop_start= it->second;
+		if( stack.size() - loop_start >= 3u )
+			result.emplace_back( stack.begin() + std::ptrdiff_t(loop_start), stack.end() );
+
+		for( size_t i= loop_start + 1u; i < stack.size(); ++i )
+			stack_vertices.erase( stack[i] );
+		stack.resize( loop_start + 1u );
+	}
+	if( stack.size() >= 3u )
+		result.push_back( std::move(stack) );
+
+	if( iterations_left == 0u )
+		return result;
+
+	std::vector< std::vector<ProjectionPoint> > result_splitted;
+	for( const std::vector<ProjectionPoint>& part : result )
+		for( std::vector<ProjectionPoint>& part_splitted : SplitPolygonIntNoncrossingParts( part, budget, iterations_left - 1u ) )
+			result_splitted.push_back( std::move(part_splitted) );
+	return result_splitted;
+}
+
+static const size_t c_invalid_index= ~size_t(0u);
+
+struct HalfEdge
+{
+	ProjectionPoint origin;
+	size_t next;
+	size_t prev;
+	size_t twin;
+	size_t polygon; // Index of source polygon.
+	bool removed;
+};
+
+struct DirectedEdge
+{
+	ProjectionPoint v0;
+	ProjectionPoint v1;
+};
+
+static bool operator==( const DirectedEdge& l, const DirectedEdge& r )
+{
+	return l.v0 == r.v0 && l.v1 == r.v1;
 }
 
-// Input polygons must be clockwise
+struct DirectedEdgeHasher
+{
+	size_t operator()( const DirectedEdge& edge ) const
+	{
+		return ProjectionPointHasher()( edge.v0 ) ^ ( ProjectionPointHasher()( edge.v1 ) * 17u );
+	}
+};
+
+// Input polygons must be clockwise and convex.
+// Removes common edges of adjusted polygons, if result polygon is still convex (Hertel-Mehlhorn algorithm).
+// Adjusted edges are found via hash map, removing of edge is O(1).
 static void CombineAdjustedConvexPolygons( std::vector< std::vector<ProjectionPoint> >& polygons )
 {
-	// TODO - optimize it, make something, like O(n*log(n)), rather then O(n^3).
-	if( polygons.size() > 16384u )
-		return;
-	while(true)
+	std::vector<HalfEdge> half_edges;
+	std::unordered_map< DirectedEdge, size_t, DirectedEdgeHasher > edges_map;
+	for( size_t p= 0u; p < polygons.size(); ++p )
 	{
-		bool polygons_combined= false;
-		const size_t mul_limit= std::max( size_t(16u), 4096u / std::max( size_t(1u), polygons.size() ) );
-		for( size_t p0= 0u; p0 < polygons.size(); ++p0 )
+		const std::vector<ProjectionPoint>& polygon= polygons[p];
+		const size_t first_edge= half_edges.size();
+		for( size_t i= 0u; i < polygon.size(); ++i )
 		{
-			const std::vector<ProjectionPoint>& poly0= polygons[p0];
-			if( poly0.size() * 3u > mul_limit )
-				continue;
-			const size_t p0_size_add= poly0.size() * 4u;
+			HalfEdge edge;
+			edge.origin= polygon[i];
+			edge.next= first_edge + ( i + 1u ) % polygon.size();
+			edge.prev= first_edge + ( i + polygon.size() - 1u ) % polygon.size();
+			edge.twin= c_invalid_index;
+			edge.polygon= p;
+			edge.removed= false;
+
+			const auto it= edges_map.emplace( DirectedEdge{ polygon[i], polygon[ ( i + 1u ) % polygon.size() ] }, half_edges.size() );
+			if( !it.second )
+				it.first->second= c_invalid_index; // Same edge in several polygons - polygons are overlapped, do not merge them.
+
+			half_edges.push_back( edge );
+		}
+	}
+
+	for( size_t e= 0u; e < half_edges.size(); ++e )
+	{
+		const ProjectionPoint& v0= half_edges[e].origin;
+		const ProjectionPoint& v1= half_edges[ half_edges[e].next ].origin;
+		if( edges_map[ DirectedEdge{ v0, v1 } ] != e )
+			continue;
+		const auto it= edges_map.find( DirectedEdge{ v1, v0 } );
+		if( it != edges_map.end() )
+			half_edges[e].twin= it->second;
+	}
+
+	// Disjoint sets of merged polygons.
+	std::vector<size_t> polygons_set( polygons.size() );
+	for( size_t p= 0u; p < polygons.size(); ++p )
+		polygons_set[p]= p;
+	const auto find_set=
+	[&]( size_t p ) -> size_t
+	{
+		while( polygons_set[p] != p )
+		{
+			polygons_set[p]= polygons_set[ polygons_set[p] ];
+			p= polygons_set[p];
+		}
+		return p;
+	};
+
+	for( size_t e= 0u; e < half_edges.size(); ++e )
+	{
+		const size_t twin= half_edges[e].twin;
+		if( twin == c_invalid_index || twin < e )
+			continue;
+
+		const size_t set0= find_set( half_edges[e].polygon );
+		const size_t set1= find_set( half_edges[twin].polygon );
+		if( set0 == set1 )
+			continue;
+
+		HalfEdge& edge0= half_edges[e];
+		HalfEdge& edge1= half_edges[twin];
+
+		// Check convexity of result polygon in both vertices of removed edge.
+		const ProjectionPoint& v0_prev= half_edges[ edge0.prev ].origin;
+		const ProjectionPoint& v0_next= half_edges[ half_edges[ edge1.next ].next ].origin;
+		const ProjectionPoint& v1_prev= half_edges[ edge1.prev ].origin;
+		const ProjectionPoint& v1_next= half_edges[ half_edges[ edge0.next ].next ].origin;
+		if( v0_prev == v0_next || v1_prev == v1_next )
+			continue;
+		if( PolygonVertexCross( v0_prev, edge0.origin, v0_next ) < 0 ||
+			PolygonVertexCross( v1_prev, edge1.origin, v1_next ) < 0 )
+			continue;
+
+		half_edges[ edge0.prev ].next= edge1.next;
+		half_edges[ edge1.next ].prev= edge0.prev;
+		half_edges[ edge1.prev ].next= edge0.next;
+		half_edges[ edge0.next ].prev= edge1.prev;
+		edge0.removed= edge1.removed= true;
+		polygons_set[set1]= set0;
+	}
+
+	polygons.clear();
+	for( size_t e= 0u; e < half_edges.size(); ++e )
+	{
+		if( half_edges[e].removed )
+			continue;
+
+		std::vector<ProjectionPoint> polygon;
+		for( size_t polygon_edge= e; !half_edges[polygon_edge].removed; polygon_edge= half_edges[polygon_edge].next )
+		{
+			polygon.push_back( half_edges[polygon_edge].origin );
+			half_edges[polygon_edge].removed= true;
+		}
+		polygons.push_back( std::move(polygon) );
+	}
+}
+
+// Returns positive value for convex vertex of anticlockwise polygon.
+static int64_t AnticlockwiseVertexCross( const ProjectionPoint& p0, const ProjectionPoint& p1, const ProjectionPoint& p2 )
+{
+	return -PolygonVertexCross( p0, p1, p2 );
+}
+
+// Order of sweep line - from top to bottom, from left to right. Vertices with same position are ordered by index.
+static bool VertexIsAbove( const std::vector<ProjectionPoint>& vertices, const size_t v0, const size_t v1 )
+{
+	if( vertices[v0].y != vertices[v1].y )
+		return vertices[v0].y > vertices[v1].y;
+	if( vertices[v0].x != vertices[v1].x )
+		return vertices[v0].x < vertices[v1].x;
+	return v0 < v1;
+}
+
+struct SweepLineState
+{
+	const std::vector<ProjectionPoint>* vertices;
+	const std::vector<size_t>* next_vertex;
+	ProjectionPoint point; // Current event point.
+};
+
+// Edge is identified by index of its first vertex. Special index c_invalid_index means current event point.
+static double GetSweepLineEdgeX( const SweepLineState& state, const size_t edge, const int32_t y )
+{
+	if( edge == c_invalid_index )
+		return double(state.point.x);
+
+	const ProjectionPoint& v0= (*state.vertices)[edge];
+	const ProjectionPoint& v1= (*state.vertices)[ (*state.next_vertex)[edge] ];
+	if( v0.y == v1.y )
+		return double( std::max( std::min( v0.x, v1.x ), std::min( state.point.x, std::max( v0.x, v1.x ) ) ) );
+
+	return double(v0.x) + ( double(v1.x) - double(v0.x) ) * ( double(y) - double(v0.y) ) / ( double(v1.y) - double(v0.y) );
+}
+
+struct SweepLineEdgeComparator
+{
+	const SweepLineState* state;
+
+	bool operator()( const size_t l, const size_t r ) const
+	{
+		const double l_x= GetSweepLineEdgeX( *state, l, state->point.y );
+		const double r_x= GetSweepLineEdgeX( *state, r, state->point.y );
+		if( l_x != r_x )
+			return l_x < r_x;
+
+		// Edges, touching current point, are at left of it.
+		if( l == c_invalid_index )
+			return false;
+		if( r == c_invalid_index )
+			return true;
+
+		// Edges with common point - compare them below sweep line.
+		const double l_x_below= GetSweepLineEdgeX( *state, l, state->point.y - 1 );
+		const double r_x_below= GetSweepLineEdgeX( *state, r, state->point.y - 1 );
+		if( l_x_below != r_x_below )
+			return l_x_below < r_x_below;
 
-			for( size_t p1= p0 + 1u; p1 < polygons.size(); ++p1 )
+		return l < r;
+	}
+};
+
+enum class SweepVertexType
+{
+	Start,
+	Split,
+	End,
+	Merge,
+	RegularLeft, // Interior of polygon is at right.
+	RegularRight, // Interior of polygon is at left.
+};
+
+// Partition of polygon into y-monotone parts, using sweep line.
+// Polygon is anticlockwise, edge "i" is edge from vertex "i" to vertex "next_vertex[i]".
+// Returns false, if polygon is degenerated.
+static bool FindMonotonePartitionDiagonals(
+	const std::vector<ProjectionPoint>& vertices,
+	const std::vector<size_t>& next_vertex,
+	const std::vector<size_t>& prev_vertex,
+	std::vector< std::pair<size_t, size_t> >& out_diagonals )
+{
+	const size_t vertex_count= vertices.size();
+
+	std::vector<SweepVertexType> vertices_type( vertex_count );
+	for( size_t v= 0u; v < vertex_count; ++v )
+	{
+		const size_t prev= prev_vertex[v];
+		const size_t next= next_vertex[v];
+		const bool prev_is_below= VertexIsAbove( vertices, v, prev );
+		const bool next_is_below= VertexIsAbove( vertices, v, next );
+		const bool is_convex= AnticlockwiseVertexCross( vertices[prev], vertices[v], vertices[next] ) > 0;
+
+		if( prev_is_below && next_is_below )
+			vertices_type[v]= is_convex ? SweepVertexType::Start : SweepVertexType::Split;
+		else if( !prev_is_below && !next_is_below )
+			vertices_type[v]= is_convex ? SweepVertexType::End : SweepVertexType::Merge;
+		else
+			vertices_type[v]= next_is_below ? SweepVertexType::RegularLeft : SweepVertexType::RegularRight;
+	}
+
+	std::vector<size_t> sorted_vertices( vertex_count );
+	for( size_t v= 0u; v < vertex_count; ++v )
+		sorted_vertices[v]= v;
+	std::sort(
+		sorted_vertices.begin(), sorted_vertices.end(),
+		[&]( const size_t l, const size_t r ) { return VertexIsAbove( vertices, l, r ); } );
+
+	SweepLineState state;
+	state.vertices= &vertices;
+	state.next_vertex= &next_vertex;
+
+	// Sweep line status contains edges with polygon interior at right.
+	typedef std::set< size_t, SweepLineEdgeComparator > SweepLineStatus;
+	SweepLineStatus status( SweepLineEdgeComparator{ &state } );
+	std::vector<SweepLineStatus::iterator> status_iterators( vertex_count, status.end() );
+	std::vector<size_t> edges_helper( vertex_count, c_invalid_index );
+
+	const auto insert_edge=
+	[&]( const size_t edge, const size_t helper )
+	{
+		status_iterators[edge]= status.insert( edge ).first;
+		edges_helper[edge]= helper;
+	};
+	const auto connect_with_merge_helper=
+	[&]( const size_t edge, const size_t v )
+	{
+		const size_t helper= edges_helper[edge];
+		if( vertices_type[helper] == SweepVertexType::Merge )
+			out_diagonals.emplace_back( v, helper );
+	};
+	const auto finish_edge=
+	[&]( const size_t edge, const size_t v ) -> bool
+	{
+		if( status_iterators[edge] == status.end() )
+			return false;
+		connect_with_merge_helper( edge, v );
+		status.erase( status_iterators[edge] );
+		status_iterators[edge]= status.end();
+		return true;
+	};
+	const auto find_left_edge=
+	[&]() -> size_t
+	{
+		auto it= status.upper_bound( c_invalid_index );
+		if( it == status.begin() )
+			return c_invalid_index;
+		--it;
+		return *it;
+	};
+
+	// Stop on first error - sweep line status order may be broken after it.
+	for( const size_t v : sorted_vertices )
+	{
+		state.point= vertices[v];
+		const size_t prev_edge= prev_vertex[v];
+
+		switch( vertices_type[v] )
+		{
+		case SweepVertexType::Start:
+			insert_edge( v, v );
+			break;
+
+		case SweepVertexType::End:
+			if( !finish_edge( prev_edge, v ) )
+				return false;
+			break;
+
+		case SweepVertexType::Split:
+			{
+				const size_t left_edge= find_left_edge();
+				if( left_edge == c_invalid_index )
+					return false;
+				out_diagonals.emplace_back( v, edges_helper[left_edge] );
+				edges_helper[left_edge]= v;
+				insert_edge( v, v );
+			}
+			break;
+
+		case SweepVertexType::Merge:
 			{
-				const std::vector<ProjectionPoint>& poly1= polygons[p1];
+				if( !finish_edge( prev_edge, v ) )
+					return false;
+
+				const size_t left_edge= find_left_edge();
+				if( left_edge == c_invalid_index )
+					return false;
+				connect_with_merge_helper( left_edge, v );
+				edges_helper[left_edge]= v;
+			}
+			break;
 
-				if( poly0.size() * poly1.size() > mul_limit )
-					continue; // Skip two big polygons mering, because calculations for such polygons are too slow.
+		case SweepVertexType::RegularLeft:
+			if( !finish_edge( prev_edge, v ) )
+				return false;
+			insert_edge( v, v );
+			break;
 
-				const size_t p1_size_add= poly1.size() * 4u;
+		case SweepVertexType::RegularRight:
+			{
+				const size_t left_edge= find_left_edge();
+				if( left_edge == c_invalid_index )
+					return false;
+				connect_with_merge_helper( left_edge, v );
+				edges_helper[left_edge]= v;
+			}
+			break;
+		};
+	}
 
-				size_t adjusted_v0= ~0u;
-				size_t adjusted_v1= ~0u;
-				for( size_t v0= 0u; v0 < poly0.size(); ++v0 )
-				for( size_t v1= 0u; v1 < poly1.size(); ++v1 )
-				{
-					if( poly0[v0] == poly1[v1] )
-					{
-						adjusted_v0= v0;
-						adjusted_v1= v1;
-						goto have_adjusted_vertices;
-					}
-				}
-				continue;
+	return true;
+}
 
-				have_adjusted_vertices:
-				size_t adjusted_start0= adjusted_v0 + p0_size_add, adjusted_end0= adjusted_v0 + p0_size_add;
-				size_t adjusted_start1= adjusted_v1 + p1_size_add, adjusted_end1= adjusted_v1 + p1_size_add;
+// Splits anticlockwise polygon by diagonals. Result faces are anticlockwise.
+// Returns false, if polygon is degenerated.
+static bool SplitPolygonByDiagonals(
+	const std::vector<ProjectionPoint>& vertices,
+	const std::vector<size_t>& next_vertex,
+	const std::vector< std::pair<size_t, size_t> >& diagonals,
+	std::vector< std::vector<size_t> >& out_faces )
+{
+	const size_t vertex_count= vertices.size();
 
-				while( poly0[ ( adjusted_start0 + p0_size_add - 1u ) % poly0.size() ] ==
-					   poly1[ ( adjusted_end1   + p1_size_add + 1u ) % poly1.size() ] &&
-					   adjusted_end0 - adjusted_start0 < poly0.size() &&
-					   adjusted_end1 - adjusted_start1 < poly1.size() )
-				{
-					--adjusted_start0;
-					++adjusted_end1;
-				}
+	// Diagonals between vertices with same position break angle sorting.
+	for( const std::pair<size_t, size_t>& diagonal : diagonals )
+		if( vertices[ diagonal.first ] == vertices[ diagonal.second ] )
+			return false;
+
+	// First half-edges are polygon edges, next are pairs of diagonal edges.
+	const size_t half_edge_count= vertex_count + diagonals.size() * 2u;
+	std::vector<size_t> half_edges_origin( half_edge_count );
+	std::vector<size_t> half_edges_dest( half_edge_count );
+	for( size_t v= 0u; v < vertex_count; ++v )
+	{
+		half_edges_origin[v]= v;
+		half_edges_dest[v]= next_vertex[v];
+	}
+	for( size_t d= 0u; d < diagonals.size(); ++d )
+	{
+		half_edges_origin[ vertex_count + d * 2u      ]= half_edges_dest  [ vertex_count + d * 2u + 1u ]= diagonals[d].first ;
+		half_edges_origin[ vertex_count + d * 2u + 1u ]= half_edges_dest  [ vertex_count + d * 2u      ]= diagonals[d].second;
+	}
 
-				while( poly0[ ( adjusted_end0   + p0_size_add + 1u ) % poly0.size() ] ==
-					   poly1[ ( adjusted_start1 + p1_size_add - 1u ) % poly1.size() ] &&
-					   adjusted_end0 - adjusted_start0 < poly0.size() &&
-					   adjusted_end1 - adjusted_start1 < poly1.size() )
+	// Outgoing half-edges of each vertex, sorted anticlockwise, starting from polygon edge.
+	std::vector<size_t> outgoing_offset( vertex_count + 1u, 0u );
+	for( size_t e= 0u; e < half_edge_count; ++e )
+		++outgoing_offset[ half_edges_origin[e] + 1u ];
+	for( size_t v= 0u; v < vertex_count; ++v )
+		outgoing_offset[v + 1u]+= outgoing_offset[v];
+
+	std::vector<size_t> outgoing_edges( half_edge_count );
+	{
+		std::vector<size_t> outgoing_fill( outgoing_offset.begin(), outgoing_offset.end() - 1 );
+		for( size_t e= 0u; e < half_edge_count; ++e )
+			outgoing_edges[ outgoing_fill[ half_edges_origin[e] ]++ ]= e;
+	}
+
+	std::vector<size_t> half_edges_position( half_edge_count );
+	for( size_t v= 0u; v < vertex_count; ++v )
+	{
+		const size_t begin= outgoing_offset[v], end= outgoing_offset[v + 1u];
+		if( end - begin > 2u )
+		{
+			const ProjectionPoint& origin= vertices[v];
+			const int64_t base_dx= int64_t(vertices[ next_vertex[v] ].x) - int64_t(origin.x);
+			const int64_t base_dy= int64_t(vertices[ next_vertex[v] ].y) - int64_t(origin.y);
+			const auto angle_class=
+			[&]( const int64_t dx, const int64_t dy ) -> int
+			{
+				const int64_t cross= base_dx * dy - base_dy * dx;
+				if( cross > 0 )
+					return 1;
+				if( cross < 0 )
+					return 3;
+				return base_dx * dx + base_dy * dy > 0 ? 0 : 2;
+			};
+
+			std::sort(
+				outgoing_edges.begin() + std::ptrdiff_t(begin + 1u), outgoing_edges.begin() + std::ptrdiff_t(end),
+				[&]( const size_t l, const size_t r )
 				{
-					++adjusted_end0;
-					--adjusted_start1;
-				}
+					const int64_t l_dx= int64_t(vertices[ half_edges_dest[l] ].x) - int64_t(origin.x);
+					const int64_t l_dy= int64_t(vertices[ half_edges_dest[l] ].y) - int64_t(origin.y);
+					const int64_t r_dx= int64_t(vertices[ half_edges_dest[r] ].x) - int64_t(origin.x);
+					const int64_t r_dy= int64_t(vertices[ half_edges_dest[r] ].y) - int64_t(origin.y);
+					const int l_class= angle_class( l_dx, l_dy );
+					const int r_class= angle_class( r_dx, r_dy );
+					if( l_class != r_class )
+						return l_class < r_class;
+					return l_dx * r_dy - l_dy * r_dx > 0;
+				} );
+		}
+		for( size_t i= begin; i < end; ++i )
+			half_edges_position[ outgoing_edges[i] ]= i;
+	}
 
-				if( adjusted_start0 == adjusted_end0 )
-					continue;// Have only one adjusted vertex.
-				if( ( adjusted_end0 - adjusted_start0 ) % poly0.size() == 0u )
-					continue;
-				if( ( adjusted_end1 - adjusted_start1 ) % poly1.size() == 0u )
-					continue;
+	// Select next edge of face at left side of given edge - first clockwise edge after reversed given edge.
+	const auto get_next_half_edge=
+	[&]( const size_t e ) -> size_t
+	{
+		const size_t v= half_edges_dest[e];
+		if( e < vertex_count )
+			return outgoing_edges[ outgoing_offset[v + 1u] - 1u ];
+
+		const size_t twin= vertex_count + ( ( e - vertex_count ) ^ 1u );
+		const size_t position= half_edges_position[twin];
+		if( position == outgoing_offset[v] )
+			return c_invalid_index;
+		return outgoing_edges[ position - 1u ];
+	};
 
-				const int64_t cross0=
-					PolygonVertexCross(
-						poly0[ ( adjusted_start0 + p0_size_add - 1u ) % poly0.size() ],
-						poly0[ ( adjusted_start0 + p0_size_add + 0u ) % poly0.size() ],
-						poly1[ ( adjusted_end1   + p1_size_add + 1u ) % poly1.size() ] );
-				const int64_t cross1=
-					PolygonVertexCross(
-						poly1[ ( adjusted_start1 + p1_size_add - 1u ) % poly1.size() ],
-						poly1[ ( adjusted_start1 + p1_size_add + 0u ) % poly1.size() ],
-						poly0[ ( adjusted_end0   + p0_size_add + 1u ) % poly0.size() ] );
-				if( !( cross0 >= 0 && cross1 >= 0 ) )
-					continue; // Result polygon will be non-convex.
-
-				std::vector<ProjectionPoint> poly_combined;
-
-				const size_t poly0_vertex_count= poly0.size() - ( adjusted_end0 - adjusted_start0 );
-				const size_t poly1_vertex_count= poly1.size() - ( adjusted_end1 - adjusted_start1 );
-				for( size_t i= 0u; i < poly0_vertex_count; ++i )
-					poly_combined.push_back( poly0[ ( adjusted_end0 + p0_size_add + i ) % poly0.size() ] );
-				for( size_t i= 0u; i < poly1_vertex_count; ++i )
-					poly_combined.push_back( poly1[ ( adjusted_end1 + p1_size_add + i ) % poly1.size() ] );
-				PM_ASSERT( poly_combined.size() >= 3u );
-
-				polygons[p0]= std::move( poly_combined );
-				if( p1 + 1u < polygons.size() )
-					polygons[p1]= std::move( polygons.back() );
-				polygons.pop_back();
-				--p1;
-
-				polygons_combined= true;
+	std::vector<bool> half_edges_visited( half_edge_count, false );
+	for( size_t start_edge= 0u; start_edge < half_edge_count; ++start_edge )
+	{
+		if( half_edges_visited[start_edge] )
+			continue;
+
+		std::vector<size_t> face;
+		size_t e= start_edge;
+		do
+		{
+			if( e == c_invalid_index || half_edges_visited[e] )
+				return false;
+			half_edges_visited[e]= true;
+			face.push_back( half_edges_origin[e] );
+			e= get_next_half_edge(e);
+		} while( e != start_edge );
+
+		out_faces.push_back( std::move(face) );
+	}
+
+	return true;
+}
+
+// Triangulates anticlockwise y-monotone polygon. Result triangles are anticlockwise.
+// Returns false, if polygon is not monotone or degenerated.
+static bool TriangulateMonotonePolygon(
+	const std::vector<ProjectionPoint>& vertices,
+	const std::vector<size_t>& face,
+	std::vector<size_t>& out_triangles )
+{
+	if( face.size() < 3u )
+		return false;
+
+	size_t top= 0u, bottom= 0u;
+	for( size_t i= 1u; i < face.size(); ++i )
+	{
+		if( VertexIsAbove( vertices, face[i], face[top] ) )
+			top= i;
+		if( VertexIsAbove( vertices, face[bottom], face[i] ) )
+			bottom= i;
+	}
+
+	// first - vertex, second - is vertex of left chain.
+	std::vector< std::pair<size_t, bool> > sorted_vertices;
+	sorted_vertices.reserve( face.size() );
+	for( size_t i= top; i != bottom; i= ( i + 1u ) % face.size() )
+		sorted_vertices.emplace_back( face[i], true );
+	for( size_t i= bottom; i != top; i= ( i + 1u ) % face.size() )
+		sorted_vertices.emplace_back( face[i], false );
+	std::sort(
+		sorted_vertices.begin(), sorted_vertices.end(),
+		[&]( const std::pair<size_t, bool>& l, const std::pair<size_t, bool>& r ) { return VertexIsAbove( vertices, l.first, r.first ); } );
+
+	const auto add_triangle=
+	[&]( const size_t v0, const size_t v1, const size_t v2 ) -> bool
+	{
+		const int64_t cross= AnticlockwiseVertexCross( vertices[v0], vertices[v1], vertices[v2] );
+		if( cross < 0 )
+			return false;
+		if( cross > 0 ) // Skip degenerated triangles.
+		{
+			out_triangles.push_back(v0);
+			out_triangles.push_back(v1);
+			out_triangles.push_back(v2);
+		}
+		return true;
+	};
+
+	std::vector< std::pair<size_t, bool> > stack;
+	stack.push_back( sorted_vertices[0u] );
+	stack.push_back( sorted_vertices[1u] );
+	for( size_t i= 2u; i + 1u < sorted_vertices.size(); ++i )
+	{
+		const std::pair<size_t, bool>& current= sorted_vertices[i];
+		if( current.second != stack.back().second )
+		{
+			// Vertex of opposite chain - connect it with all stack vertices.
+			while( stack.size() > 1u )
+			{
+				const size_t v0= stack.back().first;
+				stack.pop_back();
+				const size_t v1= stack.back().first;
+				if( !( current.second ? add_triangle( current.first, v0, v1 ) : add_triangle( current.first, v1, v0 ) ) )
+					return false;
+			}
+			stack.clear();
+			stack.push_back( sorted_vertices[ i - 1u ] );
+			stack.push_back( current );
+		}
+		else
+		{
+			// Vertex of same chain - cut triangles, while stack vertices are convex.
+			std::pair<size_t, bool> last= stack.back();
+			stack.pop_back();
+			while( !stack.empty() )
+			{
+				const size_t v= stack.back().first;
+				const int64_t cross= AnticlockwiseVertexCross( vertices[v], vertices[last.first], vertices[current.first] );
+				if( current.second ? cross <= 0 : cross >= 0 )
+					break;
+				if( !( current.second ? add_triangle( v, last.first, current.first ) : add_triangle( current.first, last.first, v ) ) )
+					return false;
+				last= stack.back();
+				stack.pop_back();
 			}
+			stack.push_back( last );
+			stack.push_back( current );
 		}
+	}
 
-		if( !polygons_combined )
-			break;
+	const size_t bottom_vertex= sorted_vertices.back().first;
+	while( stack.size() > 1u )
+	{
+		const std::pair<size_t, bool> v0= stack.back();
+		stack.pop_back();
+		const size_t v1= stack.back().first;
+		if( !( v0.second ? add_triangle( bottom_vertex, v1, v0.first ) : add_triangle( bottom_vertex, v0.first, v1 ) ) )
+			return false;
 	}
+
+	return true;
 }
 
-// Input polygons must not be self-intersecting.
-// Result parts are clockwise.
-static std::vector< std::vector<ProjectionPoint> > SplitPolygonIntoConvexParts( std::vector<ProjectionPoint> vertices, bool enable_triangles_merge= true )
+// Triangulation via partition into monotone parts - O(n * log(n)).
+// Polygon may consist of several rings - clockwise outer rings and anticlockwise holes.
+// Result triangles are clockwise.
+// Returns false, if polygon is degenerated and triangulation failed.
+// Input rings must not cross each other - sweep line status order is valid only for such rings.
+static bool TriangulatePolygon(
+	const std::vector< std::vector<ProjectionPoint> >& rings,
+	std::vector< std::vector<ProjectionPoint> >& out_triangles )
 {
-	PM_ASSERT( vertices.size() >= 3u );
-	std::vector< std::vector<ProjectionPoint> > result;
+	std::vector<ProjectionPoint> vertices;
+	std::vector<size_t> next_vertex, prev_vertex;
+	int64_t polygon_double_area= 0;
+	for( const std::vector<ProjectionPoint>& ring : rings )
+	{
+		if( ring.size() < 3u )
+			continue;
 
-	const int64_t polygon_double_signed_area= CalculatePolygonDoubleSignedArea( vertices.data(), vertices.size() );
-	if( polygon_double_signed_area == 0 )
-		return { result };
+		// Reverse rings - for monotone partition interior of polygon must be at left side of edges.
+		const size_t first_vertex= vertices.size();
+		for( size_t i= 0u; i < ring.size(); ++i )
+		{
+			vertices.push_back( ring[i] );
+			next_vertex.push_back( first_vertex + ( i + ring.size() - 1u ) % ring.size() );
+			prev_vertex.push_back( first_vertex + ( i + 1u ) % ring.size() );
+		}
+		polygon_double_area+= CalculatePolygonDoubleSignedArea( ring.data(), ring.size() );
+	}
+	if( vertices.empty() )
+		return true;
 
-	if( polygon_double_signed_area < 0 )
-		std::reverse( vertices.begin(), vertices.end() ); // Make polygon clockwise.
+	std::vector< std::pair<size_t, size_t> > diagonals;
+	if( !FindMonotonePartitionDiagonals( vertices, next_vertex, prev_vertex, diagonals ) )
+		return false;
+
+	std::vector< std::vector<size_t> > faces;
+	if( !SplitPolygonByDiagonals( vertices, next_vertex, diagonals, faces ) )
+		return false;
+
+	std::vector<size_t> triangles;
+	for( const std::vector<size_t>& face : faces )
+		if( !TriangulateMonotonePolygon( vertices, face, triangles ) )
+			return false;
+
+	// Sum of triangles area must be equal to polygon area. Otherwise something went wrong.
+	int64_t triangles_double_area= 0;
+	for( size_t t= 0u; t < triangles.size(); t+= 3u )
+		triangles_double_area+= AnticlockwiseVertexCross( vertices[ triangles[t] ], vertices[ triangles[t + 1u] ], vertices[ triangles[t + 2u] ] );
+	if( triangles_double_area != polygon_double_area )
+		return false;
+
+	for( size_t t= 0u; t < triangles.size(); t+= 3u )
+		out_triangles.push_back( { vertices[ triangles[t + 2u] ], vertices[ triangles[t + 1u] ], vertices[ triangles[t] ] } );
+
+	return true;
+}
+
+// Slow, but tolerant to degenerated polygons ear clipping.
+// Input polygon must be clockwise. Result parts are clockwise.
+static std::vector< std::vector<ProjectionPoint> > SplitPolygonIntoConvexPartsByEarClipping( std::vector<ProjectionPoint> vertices, NormalizationBudget& budget )
+{
+	std::vector< std::vector<ProjectionPoint> > result;
 
 	const auto is_split_vertex=
 	[&]( const size_t vertex_index ) -> bool
@@ -284,8 +937,6 @@ static std::vector< std::vector<ProjectionPoint> > SplitPolygonIntoConvexParts(
 		return cross < 0;
 	};
 
-	// TODO - optimize splitting, make faster, and produce less polygons.
-
 	std::vector<ProjectionPoint> triangle;
 	while( vertices.size() > 3u )
 	{
@@ -304,6 +955,8 @@ static std::vector< std::vector<ProjectionPoint> > SplitPolygonIntoConvexParts(
 				continue;
 			if( !( is_split_vertex( i + vertices.size() - 1u ) || is_split_vertex( i + 1u ) ) )
 				continue;
+			if( !budget.Spend( vertices.size() ) )
+				return result;
 			// Try create triangle with convex vertex.
 
 			triangle.clear();
@@ -332,7 +985,7 @@ static std::vector< std::vector<ProjectionPoint> > SplitPolygonIntoConvexParts(
 			}
 
 			result.push_back( triangle );
-			vertices.erase( vertices.begin() + i );
+			vertices.erase( vertices.begin() + std::ptrdiff_t(i) );
 			goto continue_triangulation;
 
 			select_next_vertex_fo_triangulation:;
@@ -347,34 +1000,72 @@ static std::vector< std::vector<ProjectionPoint> > SplitPolygonIntoConvexParts(
 	finish_triangulation:
 	result.push_back( vertices );
 
+	return result;
+}
+
+// Input polygons must not be self-intersecting.
+// Result parts are clockwise.
+static std::vector< std::vector<ProjectionPoint> > SplitPolygonIntoConvexParts( std::vector<ProjectionPoint> vertices, NormalizationBudget& budget )
+{
+	PM_ASSERT( vertices.size() >= 3u );
+	std::vector< std::vector<ProjectionPoint> > result;
+
+	const int64_t polygon_double_signed_area= CalculatePolygonDoubleSignedArea( vertices.data(), vertices.size() );
+	if( polygon_double_signed_area == 0 )
+		return result;
+
+	if( polygon_double_signed_area < 0 )
+		std::reverse( vertices.begin(), vertices.end() ); // Make polygon clockwise.
+
+	bool is_convex= true;
+	for( size_t i= 0u; i < vertices.size() && is_convex; ++i )
+		is_convex=
+			PolygonVertexCross(
+				vertices[ ( i + vertices.size() - 1u ) % vertices.size() ],
+				vertices[i],
+				vertices[ ( i + 1u ) % vertices.size() ] ) >= 0;
+	if( is_convex )
+	{
+		result.push_back( std::move(vertices) );
+		return result;
+	}
+
+	if( !TriangulatePolygon( { vertices }, result ) )
+	{
+		// Monotone partition does not work for polygons with touching edges. Use ear clipping for them.
+		result= SplitPolygonIntoConvexPartsByEarClipping( std::move(vertices), budget );
+	}
+
 	// After triangulation, merge ajusted polygons.
-	if(enable_triangles_merge)
-		CombineAdjustedConvexPolygons( result );
+	CombineAdjustedConvexPolygons( result );
 
 	return result;
 }
 
+// Returns true, if horizontal ray from vertex to right crosses edge.
+static bool RayCrossesEdge( const ProjectionPoint& edge_v0, const ProjectionPoint& edge_v1, const ProjectionPoint& vertex )
+{
+	if( (edge_v0.y > vertex.y && edge_v1.y > vertex.y ) || // skip edges abowe test line
+		(edge_v0.y < vertex.y && edge_v1.y < vertex.y ) || // Skip edges below test line
+		edge_v0.y == edge_v1.y || // skip edges on test line
+		std::max( edge_v0.y, edge_v1.y ) == vertex.y ) // Skip edges, where test line touches upper vertex. We count only edges, where test line touches lower vertex.
+		return false;
+
+	const int64_t abs_dy0= std::abs( edge_v0.y - vertex.y );
+	const int64_t abs_dy1= std::abs( edge_v1.y - vertex.y );
+	const int64_t abs_dy_sum= abs_dy0 + abs_dy1;
+	PM_ASSERT( abs_dy_sum > 0 );
+	const int64_t intersection_x_mul_abs_dy_sum= int64_t(edge_v0.x) * abs_dy1 + int64_t(edge_v1.x) * abs_dy0;
+	return intersection_x_mul_abs_dy_sum >= abs_dy_sum * int64_t(vertex.x);
+}
+
 static bool VertexIsInsidePolygon( const std::vector<ProjectionPoint>& polygon, const ProjectionPoint& vertex )
 {
 	size_t intersections= 0u;
 
 	for( size_t i= 0u; i < polygon.size(); ++i )
 	{
-		const ProjectionPoint& edge_v0= polygon[i];
-		const ProjectionPoint& edge_v1= polygon[ (i+1u) % polygon.size() ];
-
-		if( (edge_v0.y > vertex.y && edge_v1.y > vertex.y ) || // skip edges abowe test line
-			(edge_v0.y < vertex.y && edge_v1.y < vertex.y ) || // Skip edges below test line
-			edge_v0.y == edge_v1.y || // skip edges on test line
-			std::max( edge_v0.y, edge_v1.y ) == vertex.y ) // Skip edges, where test line touches upper vertex. We count only edges, where test line touches lower vertex.
-			continue;
-
-		const int64_t abs_dy0= std::abs( edge_v0.y - vertex.y );
-		const int64_t abs_dy1= std::abs( edge_v1.y - vertex.y );
-		const int64_t abs_dy_sum= abs_dy0 + abs_dy1;
-		PM_ASSERT( abs_dy_sum > 0 );
-		const int64_t intersection_x_mul_abs_dy_sum= int64_t(edge_v0.x) * abs_dy1 + int64_t(edge_v1.x) * abs_dy0;
-		if( intersection_x_mul_abs_dy_sum >= abs_dy_sum * int64_t(vertex.x) )
+		if( RayCrossesEdge( polygon[i], polygon[ (i+1u) % polygon.size() ], vertex ) )
 			++intersections;
 	}
 
@@ -393,13 +1084,19 @@ static bool PolygonIsInsidePolygon( const std::vector<ProjectionPoint>& a, const
 	return 2u * vertices_inside >= a.size();
 }
 
+// Returns empty result, if budget is exceeded.
 static std::vector< std::vector<ProjectionPoint> > CutHoles(
 	std::vector<ProjectionPoint> outer_ring,
-	const std::vector< std::vector<ProjectionPoint> >& inner_rings )
+	const std::vector< std::vector<ProjectionPoint> >& inner_rings,
+	NormalizationBudget& budget )
 {
 	if( CalculatePolygonDoubleSignedArea( outer_ring.data(), outer_ring.size() ) < 0 )
 		std::reverse( outer_ring.begin(), outer_ring.end() );
 
+	size_t edges_to_check= outer_ring.size();
+	for( const std::vector<ProjectionPoint>& inner_ring : inner_rings )
+		edges_to_check+= inner_ring.size();
+
 	for( const std::vector<ProjectionPoint>& inner_ring_src : inner_rings )
 	{
 		std::vector<ProjectionPoint> inner_ring= inner_ring_src;
@@ -412,6 +1109,9 @@ static std::vector< std::vector<ProjectionPoint> > CutHoles(
 		for( size_t inner_i= 0u; inner_i < inner_ring.size(); ++inner_i )
 		for( size_t outer_i= 0u; outer_i < outer_ring.size(); ++outer_i )
 		{
+			if( !budget.Spend( edges_to_check ) )
+				return {};
+
 			const ProjectionPoint& v0= inner_ring[inner_i];
 			const ProjectionPoint& v1= outer_ring[outer_i];
 
@@ -505,13 +1205,15 @@ static std::vector< std::vector<ProjectionPoint> > CutHoles(
 
 			std::vector< std::vector<ProjectionPoint> > result;
 			for( const std::vector<ProjectionPoint>& poly : polys )
-			for( const std::vector<ProjectionPoint>& poly_normalized : SplitPolygonIntNoncrossingParts( poly ) )
+			for( const std::vector<ProjectionPoint>& poly_normalized : SplitPolygonIntNoncrossingParts( poly, budget ) )
 			{
 				std::vector< std::vector<ProjectionPoint> > poly_inner_rings;
 				for( const std::vector<ProjectionPoint>& inner_ring_fo_classify : inner_rings )
 				{
 					if( &inner_ring_fo_classify == &inner_ring_src )
 						continue;
+					if( !budget.Spend( inner_ring_fo_classify.size() * poly_normalized.size() ) )
+						return {};
 					if( PolygonIsInsidePolygon( inner_ring_fo_classify, poly_normalized ) )
 						poly_inner_rings.push_back( inner_ring_fo_classify );
 				}
@@ -519,7 +1221,7 @@ static std::vector< std::vector<ProjectionPoint> > CutHoles(
 					result.push_back( poly_normalized );
 				else
 				{
-					std::vector< std::vector<ProjectionPoint> > poly_result= CutHoles( poly_normalized, poly_inner_rings );
+					std::vector< std::vector<ProjectionPoint> > poly_result= CutHoles( poly_normalized, poly_inner_rings, budget );
 					for( std::vector<ProjectionPoint>& poly_result_part : poly_result )
 						result.push_back( std::move( poly_result_part ) );
 				}
@@ -531,144 +1233,614 @@ static std::vector< std::vector<ProjectionPoint> > CutHoles(
 	return { outer_ring };
 }
 
-static std::vector< std::vector<ProjectionPoint> > CutHoles(
-	const std::vector< std::vector<ProjectionPoint> >& outer_rings,
-	const std::vector< std::vector<ProjectionPoint> >& inner_rings )
+struct RingBoundingBox
+{
+	ProjectionPoint min;
+	ProjectionPoint max;
+};
+
+static RingBoundingBox GetRingBoundingBox( const std::vector<ProjectionPoint>& ring )
+{
+	RingBoundingBox bbox{ ring.front(), ring.front() };
+	for( const ProjectionPoint& vertex : ring )
+	{
+		bbox.min.x= std::min( bbox.min.x, vertex.x );
+		bbox.min.y= std::min( bbox.min.y, vertex.y );
+		bbox.max.x= std::max( bbox.max.x, vertex.x );
+		bbox.max.y= std::max( bbox.max.y, vertex.y );
+	}
+	return bbox;
+}
+
+static bool BoundingBoxIsInsideBoundingBox( const RingBoundingBox& a, const RingBoundingBox& b )
+{
+	return a.min.x >= b.min.x && a.min.y >= b.min.y && a.max.x <= b.max.x && a.max.y <= b.max.y;
+}
+
+// Edges of ring, splitted into horizontal bands, for fast "vertex inside ring" checks.
+struct RingEdgesIndex
+{
+	int32_t min_y;
+	int64_t band_height;
+	std::vector< std::vector<size_t> > bands; // Indices of edges, crossing band.
+};
+
+static RingEdgesIndex BuildRingEdgesIndex( const std::vector<ProjectionPoint>& ring, const RingBoundingBox& bbox )
+{
+	const size_t c_edges_per_band= 8u;
+
+	RingEdgesIndex index;
+	index.bands.resize( std::max( size_t(1u), ring.size() / c_edges_per_band ) );
+	index.min_y= bbox.min.y;
+	index.band_height= ( int64_t(bbox.max.y) - int64_t(bbox.min.y) ) / int64_t( index.bands.size() ) + 1;
+
+	for( size_t i= 0u; i < ring.size(); ++i )
+	{
+		const ProjectionPoint& v0= ring[i];
+		const ProjectionPoint& v1= ring[ (i+1u) % ring.size() ];
+		const size_t first_band= size_t( ( int64_t( std::min( v0.y, v1.y ) ) - int64_t(index.min_y) ) / index.band_height );
+		const size_t last_band = size_t( ( int64_t( std::max( v0.y, v1.y ) ) - int64_t(index.min_y) ) / index.band_height );
+		for( size_t band= first_band; band <= last_band; ++band )
+			index.bands[band].push_back(i);
+	}
+
+	return index;
+}
+
+static bool VertexIsInsideRing( const std::vector<ProjectionPoint>& ring, const RingEdgesIndex& index, const ProjectionPoint& vertex )
+{
+	if( vertex.y < index.min_y )
+		return false;
+	const size_t band= size_t( ( int64_t(vertex.y) - int64_t(index.min_y) ) / index.band_height );
+	if( band >= index.bands.size() )
+		return false;
+
+	size_t intersections= 0u;
+	for( const size_t edge : index.bands[band] )
+	{
+		if( RayCrossesEdge( ring[edge], ring[ (edge+1u) % ring.size() ], vertex ) )
+			++intersections;
+	}
+
+	return ( intersections & 1u ) == 1u;
+}
+
+// Monotone partition does not work for rings with common vertices.
+// Move such vertices of holes inside holes by one unit.
+// Input rings - clockwise outer ring and anticlockwise holes.
+static void SeparateTouchingRings( std::vector< std::vector<ProjectionPoint> >& rings )
+{
+	std::unordered_map< ProjectionPoint, size_t, ProjectionPointHasher > vertices_count;
+	for( const std::vector<ProjectionPoint>& ring : rings )
+		for( const ProjectionPoint& vertex : ring )
+			++vertices_count[vertex];
+
+	static const int32_t c_offsets[8u][2u]{ { 1, 0 }, { 0, 1 }, { -1, 0 }, { 0, -1 }, { 1, 1 }, { -1, 1 }, { -1, -1 }, { 1, -1 } };
+
+	for( size_t r= 1u; r < rings.size(); ++r )
+	{
+		std::vector<ProjectionPoint>& hole= rings[r];
+		for( size_t i= 0u; i < hole.size(); ++i )
+		{
+			const auto it= vertices_count.find( hole[i] );
+			if( it->second <= 1u )
+				continue;
+
+			const ProjectionPoint& prev= hole[ ( i + hole.size() - 1u ) % hole.size() ];
+			const ProjectionPoint& next= hole[ ( i + 1u ) % hole.size() ];
+			const bool is_convex= PolygonVertexCross( prev, hole[i], next ) < 0;
+			for( const auto& offset : c_offsets )
+			{
+				const ProjectionPoint candidate{ hole[i].x + offset[0], hole[i].y + offset[1] };
+				const bool left_of_prev_edge= PolygonVertexCross( prev, hole[i], candidate ) < 0;
+				const bool left_of_next_edge= PolygonVertexCross( hole[i], next, candidate ) < 0;
+				if( !( is_convex ? ( left_of_prev_edge && left_of_next_edge ) : ( left_of_prev_edge || left_of_next_edge ) ) ||
+					vertices_count.count( candidate ) != 0u )
+					continue;
+
+				--it->second;
+				++vertices_count[candidate];
+				hole[i]= candidate;
+				break;
+			}
+		}
+	}
+}
+
+// Input rings must not be self-intersecting.
+// Holes are connected with outer ring by diagonals of monotone partition, so, there is no need for cutting of holes.
+// Result parts are clockwise.
+static std::vector< std::vector<ProjectionPoint> > SplitPolygonWithHolesIntoConvexParts(
+	const std::vector<ProjectionPoint>& outer_ring,
+	const std::vector< std::vector<ProjectionPoint> >& inner_rings,
+	NormalizationBudget& budget )
 {
+	PM_ASSERT( outer_ring.size() >= 3u );
 	std::vector< std::vector<ProjectionPoint> > result;
 
-	for( const std::vector<ProjectionPoint>& outer_ring : outer_rings )
+	std::vector< std::vector<ProjectionPoint> > rings;
+	rings.reserve( inner_rings.size() + 1u );
+
+	rings.push_back( outer_ring );
+	const int64_t outer_ring_double_signed_area= CalculatePolygonDoubleSignedArea( outer_ring.data(), outer_ring.size() );
+	if( outer_ring_double_signed_area == 0 )
+		return result;
+	if( outer_ring_double_signed_area < 0 )
+		std::reverse( rings.front().begin(), rings.front().end() ); // Make outer ring clockwise.
+
+	for( const std::vector<ProjectionPoint>& inner_ring : inner_rings )
 	{
-		std::vector< std::vector<ProjectionPoint> > ring_inner_rings;
-		for( const std::vector<ProjectionPoint>& inner_ring : inner_rings )
-			if( PolygonIsInsidePolygon( inner_ring, outer_ring ) )
-				ring_inner_rings.push_back( inner_ring );
+		if( inner_ring.size() < 3u )
+			continue;
+		const int64_t inner_ring_double_signed_area= CalculatePolygonDoubleSignedArea( inner_ring.data(), inner_ring.size() );
+		if( inner_ring_double_signed_area == 0 )
+			continue;
+		rings.push_back( inner_ring );
+		if( inner_ring_double_signed_area > 0 )
+			std::reverse( rings.back().begin(), rings.back().end() ); // Make hole anticlockwise.
+	}
+	if( rings.size() == 1u )
+		return SplitPolygonIntoConvexParts( std::move( rings.front() ), budget );
 
-		std::vector< std::vector<ProjectionPoint> > ring_splitted= CutHoles( outer_ring, ring_inner_rings );
-		for( std::vector<ProjectionPoint>& part : ring_splitted )
-			result.push_back( std::move(part) );
+	SeparateTouchingRings( rings );
 
+	if( !TriangulatePolygon( rings, result ) )
+	{
+		// Holes, crossing outer ring or other holes, break monotone partition. Cut holes slowly in such case.
+		result.clear();
+		for( const std::vector<ProjectionPoint>& hole_split_part : CutHoles( outer_ring, inner_rings, budget ) )
+		for( const std::vector<ProjectionPoint>& noncrossing_part : SplitPolygonIntNoncrossingParts( hole_split_part, budget ) )
+		for( std::vector<ProjectionPoint>& convex_part : SplitPolygonIntoConvexParts( noncrossing_part, budget ) )
+			result.push_back( std::move(convex_part) );
 	}
+
+	CombineAdjustedConvexPolygons( result );
+
 	return result;
 }
 
-void NormalizePolygons( ObjectsData& data )
+// Returns inner rings for each outer ring. Inner ring may be inside several outer rings, if outer rings are overlapped.
+static std::vector< std::vector<size_t> > AssignHolesToOuterRings(
+	const std::vector< std::vector<ProjectionPoint> >& outer_rings,
+	const std::vector< std::vector<ProjectionPoint> >& inner_rings,
+	NormalizationBudget& budget )
 {
-	std::vector<ObjectsData::ArealObject> result_areal_objects;
-	std::vector<ObjectsData::VertexTransformed> result_areal_objects_vertices;
+	std::vector< std::vector<size_t> > result( outer_rings.size() );
+
+	std::vector<RingBoundingBox> outer_rings_bbox;
+	outer_rings_bbox.reserve( outer_rings.size() );
+	for( const std::vector<ProjectionPoint>& outer_ring : outer_rings )
+		outer_rings_bbox.push_back( GetRingBoundingBox( outer_ring ) );
 
-	for( const BaseDataRepresentation::ArealObject& in_object : data.areal_objects )
+	// Build index only for outer rings with holes.
+	std::vector<RingEdgesIndex> outer_rings_index( outer_rings.size() );
+	std::vector<bool> outer_rings_index_built( outer_rings.size(), false );
+
+	for( size_t inner_ring_index= 0u; inner_ring_index < inner_rings.size(); ++inner_ring_index )
 	{
-		if( in_object.multipolygon != nullptr )
+		const std::vector<ProjectionPoint>& inner_ring= inner_rings[inner_ring_index];
+		const RingBoundingBox inner_ring_bbox= GetRingBoundingBox( inner_ring );
+
+		if( !budget.Spend( outer_rings.size() ) )
+			return result;
+
+		for( size_t outer_ring_index= 0u; outer_ring_index < outer_rings.size(); ++outer_ring_index )
 		{
-			// TODO - triangulate outer rings, triangulate inner rings, cut outer triangles by inner triangles, combine result triangles.
+			if( !BoundingBoxIsInsideBoundingBox( inner_ring_bbox, outer_rings_bbox[outer_ring_index] ) )
+				continue;
+			if( !budget.Spend( inner_ring.size() ) )
+				return result;
 
-			if( ! in_object.multipolygon->inner_rings.empty() )
+			if( !outer_rings_index_built[outer_ring_index] )
 			{
-				std::vector< std::vector<ProjectionPoint> > outer_rings_splitted, inner_rings_splitted;
-				std::vector<ProjectionPoint> ring_vertices;
+				outer_rings_index[outer_ring_index]= BuildRingEdgesIndex( outer_rings[outer_ring_index], outer_rings_bbox[outer_ring_index] );
+				outer_rings_index_built[outer_ring_index]= true;
+			}
 
-				for( const BaseDataRepresentation::Multipolygon::Part& outer_ring : in_object.multipolygon->outer_rings )
-				{
-					ring_vertices.clear();
-					ring_vertices.reserve( outer_ring.vertex_count );
-					for( size_t v= outer_ring.first_vertex_index; v < outer_ring.first_vertex_index + outer_ring.vertex_count; ++v )
-						ring_vertices.push_back( data.areal_objects_vertices[v] );
-					auto ring_splitted= SplitPolygonIntNoncrossingParts( ring_vertices );
-					for( std::vector<ProjectionPoint>& ring_part : ring_splitted )
-						outer_rings_splitted.push_back( std::move(ring_part) );
-				}
-				for( const BaseDataRepresentation::Multipolygon::Part& inner_ring : in_object.multipolygon->inner_rings )
-				{
-					ring_vertices.clear();
-					ring_vertices.reserve( inner_ring.vertex_count );
-					for( size_t v= inner_ring.first_vertex_index; v < inner_ring.first_vertex_index + inner_ring.vertex_count; ++v )
-						ring_vertices.push_back( data.areal_objects_vertices[v] );
-					auto ring_splitted= SplitPolygonIntNoncrossingParts( ring_vertices );
-					for( std::vector<ProjectionPoint>& ring_part : ring_splitted )
-						inner_rings_splitted.push_back( std::move(ring_part) );
-				}
+			size_t vertices_inside= 0u;
+			for( const ProjectionPoint& vertex : inner_ring )
+				if( VertexIsInsideRing( outer_rings[outer_ring_index], outer_rings_index[outer_ring_index], vertex ) )
+					++vertices_inside;
 
-				std::vector< std::vector<ProjectionPoint> > all_convex_parts;
-				for( const std::vector<ProjectionPoint>& hole_split_part : CutHoles( outer_rings_splitted, inner_rings_splitted ) )
-				for( const std::vector<ProjectionPoint>& noncrossing_part : SplitPolygonIntNoncrossingParts( hole_split_part ) )
-				for( std::vector<ProjectionPoint>& convex_part : SplitPolygonIntoConvexParts( noncrossing_part, noncrossing_part.size() < 512u ) )
-					all_convex_parts.push_back(std::move(convex_part));
+			// Half of vertices are inside.
+			if( 2u * vertices_inside >= inner_ring.size() )
+				result[outer_ring_index].push_back( inner_ring_index );
+		}
+	}
 
-				if( all_convex_parts.size() < 128u )
-					CombineAdjustedConvexPolygons( all_convex_parts );
+	return result;
+}
 
-				for( const std::vector<ProjectionPoint>& convex_part : all_convex_parts )
-				{
-					PM_ASSERT( convex_part.size() >= 3u );
-
-					BaseDataRepresentation::ArealObject out_object;
-					out_object.class_= in_object.class_;
-					out_object.first_vertex_index= result_areal_objects_vertices.size();
-					out_object.vertex_count= convex_part.size();
-					for( const ProjectionPoint& vertex : convex_part )
-						result_areal_objects_vertices.push_back(vertex);
-					result_areal_objects.push_back( std::move(out_object) );
-				}
+// Accurate normalization. Result is incomplete, if budget is exceeded.
+static std::vector< std::vector<ProjectionPoint> > SplitArealObjectIntoConvexParts(
+	const BaseDataRepresentation::ArealObject& in_object,
+	const ObjectsData& data,
+	NormalizationBudget& budget )
+{
+	const std::vector<ObjectsData::VertexTransformed>& vertices= data.areal_objects_vertices;
+	const ObjectsData::MultipolygonRing* const rings= data.multipolygons_rings.data() + in_object.first_ring_index;
+	const ObjectsData::MultipolygonRing* const outer_rings_end= rings + in_object.outer_ring_count;
+	const ObjectsData::MultipolygonRing* const inner_rings_end= outer_rings_end + in_object.inner_ring_count;
+
+	std::vector< std::vector<ProjectionPoint> > result;
+
+	if( in_object.IsMultipolygon() )
+	{
+		if( in_object.inner_ring_count > 0u )
+		{
+			std::vector< std::vector<ProjectionPoint> > outer_rings_splitted, inner_rings_splitted;
+			std::vector<ProjectionPoint> ring_vertices;
+
+			for( const ObjectsData::MultipolygonRing* outer_ring= rings; outer_ring < outer_rings_end; ++outer_ring )
+			{
+				ring_vertices.clear();
+				ring_vertices.reserve( outer_ring->vertex_count );
+				for( size_t v= outer_ring->first_vertex_index; v < outer_ring->first_vertex_index + outer_ring->vertex_count; ++v )
+					ring_vertices.push_back( vertices[v] );
+				auto ring_splitted= SplitPolygonIntNoncrossingParts( ring_vertices, budget );
+				for( std::vector<ProjectionPoint>& ring_part : ring_splitted )
+					outer_rings_splitted.push_back( std::move(ring_part) );
 			}
-			else // if( in_object.multipolygon->inner_rings.empty() )
+			for( const ObjectsData::MultipolygonRing* inner_ring= outer_rings_end; inner_ring < inner_rings_end; ++inner_ring )
 			{
-				for( const BaseDataRepresentation::Multipolygon::Part& outer_ring : in_object.multipolygon->outer_rings )
-				{
-					std::vector<ProjectionPoint> ring_vertices;
-					ring_vertices.reserve( outer_ring.vertex_count );
-					for( size_t v= outer_ring.first_vertex_index; v < outer_ring.first_vertex_index + outer_ring.vertex_count; ++v )
-						ring_vertices.push_back( data.areal_objects_vertices[v] );
-
-					for( const std::vector<ProjectionPoint>& noncrossing_polygon_part : SplitPolygonIntNoncrossingParts( ring_vertices ) )
-					{
-						for( const std::vector<ProjectionPoint>& convex_part : SplitPolygonIntoConvexParts( noncrossing_polygon_part, noncrossing_polygon_part.size() < 512u ) )
-						{
-							PM_ASSERT( convex_part.size() >= 3u );
-
-							BaseDataRepresentation::ArealObject out_object;
-							out_object.class_= in_object.class_;
-							out_object.z_level= in_object.z_level;
-							out_object.first_vertex_index= result_areal_objects_vertices.size();
-							out_object.vertex_count= convex_part.size();
-							for( const ProjectionPoint& vertex : convex_part )
-								result_areal_objects_vertices.push_back(vertex);
-							result_areal_objects.push_back( std::move(out_object) );
-						}
-					}
-				}
+				ring_vertices.clear();
+				ring_vertices.reserve( inner_ring->vertex_count );
+				for( size_t v= inner_ring->first_vertex_index; v < inner_ring->first_vertex_index + inner_ring->vertex_count; ++v )
+					ring_vertices.push_back( vertices[v] );
+				auto ring_splitted= SplitPolygonIntNoncrossingParts( ring_vertices, budget );
+				for( std::vector<ProjectionPoint>& ring_part : ring_splitted )
+					inner_rings_splitted.push_back( std::move(ring_part) );
+			}
+
+			const std::vector< std::vector<size_t> > outer_rings_holes= AssignHolesToOuterRings( outer_rings_splitted, inner_rings_splitted, budget );
+
+			std::vector< std::vector<ProjectionPoint> > outer_ring_holes;
+			for( size_t outer_ring_index= 0u; outer_ring_index < outer_rings_splitted.size(); ++outer_ring_index )
+			{
+				outer_ring_holes.clear();
+				for( const size_t inner_ring_index : outer_rings_holes[outer_ring_index] )
+					outer_ring_holes.push_back( inner_rings_splitted[inner_ring_index] );
+
+				for( std::vector<ProjectionPoint>& convex_part : SplitPolygonWithHolesIntoConvexParts( outer_rings_splitted[outer_ring_index], outer_ring_holes, budget ) )
+					result.push_back(std::move(convex_part));
+			}
+
+			CombineAdjustedConvexPolygons( result );
+		}
+		else // if( in_object.inner_ring_count == 0u )
+		{
+			for( const ObjectsData::MultipolygonRing* outer_ring= rings; outer_ring < outer_rings_end; ++outer_ring )
+			{
+				std::vector<ProjectionPoint> ring_vertices;
+				ring_vertices.reserve( outer_ring->vertex_count );
+				for( size_t v= outer_ring->first_vertex_index; v < outer_ring->first_vertex_index + outer_ring->vertex_count; ++v )
+					ring_vertices.push_back( vertices[v] );
+
+				for( const std::vector<ProjectionPoint>& noncrossing_polygon_part : SplitPolygonIntNoncrossingParts( ring_vertices, budget ) )
+				for( std::vector<ProjectionPoint>& convex_part : SplitPolygonIntoConvexParts( noncrossing_polygon_part, budget ) )
+					result.push_back(std::move(convex_part));
 			}
 		}
+	}
+	else
+	{
+		std::vector<ProjectionPoint> polygon_vertices;
+		polygon_vertices.reserve( in_object.vertex_count );
+		for( size_t v= in_object.first_vertex_index; v < in_object.first_vertex_index + in_object.vertex_count; ++v )
+			polygon_vertices.push_back( vertices[v] );
+
+		for( const std::vector<ProjectionPoint>& noncrossing_polygon_part : SplitPolygonIntNoncrossingParts( polygon_vertices, budget ) )
+		for( std::vector<ProjectionPoint>& convex_part : SplitPolygonIntoConvexParts( noncrossing_polygon_part, budget ) )
+			result.push_back(std::move(convex_part));
+	}
+
+	return result;
+}
+
+// Fast, but inaccurate normalization - split object into trapezoids by horizontal lines through all vertices.
+// Rings are filled by even-odd rule, so, any input is accepted - self-intersecting rings, holes outside outer rings, etc.
+// Trapezoids are not merged, result may contain gaps and overlaps for broken objects.
+// Does not use monotone partition, because its sweep line does not work with crossing edges.
+static std::vector< std::vector<ProjectionPoint> > SplitArealObjectIntoTrapezoids(
+	const BaseDataRepresentation::ArealObject& in_object,
+	const ObjectsData& data )
+{
+	const std::vector<ObjectsData::VertexTransformed>& vertices= data.areal_objects_vertices;
+
+	struct Edge
+	{
+		ProjectionPoint lower;
+		ProjectionPoint upper;
+	};
+	std::vector<Edge> edges;
+	std::vector<int32_t> vertices_y;
+	const auto add_ring=
+	[&]( const size_t first_vertex_index, const size_t vertex_count )
+	{
+		for( size_t v= 0u; v < vertex_count; ++v )
+		{
+			const ProjectionPoint& v0= vertices[ first_vertex_index + v ];
+			const ProjectionPoint& v1= vertices[ first_vertex_index + ( v + 1u ) % vertex_count ];
+			vertices_y.push_back( v0.y );
+			// Horizontal edges do not change filling.
+			if( v0.y < v1.y )
+				edges.push_back( Edge{ v0, v1 } );
+			else if( v0.y > v1.y )
+				edges.push_back( Edge{ v1, v0 } );
+		}
+	};
+
+	if( in_object.IsMultipolygon() )
+	{
+		for( uint32_t r= 0u; r < in_object.outer_ring_count + in_object.inner_ring_count; ++r )
+		{
+			const ObjectsData::MultipolygonRing& ring= data.multipolygons_rings[ in_object.first_ring_index + r ];
+			add_ring( ring.first_vertex_index, ring.vertex_count );
+		}
+	}
+	else
+		add_ring( in_object.first_vertex_index, in_object.vertex_count );
+
+	std::sort( vertices_y.begin(), vertices_y.end() );
+	vertices_y.erase( std::unique( vertices_y.begin(), vertices_y.end() ), vertices_y.end() );
+	std::sort(
+		edges.begin(), edges.end(),
+		[]( const Edge& l, const Edge& r ) { return l.lower.y < r.lower.y; } );
+
+	const auto get_edge_x=
+	[&]( const size_t edge, const double y ) -> double
+	{
+		const Edge& e= edges[edge];
+		return double(e.lower.x) + ( double(e.upper.x) - double(e.lower.x) ) * ( y - double(e.lower.y) ) / ( double(e.upper.y) - double(e.lower.y) );
+	};
+
+	NormalizationBudget budget{ c_trapezoids_operations_per_object, false };
+	std::vector< std::vector<ProjectionPoint> > result;
+	const auto add_trapezoid=
+	[&]( const size_t left_edge, const size_t right_edge, const int32_t y0, const int32_t y1 )
+	{
+		budget.Spend( c_trapezoid_operations );
+		const double left_x0= get_edge_x( left_edge, double(y0) ), left_x1= get_edge_x( left_edge, double(y1) );
+		const double right_x0= get_edge_x( right_edge, double(y0) ), right_x1= get_edge_x( right_edge, double(y1) );
+		const auto add_polygon=
+		[&]( std::vector<ProjectionPoint> polygon )
+		{
+			polygon.erase( std::unique( polygon.begin(), polygon.end() ), polygon.end() );
+			while( polygon.size() > 1u && polygon.front() == polygon.back() )
+				polygon.pop_back();
+			if( polygon.size() < 3u )
+				return;
+			const int64_t double_signed_area= CalculatePolygonDoubleSignedArea( polygon.data(), polygon.size() );
+			if( double_signed_area == 0 )
+				return;
+			if( double_signed_area < 0 )
+				std::reverse( polygon.begin(), polygon.end() );
+			result.push_back( std::move(polygon) );
+		};
+		const auto make_point= []( const double x, const double y ) { return ProjectionPoint{ int32_t( std::round(x) ), int32_t( std::round(y) ) }; };
+
+		if( ( left_x0 <= right_x0 ) == ( left_x1 <= right_x1 ) )
+			add_polygon( { make_point( left_x0, y0 ), make_point( left_x1, y1 ), make_point( right_x1, y1 ), make_point( right_x0, y0 ) } );
 		else
 		{
-			std::vector<ProjectionPoint> polygon_vertices;
-			polygon_vertices.reserve( in_object.vertex_count );
-			for( size_t v= in_object.first_vertex_index; v < in_object.first_vertex_index + in_object.vertex_count; ++v )
-				polygon_vertices.push_back( data.areal_objects_vertices[v] );
+			// Edges are crossing - produce two triangles.
+			const double t= ( right_x0 - left_x0 ) / ( ( right_x0 - left_x0 ) - ( right_x1 - left_x1 ) );
+			const ProjectionPoint crossing= make_point( left_x0 + ( left_x1 - left_x0 ) * t, double(y0) + ( double(y1) - double(y0) ) * t );
+			add_polygon( { make_point( left_x0, y0 ), crossing, make_point( right_x0, y0 ) } );
+			add_polygon( { crossing, make_point( left_x1, y1 ), make_point( right_x1, y1 ) } );
+		}
+	};
+
+	// Active edges are kept sorted by x.
+	// Pairs of active edges bound filled areas. Trapezoid of pair is extended upwards, while same pair of edges bounds it.
+	std::vector<size_t> active_edges;
+	std::vector<size_t> pairs_left_edges;
+	// Data of pairs is stored for left edge of pair.
+	std::vector<size_t> edges_pair_right_edge( edges.size(), c_invalid_index );
+	std::vector<int32_t> edges_pair_y0( edges.size(), 0 );
+	std::vector<size_t> edges_pair_slab( edges.size(), c_invalid_index ), edges_next_pair_right_edge( edges.size(), c_invalid_index );
+
+	size_t next_edge= 0u;
+	int32_t sweep_y= 0; // Top of last processed slab.
+	for( size_t i= 0u; i + 1u < vertices_y.size(); ++i )
+	{
+		const int32_t y0= vertices_y[i], y1= vertices_y[i + 1u];
+
+		active_edges.erase(
+			std::remove_if(
+				active_edges.begin(), active_edges.end(),
+				[&]( const size_t edge ) { return edges[edge].upper.y <= y0; } ),
+			active_edges.end() );
+
+		for( ; next_edge < edges.size() && edges[next_edge].lower.y <= y0; ++next_edge )
+			if( edges[next_edge].upper.y > y0 )
+				active_edges.push_back( next_edge );
+
+		// Sort edges by x in middle of slab, where edges are not touching.
+		// Order changes only for new and crossing edges, so, use insertion sort, which is cheap for almost sorted sequence.
+		// Switch to regular sort, if there are too many changes.
+		const double y_middle= ( double(y0) + double(y1) ) * 0.5;
+		const uint64_t max_moves= uint64_t( active_edges.size() ) * 16u;
+		uint64_t moves= 0u;
+		for( size_t e= 1u; e < active_edges.size() && moves <= max_moves; ++e )
+		{
+			const size_t edge= active_edges[e];
+			const double x= get_edge_x( edge, y_middle );
+			size_t j= e;
+			for( ; j > 0u && get_edge_x( active_edges[j - 1u], y_middle ) > x; --j )
+				active_edges[j]= active_edges[j - 1u];
+			active_edges[j]= edge;
+			moves+= e - j;
+		}
+		if( moves > max_moves )
+			std::sort(
+				active_edges.begin(), active_edges.end(),
+				[&]( const size_t l, const size_t r ) { return get_edge_x( l, y_middle ) < get_edge_x( r, y_middle ); } );
 
-			for( const std::vector<ProjectionPoint>& noncrossing_polygon_part : SplitPolygonIntNoncrossingParts( polygon_vertices ) )
+		if( !budget.Spend( active_edges.size() + moves + 1u ) )
+		{
+			Log::Warning( "Areal object with OSM id ", in_object.osm_id, " is too complex even for approximate normalization, part of it is dropped" );
+			break;
+		}
+
+		// Each closed ring crosses slab even number of times.
+		PM_ASSERT( active_edges.size() % 2u == 0u );
+
+		for( size_t e= 0u; e + 1u < active_edges.size(); e+= 2u )
+		{
+			edges_pair_slab[ active_edges[e] ]= i;
+			edges_next_pair_right_edge[ active_edges[e] ]= active_edges[e + 1u];
+		}
+
+		// Close trapezoids of previous pairs, which are not continued.
+		for( const size_t left_edge : pairs_left_edges )
+		{
+			const size_t right_edge= edges_pair_right_edge[left_edge];
+			if( edges_pair_slab[left_edge] == i && edges_next_pair_right_edge[left_edge] == right_edge )
+				continue;
+			add_trapezoid( left_edge, right_edge, edges_pair_y0[left_edge], y0 );
+			edges_pair_right_edge[left_edge]= c_invalid_index;
+		}
+
+		// Open trapezoids of new pairs.
+		pairs_left_edges.clear();
+		for( size_t e= 0u; e + 1u < active_edges.size(); e+= 2u )
+		{
+			const size_t left_edge= active_edges[e], right_edge= active_edges[e + 1u];
+			pairs_left_edges.push_back( left_edge );
+			if( edges_pair_right_edge[left_edge] != right_edge )
 			{
-				for( const std::vector<ProjectionPoint>& convex_part : SplitPolygonIntoConvexParts( noncrossing_polygon_part ) )
-				{
-					PM_ASSERT( convex_part.size() >= 3u );
-
-					BaseDataRepresentation::ArealObject out_object;
-					out_object.class_= in_object.class_;
-					out_object.z_level= in_object.z_level;
-					out_object.first_vertex_index= result_areal_objects_vertices.size();
-					out_object.vertex_count= convex_part.size();
-					for( const ProjectionPoint& vertex : convex_part )
-						result_areal_objects_vertices.push_back(vertex);
-					result_areal_objects.push_back( std::move(out_object) );
-				}
+				edges_pair_right_edge[left_edge]= right_edge;
+				edges_pair_y0[left_edge]= y0;
 			}
 		}
+
+		sweep_y= y1;
+	}
+
+	for( const size_t left_edge : pairs_left_edges )
+		add_trapezoid( left_edge, edges_pair_right_edge[left_edge], edges_pair_y0[left_edge], sweep_y );
+
+	return result;
+}
+
+// Returns convex parts of object.
+static std::vector< std::vector<ProjectionPoint> > NormalizeArealObject(
+	const BaseDataRepresentation::ArealObject& in_object,
+	const ObjectsData& data )
+{
+	NormalizationBudget budget{ c_normalization_operations_per_object, false };
+	std::vector< std::vector<ProjectionPoint> > result= SplitArealObjectIntoConvexParts( in_object, data, budget );
+	if( !budget.exceeded )
+		return result;
+
+	Log::Warning( "Areal object with OSM id ", in_object.osm_id, " is too complex, use approximate normalization for it" );
+	return SplitArealObjectIntoTrapezoids( in_object, data );
+}
+
+std::vector< std::vector<ProjectionPoint> > SplitPolygonIntoNoncrossingPartsForBenchmark( const std::vector<ProjectionPoint>& polygon )
+{
+	NormalizationBudget budget{ ~uint64_t(0u), false };
+	return SplitPolygonIntNoncrossingParts( polygon, budget );
+}
+
+std::vector< std::vector<ProjectionPoint> > SplitPolygonIntoConvexPartsForBenchmark( const std::vector<ProjectionPoint>& polygon )
+{
+	NormalizationBudget budget{ ~uint64_t(0u), false };
+	return SplitPolygonIntoConvexParts( polygon, budget );
+}
+
+static size_t GetArealObjectVertexCount( const BaseDataRepresentation::ArealObject& object, const ObjectsData& data )
+{
+	if( !object.IsMultipolygon() )
+		return object.vertex_count;
+
+	size_t result= 0u;
+	for( uint32_t r= object.first_ring_index; r < object.first_ring_index + object.outer_ring_count + object.inner_ring_count; ++r )
+		result+= data.multipolygons_rings[r].vertex_count;
+	return result;
+}
+
+void NormalizePolygons( ObjectsData& data )
+{
+	// Time of normalization is very uneven - few huge multipolygons may take more time, than all other objects.
+	// So, process objects in parallel, starting from biggest, and than concatenate results in source order.
+	std::vector<size_t> objects_order( data.areal_objects.size() );
+	for( size_t i= 0u; i < objects_order.size(); ++i )
+		objects_order[i]= i;
+	std::vector<size_t> objects_vertex_count( data.areal_objects.size() );
+	for( size_t i= 0u; i < objects_vertex_count.size(); ++i )
+		objects_vertex_count[i]= GetArealObjectVertexCount( data.areal_objects[i], data );
+	std::sort(
+		objects_order.begin(), objects_order.end(),
+		[&]( const size_t l, const size_t r ) { return objects_vertex_count[l] > objects_vertex_count[r]; } );
+
+	std::vector< std::vector< std::vector<ProjectionPoint> > > objects_convex_parts( data.areal_objects.size() );
+	std::atomic<size_t> next_object( 0u );
+	const auto process_objects=
+	[&]
+	{
+		while(true)
+		{
+			const size_t order_index= next_object.fetch_add( 1u );
+			if( order_index >= objects_order.size() )
+				break;
+			const size_t object_index= objects_order[order_index];
+			objects_convex_parts[object_index]= NormalizeArealObject( data.areal_objects[object_index], data );
+		}
+	};
+
+	const size_t thread_count= std::max( 1u, std::thread::hardware_concurrency() );
+	std::vector<std::thread> threads;
+	for( size_t i= 1u; i < thread_count; ++i )
+		threads.emplace_back( process_objects );
+	process_objects();
+	for( std::thread& thread : threads )
+		thread.join();
+
+	// Source vertices are not needed anymore - free them before result concatenation.
+	data.areal_objects_vertices.clear();
+	data.areal_objects_vertices.shrink_to_fit();
+	data.multipolygons_rings.clear();
+	data.multipolygons_rings.shrink_to_fit();
+
+	size_t result_object_count= 0u, result_vertex_count= 0u;
+	for( const std::vector< std::vector<ProjectionPoint> >& convex_parts : objects_convex_parts )
+	{
+		result_object_count+= convex_parts.size();
+		for( const std::vector<ProjectionPoint>& convex_part : convex_parts )
+			result_vertex_count+= convex_part.size();
+	}
+
+	std::vector<ObjectsData::ArealObject> result_areal_objects;
+	std::vector<ObjectsData::VertexTransformed> result_areal_objects_vertices;
+	result_areal_objects.reserve( result_object_count );
+	result_areal_objects_vertices.reserve( result_vertex_count );
+	for( size_t object_index= 0u; object_index < data.areal_objects.size(); ++object_index )
+	{
+		const BaseDataRepresentation::ArealObject& in_object= data.areal_objects[object_index];
+		for( const std::vector<ProjectionPoint>& convex_part : objects_convex_parts[object_index] )
+		{
+			PM_ASSERT( convex_part.size() >= 3u );
+
+			BaseDataRepresentation::ArealObject out_object;
+			out_object.class_= in_object.class_;
+			out_object.z_level= in_object.z_level;
+			out_object.osm_id= in_object.osm_id;
+			out_object.first_vertex_index= static_cast<ObjectsData::VertexIndex>( result_areal_objects_vertices.size() );
+			out_object.vertex_count= static_cast<ObjectsData::VertexIndex>( convex_part.size() );
+			result_areal_objects_vertices.insert( result_areal_objects_vertices.end(), convex_part.begin(), convex_part.end() );
+			result_areal_objects.push_back( std::move(out_object) );
+		}
+		objects_convex_parts[object_index].clear();
+		objects_convex_parts[object_index].shrink_to_fit();
 	}
 
 	data.areal_objects= std::move(result_areal_objects);
 	data.areal_objects_vertices= std::move(result_areal_objects_vertices);
 
 	Log::Info( "Polygons normalization pass: " );
+	Log::Info( thread_count, " threads" );
 	Log::Info( data.areal_objects.size(), " areal objects" );
 	Log::Info( data.areal_objects_vertices.size(), " areal objects vertices" );
 	Log::Info( "" );
@@ -8,4 +8,10 @@ namespace PanzerMaps
 // TODO - fix also self-intersecting polygons.
 void NormalizePolygons( ObjectsData& data );
 
+// Separate steps of normalization, without limit of work. Used in benchmarks.
+// Split polygon with self-intersections into parts without self-intersections.
+std::vector< std::vector<ProjectionPoint> > SplitPolygonIntoNoncrossingPartsForBenchmark( const std::vector<ProjectionPoint>& polygon );
+// Split polygon without self-intersections into clockwise convex parts.
+std::vector< std::vector<ProjectionPoint> > SplitPolygonIntoConvexPartsForBenchmark( const std::vector<ProjectionPoint>& polygon );
+
 } // namespace PanzerMaps
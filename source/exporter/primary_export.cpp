@@ -540,26 +540,35 @@ static std::vector< std::vector<GeoPoint> > CreateClosedWays(
 }
 
 static void CreateMultipolygon(
-	OSMParseResult::Multipolygon& out_multipolygon,
+	OSMParseResult::ArealObject& out_object,
+	std::vector<OSMParseResult::MultipolygonRing>& out_rings,
 	std::vector<GeoPoint>& out_vertices,
 	const std::vector< std::vector<GeoPoint> >& outer_ways,
 	const std::vector< std::vector<GeoPoint> >& inner_ways )
 {
+	out_object.first_vertex_index= out_object.vertex_count= 0u;
+	out_object.first_ring_index= static_cast<uint32_t>( out_rings.size() );
+	out_object.outer_ring_count= out_object.inner_ring_count= 0u;
+
+	const auto add_ring=
+	[&]( const std::vector<GeoPoint>& way )
+	{
+		OSMParseResult::MultipolygonRing ring;
+		ring.first_vertex_index= static_cast<OSMParseResult::VertexIndex>( out_vertices.size() );
+		ring.vertex_count= static_cast<OSMParseResult::VertexIndex>( way.size() );
+		out_rings.push_back( ring );
+		out_vertices.insert( out_vertices.end(), way.begin(), way.end() );
+	};
+
 	for( const std::vector<GeoPoint>& outer_way : CreateClosedWays( outer_ways ) )
 	{
-		out_multipolygon.outer_rings.emplace_back();
-		OSMParseResult::Multipolygon::Part& part= out_multipolygon.outer_rings.back();
-		part.first_vertex_index= out_vertices.size();
-		part.vertex_count= outer_way.size();
-		out_vertices.insert( out_vertices.end(), outer_way.begin(), outer_way.end() );
+		add_ring( outer_way );
+		++out_object.outer_ring_count;
 	}
 	for( const std::vector<GeoPoint>& inner_way : CreateClosedWays( inner_ways ) )
 	{
-		out_multipolygon.inner_rings.emplace_back();
-		OSMParseResult::Multipolygon::Part& part= out_multipolygon.inner_rings.back();
-		part.first_vertex_index= out_vertices.size();
-		part.vertex_count= inner_way.size();
-		out_vertices.insert( out_vertices.end(), inner_way.begin(), inner_way.end() );
+		add_ring( inner_way );
+		++out_object.inner_ring_count;
 	}
 }
 
@@ -669,9 +678,10 @@ OSMParseResult ParseOSM( const char* file_name )
 	std::vector<GeoPoint> tmp_points;
 	for( const tinyxml2::XMLElement* way_element= doc.RootElement()->FirstChildElement( "way" ); way_element != nullptr; way_element= way_element->NextSiblingElement( "way" ) )
 	{
-		if( const char* const id_str= way_element->Attribute("id") )
-			if( const OsmId id= ParseOsmId( id_str ) )
-				ways_map[id]= way_element;
+		const char* const id_str= way_element->Attribute("id");
+		const OsmId id= id_str == nullptr ? 0u : ParseOsmId( id_str );
+		if( id != 0u )
+			ways_map[id]= way_element;
 
 		const WayClassifyResult classify_result= ClassifyWay( *way_element, false );
 		if( classify_result.point_object_class != PointObjectClass::None )
@@ -700,10 +710,10 @@ OSMParseResult ParseOSM( const char* file_name )
 		{
 			OSMParseResult::LinearObject obj;
 			obj.class_= classify_result.linear_object_class;
-			obj.z_level= classify_result.z_level;
-			obj.first_vertex_index= result.linear_objects_vertices.size();
+			obj.z_level= static_cast<uint8_t>( classify_result.z_level );
+			obj.first_vertex_index= static_cast<OSMParseResult::VertexIndex>( result.linear_objects_vertices.size() );
 			ExtractVertices( way_element, nodes, result.linear_objects_vertices );
-			obj.vertex_count= result.linear_objects_vertices.size() - obj.first_vertex_index;
+			obj.vertex_count= static_cast<OSMParseResult::VertexIndex>( result.linear_objects_vertices.size() - obj.first_vertex_index );
 			if( obj.vertex_count > 0u )
 				result.linear_objects.push_back(obj);
 		}
@@ -711,12 +721,13 @@ OSMParseResult ParseOSM( const char* file_name )
 		{
 			OSMParseResult::ArealObject obj;
 			obj.class_= classify_result.areal_object_class;
-			obj.z_level= classify_result.z_level;
-			obj.first_vertex_index= result.areal_objects_vertices.size();
+			obj.z_level= static_cast<uint8_t>( classify_result.z_level );
+			obj.osm_id= id;
+			obj.first_vertex_index= static_cast<OSMParseResult::VertexIndex>( result.areal_objects_vertices.size() );
 			ExtractVertices( way_element, nodes, result.areal_objects_vertices );
-			obj.vertex_count= result.areal_objects_vertices.size() - obj.first_vertex_index;
+			obj.vertex_count= static_cast<OSMParseResult::VertexIndex>( result.areal_objects_vertices.size() - obj.first_vertex_index );
 			if( obj.vertex_count > 0u )
-				result.areal_objects.push_back( std::move(obj) );
+				result.areal_objects.push_back( obj );
 		}
 	}
 
@@ -752,9 +763,9 @@ OSMParseResult ParseOSM( const char* file_name )
 			{
 				OSMParseResult::LinearObject obj;
 				obj.class_= classify_result.linear_object_class;
-				obj.first_vertex_index= result.linear_objects_vertices.size();
+				obj.first_vertex_index= static_cast<OSMParseResult::VertexIndex>( result.linear_objects_vertices.size() );
 				ExtractVertices( it->second, nodes, result.linear_objects_vertices );
-				obj.vertex_count= result.linear_objects_vertices.size() - obj.first_vertex_index;
+				obj.vertex_count= static_cast<OSMParseResult::VertexIndex>( result.linear_objects_vertices.size() - obj.first_vertex_index );
 				if( obj.vertex_count > 0u )
 					result.linear_objects.push_back(obj);
 			}
@@ -775,14 +786,21 @@ OSMParseResult ParseOSM( const char* file_name )
 		{
 			OSMParseResult::ArealObject obj;
 			obj.class_= classify_result.areal_object_class;
-			obj.z_level= classify_result.z_level;
-			obj.first_vertex_index= obj.vertex_count= 0u;
+			obj.z_level= static_cast<uint8_t>( classify_result.z_level );
+			if( const char* const id_str= relation_element->Attribute("id") )
+				obj.osm_id= ParseOsmId( id_str );
 
-			obj.multipolygon.reset( new OSMParseResult::Multipolygon );
-			CreateMultipolygon( *obj.multipolygon, result.areal_objects_vertices, outer_ways, inner_ways );
+			const size_t prev_vertex_count= result.areal_objects_vertices.size();
+			CreateMultipolygon( obj, result.multipolygons_rings, result.areal_objects_vertices, outer_ways, inner_ways );
 
-			if( !obj.multipolygon->outer_rings.empty() )
-				result.areal_objects.push_back( std::move(obj) );
+			if( obj.IsMultipolygon() )
+				result.areal_objects.push_back( obj );
+			else
+			{
+				// Remove inner rings of multipolygon without outer rings.
+				result.multipolygons_rings.resize( obj.first_ring_index );
+				result.areal_objects_vertices.resize( prev_vertex_count );
+			}
 		}
 
 		if( !outer_ways.empty() && classify_result.point_object_class != PointObjectClass::None )
@@ -1,5 +1,4 @@
 #pragma once
-#include <memory>
 #include <vector>
 
 #include "../common/coordinates_conversion.hpp"
@@ -11,8 +10,11 @@ namespace PanzerMaps
 const size_t g_zero_z_level= 5u;
 const size_t g_max_z_level= 10u;
 
+// Objects are processed in big arrays, so, they are compact - with 32-bit indices and 8-bit classes and z levels.
 struct BaseDataRepresentation
 {
+	using VertexIndex= uint32_t;
+
 	struct PointObject
 	{
 		PointObjectClass class_= PointObjectClass::None;
@@ -21,36 +23,40 @@ struct BaseDataRepresentation
 	struct LinearObject
 	{
 		LinearObjectClass class_= LinearObjectClass::None;
-		size_t first_vertex_index;
-		size_t vertex_count; // 1 or more.
-		size_t z_level= g_zero_z_level;
+		uint8_t z_level= g_zero_z_level;
+		VertexIndex first_vertex_index;
+		VertexIndex vertex_count; // 1 or more.
 	};
 
-	struct Multipolygon
+	// Rings of all multipolygons are stored in one array.
+	struct MultipolygonRing
 	{
-		struct Part
-		{
-			size_t first_vertex_index;
-			size_t vertex_count;
-		};
-
-		std::vector<Part> outer_rings;
-		std::vector<Part> inner_rings;
+		VertexIndex first_vertex_index;
+		VertexIndex vertex_count;
 	};
 
 	struct ArealObject
 	{
 		ArealObjectClass class_= ArealObjectClass::None;
-		size_t first_vertex_index;
-		size_t vertex_count;
-		size_t z_level= g_zero_z_level;
+		uint8_t z_level= g_zero_z_level;
+		VertexIndex first_vertex_index;
+		VertexIndex vertex_count;
+
+		// Non-zero for multipolygons. Outer rings are followed by inner rings in "multipolygons_rings".
+		// Vertex range of multipolygon itself is empty.
+		uint32_t first_ring_index= 0u;
+		uint32_t outer_ring_count= 0u;
+		uint32_t inner_ring_count= 0u;
+
+		uint64_t osm_id= 0u; // Id of source way or relation. Used only for diagnostics.
 
-		std::unique_ptr<Multipolygon> multipolygon;
+		bool IsMultipolygon() const { return outer_ring_count > 0u; }
 	};
 
 	std::vector<PointObject> point_objects;
 	std::vector<LinearObject> linear_objects;
 	std::vector<ArealObject> areal_objects;
+	std::vector<MultipolygonRing> multipolygons_rings;
 };
 
 struct OSMParseResult : public BaseDataRepresentation
@@ -1,3 +1,5 @@
+#include <algorithm>
+#include <iterator>
 #include <unordered_map>
 #include "../common/assert.hpp"
 #include "../common/log.hpp"
@@ -253,30 +255,167 @@ static void SimplifyPolygon(
 	}
 }
 
-void SimplificationPass( ObjectsData& data, const int32_t simplification_distance_units )
+// Lines may be shifted by some part of its width without visible changes.
+static const float c_width_to_simplification_distance_ratio= 0.25f;
+// Limit for distance, derived from line width. Distances, specified in styles explicitly, are not limited.
+static const int32_t c_max_derived_simplification_distance_units= 16;
+
+static int32_t MetersToSimplificationDistance( const float distance_m, const float meters_in_unit )
+{
+	if( !( meters_in_unit > 0.0f ) )
+		return 1;
+	return std::max( 1, int32_t( distance_m / meters_in_unit ) );
+}
+
+// Greedy Poisson disk selection - accept point, if there is no accepted point closer, than min distance.
+// Points of rare classes are accepted first, so, dense classes (like bus stops) do not hide rare landmarks.
+static void ThinPointObjects( ObjectsData& data, const int32_t min_distance )
+{
+	if( min_distance <= 0 || data.point_objects.empty() )
+		return;
+
+	size_t class_object_count[ size_t(PointObjectClass::Last) ]= { 0u };
+	for( const BaseDataRepresentation::PointObject& object : data.point_objects )
+		++class_object_count[ size_t(object.class_) ];
+
+	std::vector<size_t> objects_order( data.point_objects.size() );
+	for( size_t i= 0u; i < objects_order.size(); ++i )
+		objects_order[i]= i;
+	std::stable_sort(
+		objects_order.begin(), objects_order.end(),
+		[&]( const size_t l, const size_t r )
+		{
+			return class_object_count[ size_t(data.point_objects[l].class_) ] < class_object_count[ size_t(data.point_objects[r].class_) ];
+		} );
+
+	// Grid with cell size equal to min distance - check only 3x3 neighbor cells.
+	const auto get_cell=
+	[&]( const ObjectsData::VertexTransformed& vertex ) -> std::pair<int32_t, int32_t>
+	{
+		return std::make_pair(
+			int32_t( ( int64_t(vertex.x) - data.min_point.x ) / min_distance ),
+			int32_t( ( int64_t(vertex.y) - data.min_point.y ) / min_distance ) );
+	};
+	// Cells may be negative, so, build key from unsigned values.
+	const auto get_cell_key=
+	[]( const int32_t cell_x, const int32_t cell_y ) -> uint64_t
+	{
+		return ( uint64_t( uint32_t(cell_y) ) << 32 ) | uint64_t( uint32_t(cell_x) );
+	};
+	const int64_t square_min_distance= int64_t(min_distance) * int64_t(min_distance);
+
+	std::unordered_map< uint64_t, std::vector<ObjectsData::VertexTransformed> > accepted_points_grid;
+	std::vector<bool> object_accepted( data.point_objects.size(), false );
+	for( const size_t object_index : objects_order )
+	{
+		const ObjectsData::VertexTransformed& vertex= data.point_objects_vertices[object_index];
+		const std::pair<int32_t, int32_t> cell= get_cell( vertex );
+
+		bool accept= true;
+		for( int32_t dy= -1; dy <= 1 && accept; ++dy )
+		for( int32_t dx= -1; dx <= 1 && accept; ++dx )
+		{
+			const auto it= accepted_points_grid.find( get_cell_key( cell.first + dx, cell.second + dy ) );
+			if( it == accepted_points_grid.end() )
+				continue;
+			for( const ObjectsData::VertexTransformed& accepted_vertex : it->second )
+			{
+				const int64_t vec_x= int64_t(vertex.x) - int64_t(accepted_vertex.x);
+				const int64_t vec_y= int64_t(vertex.y) - int64_t(accepted_vertex.y);
+				if( vec_x * vec_x + vec_y * vec_y < square_min_distance )
+				{
+					accept= false;
+					break;
+				}
+			}
+		}
+
+		if( accept )
+		{
+			accepted_points_grid[ get_cell_key( cell.first, cell.second ) ].push_back( vertex );
+			object_accepted[object_index]= true;
+		}
+	}
+
+	// Preserve objects order.
+	size_t result_object_count= 0u;
+	for( size_t i= 0u; i < data.point_objects.size(); ++i )
+	{
+		if( !object_accepted[i] )
+			continue;
+		data.point_objects[result_object_count]= data.point_objects[i];
+		data.point_objects_vertices[result_object_count]= data.point_objects_vertices[i];
+		++result_object_count;
+	}
+	data.point_objects.resize( result_object_count );
+	data.point_objects_vertices.resize( result_object_count );
+}
+
+void SimplificationPass( ObjectsData& data, const Styles::ZoomLevel& zoom_level )
 {
+	const size_t source_point_object_count= data.point_objects.size();
+	ThinPointObjects( data, zoom_level.point_objects_min_distance );
+
 	std::vector<ObjectsData::LinearObject> result_linear_objects;
 	std::vector<ObjectsData::VertexTransformed> result_linear_objects_vertices;
 
 	std::vector<ObjectsData::ArealObject> result_areal_objects;
 	std::vector<ObjectsData::VertexTransformed> result_areal_objects_vertices;
+	std::vector<ObjectsData::MultipolygonRing> result_multipolygons_rings;
 
+	const int32_t simplification_distance_units= zoom_level.simplification_distance;
 	const int32_t simplification_distance_corrected= std::max( 1, simplification_distance_units );
 
+	// Calculate simplification distance for each class.
+	// Distance, specified in style, overrides distance of zoom level.
+	// For lines without such distance, use part of line width, but not less, than distance of zoom level.
+	int32_t linear_simplification_distance[ size_t(LinearObjectClass::Last) ];
+	for( size_t i= 0u; i < size_t(LinearObjectClass::Last); ++i )
+	{
+		linear_simplification_distance[i]= simplification_distance_corrected;
+
+		const auto style_it= zoom_level.linear_object_styles.find( static_cast<LinearObjectClass>(i) );
+		if( style_it == zoom_level.linear_object_styles.end() )
+			continue;
+
+		const Styles::LinearObjectStyle& style= style_it->second;
+		if( style.simplification_distance_m >= 0.0f )
+			linear_simplification_distance[i]= MetersToSimplificationDistance( style.simplification_distance_m, data.meters_in_unit );
+		else
+			linear_simplification_distance[i]=
+				std::max(
+					simplification_distance_corrected,
+					std::min(
+						MetersToSimplificationDistance( style.width_m * c_width_to_simplification_distance_ratio, data.meters_in_unit ),
+						c_max_derived_simplification_distance_units ) );
+	}
+
+	int32_t areal_simplification_distance[ size_t(ArealObjectClass::Last) ];
+	for( size_t i= 0u; i < size_t(ArealObjectClass::Last); ++i )
+	{
+		areal_simplification_distance[i]= simplification_distance_corrected;
+
+		const auto style_it= zoom_level.areal_object_styles.find( static_cast<ArealObjectClass>(i) );
+		if( style_it != zoom_level.areal_object_styles.end() && style_it->second.simplification_distance_m >= 0.0f )
+			areal_simplification_distance[i]= MetersToSimplificationDistance( style_it->second.simplification_distance_m, data.meters_in_unit );
+	}
+
 	// Simplify lines.
+	result_linear_objects.reserve( data.linear_objects.size() );
+	result_linear_objects_vertices.reserve( data.linear_objects_vertices.size() );
 	for( const BaseDataRepresentation::LinearObject& in_object : data.linear_objects )
 	{
 		BaseDataRepresentation::LinearObject out_object;
 		out_object.class_= in_object.class_;
 		out_object.z_level= in_object.z_level;
-		out_object.first_vertex_index= result_linear_objects_vertices.size();
+		out_object.first_vertex_index= static_cast<BaseDataRepresentation::VertexIndex>( result_linear_objects_vertices.size() );
 
 		SimplifyLine(
 			data.linear_objects_vertices.data() + in_object.first_vertex_index,
 			in_object.vertex_count,
-			simplification_distance_corrected,
+			linear_simplification_distance[ size_t(in_object.class_) ],
 			result_linear_objects_vertices );
-		out_object.vertex_count= result_linear_objects_vertices.size() - out_object.first_vertex_index;
+		out_object.vertex_count= static_cast<BaseDataRepresentation::VertexIndex>( result_linear_objects_vertices.size() - out_object.first_vertex_index );
 
 		PM_ASSERT( out_object.vertex_count >= 1u );
 		if( in_object.vertex_count >= 2u )
@@ -284,6 +423,9 @@ void SimplificationPass( ObjectsData& data, const int32_t simplification_distanc
 
 		result_linear_objects.push_back( out_object );
 	}
+	// Free source vertices as early as possible, to reduce peak memory usage.
+	data.linear_objects= std::move(result_linear_objects);
+	data.linear_objects_vertices= std::move(result_linear_objects_vertices);
 
 	// Count adjusted vertices of areal objects.
 	AdjustedVerticesMap adjusted_areal_vertices_map;
@@ -307,13 +449,8 @@ void SimplificationPass( ObjectsData& data, const int32_t simplification_distanc
 		};
 
 		count_vertices( in_object.first_vertex_index, in_object.vertex_count );
-		if( in_object.multipolygon != nullptr )
-		{
-			for( const BaseDataRepresentation::Multipolygon::Part& inner_ring : in_object.multipolygon->inner_rings )
-				count_vertices( inner_ring.first_vertex_index, inner_ring.vertex_count );
-			for( const BaseDataRepresentation::Multipolygon::Part& outer_ring : in_object.multipolygon->outer_rings )
-				count_vertices( outer_ring.first_vertex_index, outer_ring.vertex_count );
-		}
+		for( uint32_t r= in_object.first_ring_index; r < in_object.first_ring_index + in_object.outer_ring_count + in_object.inner_ring_count; ++r )
+			count_vertices( data.multipolygons_rings[r].first_vertex_index, data.multipolygons_rings[r].vertex_count );
 	}
 
 	size_t vertices_by_count[256u] { 0u };
@@ -322,58 +459,66 @@ void SimplificationPass( ObjectsData& data, const int32_t simplification_distanc
 			++vertices_by_count[map_value.second];
 
 	// Simplify polygon contours. Disable simplification for points, which are same for 2 or more polygons.
+	result_areal_objects.reserve( data.areal_objects.size() );
+	result_areal_objects_vertices.reserve( data.areal_objects_vertices.size() );
+	result_multipolygons_rings.reserve( data.multipolygons_rings.size() );
 	for( const BaseDataRepresentation::ArealObject& in_object : data.areal_objects )
 	{
 		const auto transform_polygon=
-		[&]( const size_t in_first_vertex, const size_t in_vertex_count, size_t& out_first_vertex, size_t& out_vertex_count )
+		[&]( const size_t in_first_vertex, const size_t in_vertex_count, BaseDataRepresentation::VertexIndex& out_first_vertex, BaseDataRepresentation::VertexIndex& out_vertex_count )
 		{
-			out_first_vertex= result_areal_objects_vertices.size();
+			out_first_vertex= static_cast<BaseDataRepresentation::VertexIndex>( result_areal_objects_vertices.size() );
 
 			SimplifyPolygon(
 				data.areal_objects_vertices.data() + in_first_vertex,
 				in_vertex_count,
-				std::max( 1, simplification_distance_units ),
+				areal_simplification_distance[ size_t(in_object.class_) ],
 				adjusted_areal_vertices_map,
 				in_object.class_,
 				in_object.z_level,
 				result_areal_objects_vertices );
 
-			out_vertex_count= result_areal_objects_vertices.size() - out_first_vertex;
+			out_vertex_count= static_cast<BaseDataRepresentation::VertexIndex>( result_areal_objects_vertices.size() - out_first_vertex );
 		};
 
-		if( in_object.multipolygon != nullptr )
+		if( in_object.IsMultipolygon() )
 		{
-			BaseDataRepresentation::Multipolygon out_multipolygon;
-			for( const BaseDataRepresentation::Multipolygon::Part& inner_ring : in_object.multipolygon->inner_rings )
-			{
-				BaseDataRepresentation::Multipolygon::Part out_part;
-				transform_polygon( inner_ring.first_vertex_index, inner_ring.vertex_count, out_part.first_vertex_index, out_part.vertex_count );
-				if( out_part.vertex_count > 0u )
-					out_multipolygon.inner_rings.push_back(out_part);
-			}
-			for( const BaseDataRepresentation::Multipolygon::Part& outer_ring : in_object.multipolygon->outer_rings )
-			{
-				BaseDataRepresentation::Multipolygon::Part out_part;
-				transform_polygon( outer_ring.first_vertex_index, outer_ring.vertex_count, out_part.first_vertex_index, out_part.vertex_count );
-				if( out_part.vertex_count > 0u )
-					out_multipolygon.outer_rings.push_back(out_part);
-			}
+			BaseDataRepresentation::ArealObject out_object;
+			out_object.class_= in_object.class_;
+			out_object.z_level= in_object.z_level;
+			out_object.osm_id= in_object.osm_id;
+			out_object.first_vertex_index= out_object.vertex_count= 0u;
+			out_object.first_ring_index= static_cast<uint32_t>( result_multipolygons_rings.size() );
 
-			if( !out_multipolygon.outer_rings.empty() )
+			const auto transform_rings=
+			[&]( const uint32_t first_ring, const uint32_t ring_count ) -> uint32_t
 			{
-				BaseDataRepresentation::ArealObject out_object;
-				out_object.class_= in_object.class_;
-				out_object.z_level= in_object.z_level;
-				out_object.first_vertex_index= out_object.vertex_count= 0u;
-				out_object.multipolygon.reset( new BaseDataRepresentation::Multipolygon( std::move(out_multipolygon) ) );
-				result_areal_objects.push_back( std::move(out_object) );
-			}
+				uint32_t result_ring_count= 0u;
+				for( uint32_t r= first_ring; r < first_ring + ring_count; ++r )
+				{
+					BaseDataRepresentation::MultipolygonRing out_ring;
+					transform_polygon( data.multipolygons_rings[r].first_vertex_index, data.multipolygons_rings[r].vertex_count, out_ring.first_vertex_index, out_ring.vertex_count );
+					if( out_ring.vertex_count > 0u )
+					{
+						result_multipolygons_rings.push_back(out_ring);
+						++result_ring_count;
+					}
+				}
+				return result_ring_count;
+			};
+			out_object.outer_ring_count= transform_rings( in_object.first_ring_index, in_object.outer_ring_count );
+			if( out_object.outer_ring_count == 0u )
+				continue;
+			out_object.inner_ring_count= transform_rings( in_object.first_ring_index + in_object.outer_ring_count, in_object.inner_ring_count );
+
+			result_areal_objects.push_back( out_object );
 		}
 		else
 		{
 			BaseDataRepresentation::ArealObject out_object;
 			out_object.class_= in_object.class_;
 			out_object.z_level= in_object.z_level;
+			out_object.osm_id= in_object.osm_id;
 
 			transform_polygon( in_object.first_vertex_index, in_object.vertex_count, out_object.first_vertex_index, out_object.vertex_count );
 			if( out_object.vertex_count > 0u )
@@ -381,13 +526,20 @@ void SimplificationPass( ObjectsData& data, const int32_t simplification_distanc
 		}
 	}
 
-	data.linear_objects= std::move(result_linear_objects);
-	data.linear_objects_vertices= std::move(result_linear_objects_vertices);
 	data.areal_objects= std::move(result_areal_objects);
 	data.areal_objects_vertices= std::move(result_areal_objects_vertices);
+	data.multipolygons_rings= std::move(result_multipolygons_rings);
 
 	Log::Info( "Simplification pass: " );
-	Log::Info( "Simplification distance: ", data.coordinates_scale * simplification_distance_units );
+	Log::Info(
+		"Simplification distance: ",
+		"lines ",
+		data.coordinates_scale * *std::min_element( std::begin(linear_simplification_distance), std::end(linear_simplification_distance) ), "-",
+		data.coordinates_scale * *std::max_element( std::begin(linear_simplification_distance), std::end(linear_simplification_distance) ),
+		", areas ",
+		data.coordinates_scale * *std::min_element( std::begin(areal_simplification_distance), std::end(areal_simplification_distance) ), "-",
+		data.coordinates_scale * *std::max_element( std::begin(areal_simplification_distance), std::end(areal_simplification_distance) ) );
+	Log::Info( data.point_objects.size(), " point objects of ", source_point_object_count );
 	Log::Info( data.linear_objects.size(), " linear objects" );
 	Log::Info( data.linear_objects_vertices.size(), " linear objects vertices" );
 	Log::Info( data.areal_objects.size(), " areal objects" );
@@ -1,10 +1,13 @@
 #pragma once
 #include "coordinates_transformation_pass.hpp"
+#include "styles.hpp"
 
 namespace PanzerMaps
 {
 
 // Simplify lines and areal objects.
-void SimplificationPass( ObjectsData& data, int32_t simplification_distance_units );
+// Simplification distance selected for each object class, using styles of zoom level.
+// Point objects are thinned out, if min distance between them is specified in zoom level.
+void SimplificationPass( ObjectsData& data, const Styles::ZoomLevel& zoom_level );
 
 } // namespace PanzerMaps
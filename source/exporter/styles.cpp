@@ -97,6 +97,12 @@ static void ParseLinearObjectStyles( const PanzerJson::Value& linear_styles_json
 			if( dash_size_m_json.IsNumber() )
 			out_style.dash_size_m= std::max( 0.25f, dash_size_m_json.AsFloat() );
 		}
+		if( linear_style_json.second.IsMember( "simplification_distance_m" ) )
+		{
+			const PanzerJson::Value& simplification_distance_m_json= linear_style_json.second["simplification_distance_m"];
+			if( simplification_distance_m_json.IsNumber() )
+				out_style.simplification_distance_m= std::max( 0.0f, simplification_distance_m_json.AsFloat() );
+		}
 
 		const char* const image_file_name= linear_style_json.second["image"].AsString();
 		if( image_file_name != nullptr && image_file_name[0] != 0 )
@@ -119,6 +125,18 @@ static void ParseArealObjectStyles( const PanzerJson::Value& areal_styles_json,
 
 		if( areal_style_json.second.IsMember( "color" ) )
 			ParseColor( areal_style_json.second["color"].AsString(), out_style.color );
+		if( areal_style_json.second.IsMember( "simplification_distance_m" ) )
+		{
+			const PanzerJson::Value& simplification_distance_m_json= areal_style_json.second["simplification_distance_m"];
+			if( simplification_distance_m_json.IsNumber() )
+				out_style.simplification_distance_m= std::max( 0.0f, simplification_distance_m_json.AsFloat() );
+		}
+		if( areal_style_json.second.IsMember( "dissolve_distance_m" ) )
+		{
+			const PanzerJson::Value& dissolve_distance_m_json= areal_style_json.second["dissolve_distance_m"];
+			if( dissolve_distance_m_json.IsNumber() )
+				out_style.dissolve_distance_m= std::max( 0.0f, dissolve_distance_m_json.AsFloat() );
+		}
 	}
 
 }
@@ -141,6 +159,10 @@ static Styles::ZoomLevel ParseZoomLevel(
 	{
 		zoom_level.simplification_distance= std::max( 0, std::min( zoom_level_json["simplification_distance_units"].AsInt(), 16 ) );
 	}
+	if( zoom_level_json.IsMember( "point_objects_min_distance_units" ) )
+	{
+		zoom_level.point_objects_min_distance= std::max( 0, std::min( zoom_level_json["point_objects_min_distance_units"].AsInt(), 1024 ) );
+	}
 
 	ParsePointObjectStyles( zoom_level_json["point_styles"], zoom_level.point_object_styles, styles_dir );
 	ParseLinearObjectStyles( zoom_level_json["linear_styles"], zoom_level.linear_object_styles, styles_dir );
@@ -194,6 +216,23 @@ static Styles::ZoomLevel ParseZoomLevel(
 		zoom_level.linear_classes_ordered.push_back( object_class );
 	}
 
+	for( const auto& linear_class_alias_json : zoom_level_json["linear_class_aliases"].object_elements() )
+	{
+		const LinearObjectClass object_class= StringToLinearObjectClass( linear_class_alias_json.first );
+		const LinearObjectClass alias_class= StringToLinearObjectClass( linear_class_alias_json.second.AsString() );
+		if( object_class == LinearObjectClass::None )
+		{
+			Log::Warning( "Unknown linear object class: ", linear_class_alias_json.first );
+			continue;
+		}
+		if( alias_class == LinearObjectClass::None )
+		{
+			Log::Warning( "Unknown linear object class: ", linear_class_alias_json.second.AsString() );
+			continue;
+		}
+		zoom_level.linear_class_aliases[ object_class ]= alias_class;
+	}
+
 	return zoom_level;
 }
 
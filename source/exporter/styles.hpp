@@ -25,12 +25,15 @@ public:
 		ColorRGBA color2= {0};
 		float width_m= 0.0f;
 		float dash_size_m= 1.0f;
+		float simplification_distance_m= -1.0f; // Negative - calculate from width.
 		ImageRGBA image;
 	};
 
 	struct ArealObjectStyle
 	{
 		ColorRGBA color= {0};
+		float simplification_distance_m= -1.0f; // Negative - use simplification distance of zoom level.
+		float dissolve_distance_m= -1.0f; // Negative - do not dissolve. Non-negative - union objects, closer to each other, than this distance.
 	};
 
 	struct ArealObjectPhase
@@ -46,9 +49,12 @@ public:
 	{
 		size_t scale_to_prev_log2= 1u; // For first zoom level - initial scale.
 		int32_t simplification_distance= 1; // In units
+		int32_t point_objects_min_distance= 0; // In units. Point objects closer to each other are thinned out. Zero - no thinning.
 		std::vector<ArealObjectPhase> areal_object_phases;
 		std::vector<PointObjectClass> point_classes_ordered;
 		std::vector<LinearObjectClass> linear_classes_ordered;
+		// Objects of key class are processed as objects of value class. Used for merging of objects with same style.
+		std::unordered_map<LinearObjectClass, LinearObjectClass> linear_class_aliases;
 
 		PointObjectStyles point_object_styles;
 		LinearObjectStyles linear_object_styles;
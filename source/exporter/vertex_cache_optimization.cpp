@@ -0,0 +1,163 @@
+#include <algorithm>
+#include <cmath>
+
+#include "../common/assert.hpp"
+#include "vertex_cache_optimization.hpp"
+
+namespace PanzerMaps
+{
+
+// Parameters of simulated cache. Real GPU caches are different, but algorithm is not very sensitive to them.
+static const size_t c_cache_size= 32u;
+static const float c_cache_decay_power= 1.5f;
+static const float c_last_triangle_score= 0.75f;
+static const float c_valence_boost_scale= 2.0f;
+static const float c_valence_boost_power= 0.5f;
+
+static const size_t c_not_in_cache= ~size_t(0u);
+
+static float GetVertexScore( const size_t cache_position, const size_t triangles_left )
+{
+	if( triangles_left == 0u )
+		return -1.0f; // Vertex is not used anymore.
+
+	float score= 0.0f;
+	if( cache_position != c_not_in_cache )
+	{
+		if( cache_position < 3u )
+			score= c_last_triangle_score; // Vertices of last triangle have fixed score, for prevention of strips generation.
+		else
+			score= std::pow( 1.0f - float( cache_position - 3u ) / float( c_cache_size - 3u ), c_cache_decay_power );
+	}
+
+	// Prefer vertices with small number of remaining triangles - finish them and remove from cache.
+	score+= c_valence_boost_scale * std::pow( float(triangles_left), -c_valence_boost_power );
+	return score;
+}
+
+std::vector<size_t> OptimizeTrianglesForVertexCache( std::vector<uint16_t>& indices, const size_t vertex_count )
+{
+	PM_ASSERT( indices.size() % 3u == 0u );
+	const size_t triangle_count= indices.size() / 3u;
+
+	// Triangles of each vertex. Triangles of vertex in range [ offset, offset + triangles_left ) are not added yet.
+	std::vector<size_t> vertex_triangles_offset( vertex_count + 1u, 0u );
+	for( const uint16_t index : indices )
+	{
+		PM_ASSERT( index < vertex_count );
+		++vertex_triangles_offset[ index + 1u ];
+	}
+	for( size_t v= 0u; v < vertex_count; ++v )
+		vertex_triangles_offset[v + 1u]+= vertex_triangles_offset[v];
+
+	std::vector<size_t> vertex_triangles_left( vertex_count, 0u );
+	std::vector<size_t> vertex_triangles( indices.size() );
+	for( size_t t= 0u; t < triangle_count; ++t )
+	for( size_t i= 0u; i < 3u; ++i )
+	{
+		const uint16_t v= indices[ t * 3u + i ];
+		vertex_triangles[ vertex_triangles_offset[v] + vertex_triangles_left[v] ]= t;
+		++vertex_triangles_left[v];
+	}
+
+	std::vector<size_t> vertex_cache_position( vertex_count, c_not_in_cache );
+	std::vector<float> vertex_score( vertex_count );
+	for( size_t v= 0u; v < vertex_count; ++v )
+		vertex_score[v]= GetVertexScore( c_not_in_cache, vertex_triangles_left[v] );
+
+	std::vector<bool> triangle_added( triangle_count, false );
+
+	std::vector<uint16_t> result_indices;
+	result_indices.reserve( indices.size() );
+
+	// Cache contains 3 extra slots for vertices of new triangle.
+	std::vector<uint16_t> cache, new_cache;
+	cache.reserve( c_cache_size + 3u );
+	new_cache.reserve( c_cache_size + 3u );
+
+	size_t best_triangle= triangle_count == 0u ? c_not_in_cache : 0u;
+	size_t first_not_added_triangle= 0u;
+	for( size_t iteration= 0u; iteration < triangle_count; ++iteration )
+	{
+		if( best_triangle == c_not_in_cache )
+		{
+			// No triangles with vertices in cache left. Start from first not added triangle.
+			while( triangle_added[first_not_added_triangle] )
+				++first_not_added_triangle;
+			best_triangle= first_not_added_triangle;
+		}
+
+		const uint16_t* const triangle_indices= indices.data() + best_triangle * 3u;
+		triangle_added[best_triangle]= true;
+		result_indices.insert( result_indices.end(), triangle_indices, triangle_indices + 3u );
+
+		// Remove triangle from lists of not added triangles of its vertices.
+		for( size_t i= 0u; i < 3u; ++i )
+		{
+			const uint16_t v= triangle_indices[i];
+			size_t* const triangles= vertex_triangles.data() + vertex_triangles_offset[v];
+			size_t* const triangles_end= triangles + vertex_triangles_left[v];
+			*std::find( triangles, triangles_end, best_triangle )= *( triangles_end - 1u );
+			--vertex_triangles_left[v];
+		}
+
+		// Move vertices of triangle to front of cache.
+		new_cache.clear();
+		new_cache.insert( new_cache.end(), triangle_indices, triangle_indices + 3u );
+		for( const uint16_t v : cache )
+			if( v != triangle_indices[0u] && v != triangle_indices[1u] && v != triangle_indices[2u] )
+				new_cache.push_back(v);
+		cache.swap( new_cache );
+
+		// Update scores of vertices in cache, including vertices, pushed out of cache.
+		for( size_t i= 0u; i < cache.size(); ++i )
+		{
+			const uint16_t v= cache[i];
+			vertex_cache_position[v]= i < c_cache_size ? i : c_not_in_cache;
+			vertex_score[v]= GetVertexScore( vertex_cache_position[v], vertex_triangles_left[v] );
+		}
+
+		// Update scores of triangles of vertices in cache, select best triangle.
+		best_triangle= c_not_in_cache;
+		float best_triangle_score= -1.0f;
+		for( const uint16_t v : cache )
+		{
+			for( size_t i= vertex_triangles_offset[v]; i < vertex_triangles_offset[v] + vertex_triangles_left[v]; ++i )
+			{
+				const size_t t= vertex_triangles[i];
+				const float triangle_score= vertex_score[ indices[t * 3u] ] + vertex_score[ indices[t * 3u + 1u] ] + vertex_score[ indices[t * 3u + 2u] ];
+				if( triangle_score > best_triangle_score )
+				{
+					best_triangle_score= triangle_score;
+					best_triangle= t;
+				}
+			}
+		}
+
+		if( cache.size() > c_cache_size )
+			cache.resize( c_cache_size );
+	}
+
+	// Renumber vertices in order of first usage.
+	std::vector<size_t> new_vertex_index( vertex_count, c_not_in_cache );
+	std::vector<size_t> vertices_order;
+	vertices_order.reserve( vertex_count );
+	for( uint16_t& index : result_indices )
+	{
+		if( new_vertex_index[index] == c_not_in_cache )
+		{
+			new_vertex_index[index]= vertices_order.size();
+			vertices_order.push_back( index );
+		}
+		index= static_cast<uint16_t>( new_vertex_index[index] );
+	}
+	// Unused vertices go to end.
+	for( size_t v= 0u; v < vertex_count; ++v )
+		if( new_vertex_index[v] == c_not_in_cache )
+			vertices_order.push_back(v);
+
+	indices.swap( result_indices );
+	return vertices_order;
+}
+
+} // namespace PanzerMaps
@@ -0,0 +1,15 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace PanzerMaps
+{
+
+// Reorder triangles for better usage of GPU post-transform vertex cache.
+// Uses Tom Forsyth's "Linear-Speed Vertex Cache Optimisation" algorithm.
+// After triangles reordering, vertices are renumbered in order of first usage, for better memory access locality.
+// Returns new order of vertices - old vertex index for each new vertex index.
+std::vector<size_t> OptimizeTrianglesForVertexCache( std::vector<uint16_t>& indices, size_t vertex_count );
+
+} // namespace PanzerMaps
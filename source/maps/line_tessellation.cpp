@@ -0,0 +1,446 @@
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+#include "../common/assert.hpp"
+#include "../common/coordinates_conversion.hpp"
+#include "../panzer_ogl_lib/vec.hpp"
+#include "line_tessellation.hpp"
+
+namespace PanzerMaps
+{
+
+static const float c_cos_plus_45 = +std::sqrt(0.5f);
+static const float c_sin_plus_45 = +std::sqrt(0.5f);
+static const float c_cos_minus_45= +std::sqrt(0.5f);
+static const float c_sin_minus_45= -std::sqrt(0.5f);
+// Extrusion vectors of line joins are not longer than 1 / sqrt(0.1), so, this scale fits into int16_t.
+static const float c_extrude_vector_scale= 8192.0f;
+// Positions of textured lines are stored with 8 bits of fraction.
+static const float c_position_fraction_scale= 256.0f;
+
+bool TextureShaderRequired( const DataFileDescription::LinearObjectStyle& style )
+{
+	return
+		std::memcmp( style.color, style.color2, sizeof(DataFileDescription::ColorRGBA) ) != 0 ||
+		( style.texture_width > 0u && style.texture_height > 0u );
+}
+
+void SimplifyLine( std::vector<DataFileDescription::ChunkVertex>& line, const float suqare_half_width )
+{
+	// TODO - fix equal points in source data.
+	PM_ASSERT( line.size() >= 1u );
+
+	const int32_t square_half_width_int= std::max( 1, int32_t(suqare_half_width) );
+	const auto last_vertex= line.back();
+
+	line.erase(
+		std::unique(
+			line.begin(), line.end(),
+			[square_half_width_int]( const DataFileDescription::ChunkVertex& v0, const DataFileDescription::ChunkVertex& v1 ) -> bool
+			{
+				//return v0 == v1;
+				const int32_t dx= int32_t(v1.x) - int32_t(v0.x);
+				const int32_t dy= int32_t(v1.y) - int32_t(v0.y);
+				return dx * dx + dy * dy < square_half_width_int;
+			}),
+		line.end() );
+
+	// keep last vertex.
+	const int32_t dx= int32_t(last_vertex.x) - int32_t(line.back().x);
+	const int32_t dy= int32_t(last_vertex.y) - int32_t(line.back().y);
+	const int32_t square_dist= dx * dx + dy * dy;
+	if( square_dist != 0 && square_dist < square_half_width_int )
+	{
+		if( line.size() <= 1u )
+			line.push_back(last_vertex);
+		else
+			line.back()= last_vertex;
+	}
+}
+
+static void PackFixedCoord( const float coord, uint16_t& out_integer_part, uint8_t& out_fraction )
+{
+	// Clamp to chunk coordinates range. Chunks have border, wider, than usual line width, so, clamping is rare.
+	const int32_t fixed= static_cast<int32_t>( std::max( 0.0f, std::min( std::round( coord * c_position_fraction_scale ), 65536.0f * c_position_fraction_scale - 1.0f ) ) );
+	out_integer_part= static_cast<uint16_t>( fixed >> 8 );
+	out_fraction= static_cast<uint8_t>( fixed & 255 );
+}
+
+template< class VertexType >
+VertexType MakeLineVertex( const m_Vec2& vert, const m_Vec2& shift, uint8_t color_index, float tex_coord_x, float tex_coord_y );
+
+template<>
+PolygonalLinearObjectVertex MakeLineVertex<PolygonalLinearObjectVertex>( const m_Vec2& vert, const m_Vec2& shift, const uint8_t color_index, const float tex_coord_x, const float tex_coord_y )
+{
+	(void)color_index;
+	PolygonalLinearObjectVertex result;
+	PackFixedCoord( vert.x + shift.x, result.xy[0], result.xy_fraction[0] );
+	PackFixedCoord( vert.y + shift.y, result.xy[1], result.xy_fraction[1] );
+	result.tex_coord_x= static_cast<uint16_t>( std::round( std::max( 0.0f, std::min( tex_coord_x, 1.0f ) ) * 65535.0f ) );
+	result.tex_coord_y= tex_coord_y;
+	return result;
+}
+
+template<>
+ExtrudedLinearObjectVertex MakeLineVertex<ExtrudedLinearObjectVertex>( const m_Vec2& vert, const m_Vec2& shift, const uint8_t color_index, const float tex_coord_x, const float tex_coord_y )
+{
+	(void)tex_coord_x;
+	(void)tex_coord_y;
+	ExtrudedLinearObjectVertex result;
+	result.xy[0]= static_cast<uint16_t>(vert.x);
+	result.xy[1]= static_cast<uint16_t>(vert.y);
+	result.extrude[0]= static_cast<int16_t>( std::max( -32767.0f, std::min( std::round( shift.x * c_extrude_vector_scale ), 32767.0f ) ) );
+	result.extrude[1]= static_cast<int16_t>( std::max( -32767.0f, std::min( std::round( shift.y * c_extrude_vector_scale ), 32767.0f ) ) );
+	result.color_index= color_index;
+	result.reserved[0]= result.reserved[1]= result.reserved[2]= 0u;
+	return result;
+}
+
+// Maximum distance between rounded join and its polygonal approximation.
+static const float c_max_join_rounding_error_pixels= 0.25f;
+static const float c_min_pixel_half_width_for_rounding= 0.5f;
+
+static float GetJoinRoundingAngle( const float pixel_half_width )
+{
+	const float c_min_rounding_angle= float(Constants::pi / 5.0);
+	if( pixel_half_width < c_min_pixel_half_width_for_rounding )
+		return float(Constants::pi); // Never round joins.
+
+	const float angle= 2.0f * std::acos( std::max( 0.0f, 1.0f - c_max_join_rounding_error_pixels / pixel_half_width ) );
+	return std::max( c_min_rounding_angle, angle );
+}
+
+// Calculates normals and lengths of edges between adjacent vertices.
+// Four edges are processed at once with SSE2 or AArch64 NEON, rest edges (or all edges on other platforms) - with scalar code.
+static void CalculateEdgesNormals(
+	const DataFileDescription::ChunkVertex* const in_vertices,
+	const size_t edge_count,
+	float* const out_normals_x,
+	float* const out_normals_y,
+	float* const out_lengths )
+{
+	static_assert( sizeof(DataFileDescription::ChunkVertex) == sizeof(uint16_t) * 2u, "unexpected vertex layout" );
+
+	size_t i= 0u;
+#if defined(__SSE2__)
+	const __m128i low_mask= _mm_set1_epi32( 0xFFFF );
+	for( ; i + 4u <= edge_count; i+= 4u )
+	{
+		// Vertices are pairs of 16-bit x and y. Split them into 32-bit x and y.
+		const __m128i v0= _mm_loadu_si128( reinterpret_cast<const __m128i*>( in_vertices + i ) );
+		const __m128i v1= _mm_loadu_si128( reinterpret_cast<const __m128i*>( in_vertices + i + 1u ) );
+		const __m128 dx= _mm_sub_ps( _mm_cvtepi32_ps( _mm_and_si128( v1, low_mask ) ), _mm_cvtepi32_ps( _mm_and_si128( v0, low_mask ) ) );
+		const __m128 dy= _mm_sub_ps( _mm_cvtepi32_ps( _mm_srli_epi32( v1, 16 ) ), _mm_cvtepi32_ps( _mm_srli_epi32( v0, 16 ) ) );
+		const __m128 length= _mm_sqrt_ps( _mm_add_ps( _mm_mul_ps( dx, dx ), _mm_mul_ps( dy, dy ) ) );
+		const __m128 inv_length= _mm_div_ps( _mm_set1_ps( 1.0f ), length );
+		_mm_storeu_ps( out_lengths + i, length );
+		_mm_storeu_ps( out_normals_x + i, _mm_mul_ps( dy, inv_length ) );
+		_mm_storeu_ps( out_normals_y + i, _mm_sub_ps( _mm_setzero_ps(), _mm_mul_ps( dx, inv_length ) ) );
+	}
+#elif defined(__aarch64__)
+	for( ; i + 4u <= edge_count; i+= 4u )
+	{
+		// Load with deinterleaving of x and y.
+		const uint16x4x2_t v0= vld2_u16( reinterpret_cast<const uint16_t*>( in_vertices + i ) );
+		const uint16x4x2_t v1= vld2_u16( reinterpret_cast<const uint16_t*>( in_vertices + i + 1u ) );
+		const float32x4_t dx= vsubq_f32( vcvtq_f32_u32( vmovl_u16( v1.val[0] ) ), vcvtq_f32_u32( vmovl_u16( v0.val[0] ) ) );
+		const float32x4_t dy= vsubq_f32( vcvtq_f32_u32( vmovl_u16( v1.val[1] ) ), vcvtq_f32_u32( vmovl_u16( v0.val[1] ) ) );
+		const float32x4_t length= vsqrtq_f32( vaddq_f32( vmulq_f32( dx, dx ), vmulq_f32( dy, dy ) ) );
+		const float32x4_t inv_length= vdivq_f32( vdupq_n_f32( 1.0f ), length );
+		vst1q_f32( out_lengths + i, length );
+		vst1q_f32( out_normals_x + i, vmulq_f32( dy, inv_length ) );
+		vst1q_f32( out_normals_y + i, vnegq_f32( vmulq_f32( dx, inv_length ) ) );
+	}
+#endif
+	for( ; i < edge_count; ++i )
+	{
+		const float dx= float(in_vertices[i+1u].x) - float(in_vertices[i].x);
+		const float dy= float(in_vertices[i+1u].y) - float(in_vertices[i].y);
+		const float length= std::sqrt( dx * dx + dy * dy );
+		const float inv_length= 1.0f / length;
+		out_lengths[i]= length;
+		out_normals_x[i]= dy * inv_length;
+		out_normals_y[i]= -dx * inv_length;
+	}
+}
+
+// Grow vectors geometrically, because reserving of exact size for each line causes reallocation for each line.
+template< class T >
+static void ReserveAdditional( std::vector<T>& v, const size_t additional_size )
+{
+	const size_t required_size= v.size() + additional_size;
+	if( required_size > v.capacity() )
+		v.reserve( std::max( required_size, v.capacity() * 2u ) );
+}
+
+// Creates triangle strip mesh.
+// For extruded vertices half width must be 1, real width is applied in shader.
+template< bool generate_2d_tex_coord, class VertexType >
+static void CreatePolygonalLineImpl(
+	const DataFileDescription::ChunkVertex* const in_vertices,
+	const size_t vertex_count,
+	const uint8_t color_index,
+	const float half_width,
+	const float pixel_half_width,
+	const float tex_coord_scale,
+	LineTessellationCache& cache,
+	std::vector<VertexType>& out_vertices,
+	std::vector<VertexIndex>& out_indices )
+{
+	PM_ASSERT( vertex_count != 0u );
+
+	// Each vertex produces two vertices, if join is not rounded. Caps produce 3 vertices each.
+	ReserveAdditional( out_vertices, vertex_count * 2u + 6u );
+	ReserveAdditional( out_indices, vertex_count * 2u + 6u + 1u );
+
+	// Caps and rounded joins of lines, thinner than pixel, are not visible.
+	const bool draw_caps= pixel_half_width >= c_min_pixel_half_width_for_rounding;
+	if( pixel_half_width != cache.join_rounding_pixel_half_width )
+	{
+		const float rounding_angle= GetJoinRoundingAngle( pixel_half_width );
+		cache.join_rounding_pixel_half_width= pixel_half_width;
+		cache.join_rounding_angle_cos= std::cos(rounding_angle);
+		cache.join_rounding_angle_sin= std::sin(rounding_angle);
+		cache.join_rounding_max_steps= size_t( std::ceil( float(Constants::pi) / rounding_angle ) );
+	}
+	const float rounding_angle_cos= cache.join_rounding_angle_cos;
+
+	const auto make_vertex=
+	[color_index]( const m_Vec2& vert, const m_Vec2& shift, const float tex_coord_x, const float tex_coord_y ) -> VertexType
+	{
+		return MakeLineVertex<VertexType>( vert, shift, color_index, tex_coord_x, tex_coord_y );
+	};
+
+	// Texture coordinates are ignored for extruded vertices.
+	const float tex_coord_left= 0.0f, tex_coord_lefter= 0.25f, tex_coord_center= 0.5f, tex_coord_righter= 0.75f, tex_coord_right= 1.0f;
+	const float cup_tex_coord_add= generate_2d_tex_coord ? 0.5f * half_width * tex_coord_scale : 0.0f;
+	float tex_coord_y= 0.0f;
+
+	if( vertex_count == 1u )
+	{
+		// Line was too simplifyed, draw only caps.
+		if( !draw_caps )
+			return;
+
+		const m_Vec2 vert( float(in_vertices[0u].x), float(in_vertices[0u].y) );
+		const m_Vec2 edge_shift( 0.0f, half_width );
+
+		// Cup0
+		out_indices.push_back( static_cast<VertexIndex>(out_vertices.size()) );
+		out_vertices.push_back(
+			make_vertex( vert, m_Vec2( edge_shift.y, -edge_shift.x ), tex_coord_center, tex_coord_y ) );
+		tex_coord_y+= cup_tex_coord_add;
+		out_indices.push_back( static_cast<VertexIndex>(out_vertices.size()) );
+		out_vertices.push_back(
+			make_vertex( vert, m_Vec2( edge_shift.x * c_cos_minus_45 - edge_shift.y * c_sin_minus_45, edge_shift.x * c_sin_minus_45 + edge_shift.y * c_cos_minus_45 ), tex_coord_lefter, tex_coord_y ) );
+		out_indices.push_back( static_cast<VertexIndex>(out_vertices.size()) );
+		out_vertices.push_back(
+			make_vertex( vert, m_Vec2( -edge_shift.x * c_cos_plus_45 + edge_shift.y * c_sin_plus_45, -edge_shift.x * c_sin_plus_45 - edge_shift.y * c_cos_plus_45 ), tex_coord_righter, tex_coord_y ) );
+		// Center.
+		tex_coord_y+= cup_tex_coord_add;
+		out_indices.push_back( static_cast<VertexIndex>(out_vertices.size()) );
+		out_vertices.push_back(
+			make_vertex( vert, m_Vec2( edge_shift.x, edge_shift.y ), tex_coord_left, tex_coord_y ) );
+		out_indices.push_back( static_cast<VertexIndex>(out_vertices.size()) );
+		out_vertices.push_back(
+			make_vertex( vert, m_Vec2( -edge_shift.x, -edge_shift.y ), tex_coord_right, tex_coord_y ) );
+		// Cup1
+		tex_coord_y+= cup_tex_coord_add;
+		out_indices.push_back( static_cast<VertexIndex>(out_vertices.size()) );
+		out_vertices.push_back(
+			make_vertex( vert, m_Vec2( edge_shift.x * c_cos_plus_45 - edge_shift.y * c_sin_plus_45, edge_shift.x * c_sin_plus_45 + edge_shift.y * c_cos_plus_45 ), tex_coord_lefter, tex_coord_y ) );
+		out_indices.push_back( static_cast<VertexIndex>(out_vertices.size()) );
+		out_vertices.push_back(
+			make_vertex( vert, m_Vec2( -edge_shift.x * c_cos_minus_45 + edge_shift.y * c_sin_minus_45, -edge_shift.x * c_sin_minus_45 - edge_shift.y * c_cos_minus_45 ), tex_coord_righter, tex_coord_y ) );
+		tex_coord_y+= cup_tex_coord_add;
+		out_indices.push_back( static_cast<VertexIndex>(out_vertices.size()) );
+		out_vertices.push_back(
+			make_vertex( vert, m_Vec2( -edge_shift.y, edge_shift.x ), tex_coord_center, tex_coord_y ) );
+
+		out_indices.push_back( c_primitive_restart_index );
+		return;
+	}
+
+	// Calculate normals of all edges at once, before vertices generation.
+	const size_t edge_count= vertex_count - 1u;
+	cache.edge_normals_x.resize( edge_count );
+	cache.edge_normals_y.resize( edge_count );
+	cache.edge_lengths.resize( edge_count );
+	const float* const edge_normals_x= cache.edge_normals_x.data();
+	const float* const edge_normals_y= cache.edge_normals_y.data();
+	const float* const edge_lengths= cache.edge_lengths.data();
+	CalculateEdgesNormals( in_vertices, edge_count, cache.edge_normals_x.data(), cache.edge_normals_y.data(), cache.edge_lengths.data() );
+
+	// Use float coordinates, because uint16_t is too low for polygonal lines with small width.
+	m_Vec2 prev_edge_base_vec;
+	{
+		const m_Vec2 vert0( float(in_vertices[0u].x), float(in_vertices[0u].y) );
+
+		const float edge_length= edge_lengths[0u];
+		PM_ASSERT( edge_length > 0.0f );
+		const m_Vec2 edge_base_vec( edge_normals_x[0u], edge_normals_y[0u] );
+
+		const m_Vec2 edge_shift= edge_base_vec * half_width;
+
+		if( draw_caps )
+		{
+			// Cup.
+			out_indices.push_back( static_cast<VertexIndex>(out_vertices.size()) );
+			out_vertices.push_back(
+				make_vertex( vert0, m_Vec2( edge_shift.y, -edge_shift.x ), tex_coord_center, tex_coord_y ) );
+			tex_coord_y+= cup_tex_coord_add;
+			out_indices.push_back( static_cast<VertexIndex>(out_vertices.size()) );
+			out_vertices.push_back(
+				make_vertex( vert0, m_Vec2( edge_shift.x * c_cos_minus_45 - edge_shift.y * c_sin_minus_45, edge_shift.x * c_sin_minus_45 + edge_shift.y * c_cos_minus_45 ), tex_coord_lefter, tex_coord_y ) );
+			out_indices.push_back( static_cast<VertexIndex>(out_vertices.size()) );
+			out_vertices.push_back(
+				make_vertex( vert0, m_Vec2( -edge_shift.x * c_cos_plus_45 + edge_shift.y * c_sin_plus_45, -edge_shift.x * c_sin_plus_45 - edge_shift.y * c_cos_plus_45 ), tex_coord_righter, tex_coord_y ) );
+		}
+
+		// Start of line.
+		tex_coord_y+= cup_tex_coord_add;
+		out_indices.push_back( static_cast<VertexIndex>(out_vertices.size()) );
+		out_vertices.push_back(
+			make_vertex( vert0, m_Vec2( edge_shift.x, edge_shift.y ), tex_coord_left, tex_coord_y ) );
+		out_indices.push_back( static_cast<VertexIndex>(out_vertices.size()) );
+		out_vertices.push_back(
+			make_vertex( vert0, m_Vec2( -edge_shift.x, -edge_shift.y ), tex_coord_right, tex_coord_y ) );
+
+		prev_edge_base_vec= edge_base_vec;
+		if( generate_2d_tex_coord )
+			tex_coord_y+= edge_length * tex_coord_scale;
+	}
+
+	for( size_t i= 1u; i < vertex_count - 1u; ++i )
+	{
+		const m_Vec2 vert( float(in_vertices[i].x), float(in_vertices[i].y) );
+		const float edge_length= edge_lengths[i];
+		PM_ASSERT( edge_length > 0.0f );
+		const m_Vec2 edge_base_vec( edge_normals_x[i], edge_normals_y[i] );
+
+		const m_Vec2 vertex_base_vec= ( prev_edge_base_vec + edge_base_vec ) * 0.5f;
+		const float vertex_base_vec_inv_square_len= 1.0f / std::max( 0.1f, vertex_base_vec.SquareLength() );
+
+		const float edges_dir_dot= prev_edge_base_vec * edge_base_vec;
+
+		if( edges_dir_dot >= rounding_angle_cos )
+		{
+			const m_Vec2 vertex_shift= vertex_base_vec * ( half_width * vertex_base_vec_inv_square_len );
+
+			out_indices.push_back( static_cast<VertexIndex>(out_vertices.size()) );
+			out_vertices.push_back(
+				make_vertex( vert, m_Vec2( vertex_shift.x, vertex_shift.y ), tex_coord_left, tex_coord_y ) );
+			out_indices.push_back( static_cast<VertexIndex>(out_vertices.size()) );
+			out_vertices.push_back(
+				make_vertex( vert, m_Vec2( -vertex_shift.x, -vertex_shift.y ), tex_coord_right, tex_coord_y ) );
+		}
+		else
+		{
+			const float sign= mVec2Cross( prev_edge_base_vec, edge_base_vec ) > 0.0f ? 1.0f : -1.0f;
+
+			const VertexIndex corner_vertex_index= static_cast<VertexIndex>(out_vertices.size());
+			out_vertices.push_back(
+				make_vertex( vert, m_Vec2( -vertex_base_vec.x * ( half_width * vertex_base_vec_inv_square_len * sign ), -vertex_base_vec.y * ( half_width * vertex_base_vec_inv_square_len * sign ) ), sign > 0.0f ? tex_coord_right : tex_coord_left, tex_coord_y ) );
+
+			const auto add_rounding_vertex=
+			[&]( const m_Vec2& vertex_shift )
+			{
+				// Create one normal and one degenerated triangle.
+				if( sign > 0.0f )
+				{
+					out_indices.push_back( static_cast<VertexIndex>(out_vertices.size()) );
+					out_indices.push_back( corner_vertex_index );
+				}
+				else
+				{
+					out_indices.push_back( corner_vertex_index );
+					out_indices.push_back( static_cast<VertexIndex>(out_vertices.size()) );
+				}
+				out_vertices.push_back(
+					make_vertex( vert, vertex_shift, sign > 0.0f ? tex_coord_left : tex_coord_right, tex_coord_y ) );
+			};
+
+			// Rotate direction by rounding angle step by step, until rest angle is less, than step.
+			// Rotation is same for all joins of line, so, there is no need to calculate angle of join and sin/cos of it.
+			const float step_cos= cache.join_rounding_angle_cos;
+			const float step_sin= cache.join_rounding_angle_sin * sign;
+			ReserveAdditional( out_vertices, cache.join_rounding_max_steps + 1u );
+			ReserveAdditional( out_indices, cache.join_rounding_max_steps * 2u + 2u );
+			m_Vec2 direction= prev_edge_base_vec;
+			for( size_t step= 0u; step < cache.join_rounding_max_steps && direction * edge_base_vec < rounding_angle_cos; ++step )
+			{
+				add_rounding_vertex( direction * ( half_width * sign ) );
+				direction=
+					m_Vec2(
+						direction.x * step_cos - direction.y * step_sin,
+						direction.x * step_sin + direction.y * step_cos );
+			}
+			add_rounding_vertex( edge_base_vec * ( half_width * sign ) );
+		}
+		prev_edge_base_vec= edge_base_vec;
+		if( generate_2d_tex_coord )
+			tex_coord_y+= edge_length * tex_coord_scale;
+	}
+
+	{
+		const m_Vec2 vert_last( float(in_vertices[vertex_count-1u].x), float(in_vertices[vertex_count-1u].y) );
+		const m_Vec2 edge_shift= prev_edge_base_vec * half_width;
+
+		// End of line
+		out_indices.push_back( static_cast<VertexIndex>(out_vertices.size()) );
+		out_vertices.push_back(
+			make_vertex( vert_last, m_Vec2( edge_shift.x, edge_shift.y ), tex_coord_left, tex_coord_y ) );
+		out_indices.push_back( static_cast<VertexIndex>(out_vertices.size()) );
+		out_vertices.push_back(
+			make_vertex( vert_last, m_Vec2( -edge_shift.x, -edge_shift.y ), tex_coord_right, tex_coord_y ) );
+
+		if( draw_caps )
+		{
+			// Cup.
+			tex_coord_y+= cup_tex_coord_add;
+			out_indices.push_back( static_cast<VertexIndex>(out_vertices.size()) );
+			out_vertices.push_back(
+				make_vertex( vert_last, m_Vec2( edge_shift.x * c_cos_plus_45 - edge_shift.y * c_sin_plus_45, edge_shift.x * c_sin_plus_45 + edge_shift.y * c_cos_plus_45 ), tex_coord_lefter, tex_coord_y ) );
+			out_indices.push_back( static_cast<VertexIndex>(out_vertices.size()) );
+			out_vertices.push_back(
+				make_vertex( vert_last, m_Vec2( -edge_shift.x * c_cos_minus_45 + edge_shift.y * c_sin_minus_45, -edge_shift.x * c_sin_minus_45 - edge_shift.y * c_cos_minus_45 ), tex_coord_righter, tex_coord_y ) );
+			tex_coord_y+= cup_tex_coord_add;
+			out_indices.push_back( static_cast<VertexIndex>(out_vertices.size()) );
+			out_vertices.push_back(
+				make_vertex( vert_last, m_Vec2( -edge_shift.y, edge_shift.x ), tex_coord_center, tex_coord_y ) );
+		}
+	}
+	out_indices.push_back( c_primitive_restart_index );
+}
+
+void CreateTexturedPolygonalLine(
+	const DataFileDescription::ChunkVertex* const in_vertices,
+	const size_t vertex_count,
+	const float half_width,
+	const float pixel_half_width,
+	const float tex_coord_scale,
+	LineTessellationCache& cache,
+	std::vector<PolygonalLinearObjectVertex>& out_vertices,
+	std::vector<VertexIndex>& out_indices )
+{
+	CreatePolygonalLineImpl<true>( in_vertices, vertex_count, uint8_t(0u), half_width, pixel_half_width, tex_coord_scale, cache, out_vertices, out_indices );
+}
+
+void CreateExtrudedPolygonalLine(
+	const DataFileDescription::ChunkVertex* const in_vertices,
+	const size_t vertex_count,
+	const uint8_t color_index,
+	const float pixel_half_width,
+	LineTessellationCache& cache,
+	std::vector<ExtrudedLinearObjectVertex>& out_vertices,
+	std::vector<VertexIndex>& out_indices )
+{
+	CreatePolygonalLineImpl<false>( in_vertices, vertex_count, color_index, 1.0f, pixel_half_width, 0.0f, cache, out_vertices, out_indices );
+}
+
+} // namespace PanzerMaps
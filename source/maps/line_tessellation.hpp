@@ -0,0 +1,85 @@
+#pragma once
+#include <cstdint>
+#include <limits>
+#include <vector>
+#include "../common/data_file.hpp"
+
+namespace PanzerMaps
+{
+
+// Tessellation of wide lines into triangle strips.
+// Functions here are pure - they do not require OpenGL context and may be called from any thread.
+
+// Indices are always produced as 32-bit.
+// Maps with 16-bit indices have chunks with less, than 65535 vertices, so, such indices may be packed into 16 bit before uploading to GPU.
+using VertexIndex= uint32_t;
+
+const VertexIndex c_primitive_restart_index= std::numeric_limits<VertexIndex>::max();
+
+// Vertex of textured wide line, extruded on CPU.
+struct PolygonalLinearObjectVertex
+{
+	// Fixed point position - integer part and 1/256 fraction, because thin lines need sub-unit precision.
+	uint16_t xy[2];
+	uint8_t xy_fraction[2];
+	// Perpendicular to line, normalized.
+	uint16_t tex_coord_x;
+	// Parallel to line. Float, because it grows along whole line.
+	float tex_coord_y;
+};
+static_assert( sizeof(PolygonalLinearObjectVertex) == 12u, "wrong size" );
+
+// Vertex of wide line, extruded in vertex shader.
+// Contains centerline point and extrusion vector in units of line half width, so, mesh does not depend on line width.
+struct ExtrudedLinearObjectVertex
+{
+	uint16_t xy[2];
+	// 16-bit, because 8-bit vector gives visible wobble of edges of very wide lines.
+	int16_t extrude[2];
+	uint8_t color_index;
+	uint8_t reserved[3];
+};
+static_assert( sizeof(ExtrudedLinearObjectVertex) == 12u, "wrong size" );
+
+// Temporary data of tessellation. Reuse it for many lines, for prevention of memory allocations.
+struct LineTessellationCache
+{
+	std::vector<float> edge_normals_x;
+	std::vector<float> edge_normals_y;
+	std::vector<float> edge_lengths;
+	// Rotation of rounded joins step. Depends only on pixel width of line, so, it is recalculated only if width is changed.
+	float join_rounding_pixel_half_width= -1.0f;
+	float join_rounding_angle_cos= 1.0f;
+	float join_rounding_angle_sin= 0.0f;
+	size_t join_rounding_max_steps= 0u;
+};
+
+// Returns true, if line with this style is drawn with texture - with two colors or with dashes.
+bool TextureShaderRequired( const DataFileDescription::LinearObjectStyle& style );
+
+// Removes vertices, closer to previous vertex, than half width. Keeps last vertex.
+void SimplifyLine( std::vector<DataFileDescription::ChunkVertex>& line, float suqare_half_width );
+
+// Lines are appended to output, separated by primitive restart index.
+// "pixel_half_width" selects detail of caps and joins.
+
+void CreateTexturedPolygonalLine(
+	const DataFileDescription::ChunkVertex* in_vertices,
+	size_t vertex_count,
+	float half_width,
+	float pixel_half_width,
+	float tex_coord_scale,
+	LineTessellationCache& cache,
+	std::vector<PolygonalLinearObjectVertex>& out_vertices,
+	std::vector<VertexIndex>& out_indices );
+
+void CreateExtrudedPolygonalLine(
+	const DataFileDescription::ChunkVertex* in_vertices,
+	size_t vertex_count,
+	uint8_t color_index,
+	float pixel_half_width,
+	LineTessellationCache& cache,
+	std::vector<ExtrudedLinearObjectVertex>& out_vertices,
+	std::vector<VertexIndex>& out_indices );
+
+} // namespace PanzerMaps
@@ -1,9 +1,13 @@
 ﻿#include <algorithm>
+#include <cmath>
+#include <cstdlib>
 #include <cstring>
 #include <unordered_map>
 #include "../common/assert.hpp"
 #include "../common/data_file.hpp"
 #include "../common/log.hpp"
+#include "line_tessellation.hpp"
+#include "polygon_buffer_pool.hpp"
 #include "shaders.hpp"
 #include "textures_generation.hpp"
 #include "ui_common.hpp"
@@ -12,421 +16,335 @@
 namespace PanzerMaps
 {
 
+// Style index is 8-bit, so, pack it together with position.
+// Keep stride 8 bytes, because 6-byte vertices are not 4-byte aligned and may be slow on some GPUs.
+// 4-byte vertex is not possible here - chunk coordinates use all 16 bits, so, there is no room for style index.
+// Per-draw style is not used too, because adjacent groups with different styles are merged into one draw call.
+
 struct PointObjectVertex
 {
 	uint16_t xy[2];
-	uint32_t color_index;
+	uint8_t color_index;
+	uint8_t reserved[3];
 };
+static_assert( sizeof(PointObjectVertex) == 8u, "wrong size" );
 
 struct LinearObjectVertex
 {
 	uint16_t xy[2];
-	// For regular linex x is color index, y - unused
-	// For textured lines y - parallel to line, x - perpendicular.
-	uint16_t tex_coord[2];
-};
-
-struct PolygonalLinearObjectVertex
-{
-	float xy[2];
-
-	// For regular linex x is color index, y - unused
-	// For textured lines y - parallel to line, x - perpendicular.
-	float tex_coord[2];
+	uint8_t color_index;
+	uint8_t reserved[3];
 };
+static_assert( sizeof(LinearObjectVertex) == 8u, "wrong size" );
 
 struct ArealObjectVertex
 {
 	uint16_t xy[2];
-	uint32_t color_index;
+	uint8_t color_index;
+	uint8_t reserved[3];
 };
+static_assert( sizeof(ArealObjectVertex) == 8u, "wrong size" );
 
-static const uint16_t c_primitive_restart_index= 65535u;
-static const float c_cos_plus_45 = +std::sqrt(0.5f);
-static const float c_sin_plus_45 = +std::sqrt(0.5f);
-static const float c_cos_minus_45= +std::sqrt(0.5f);
-static const float c_sin_minus_45= -std::sqrt(0.5f);
-
-static void SimplifyLine( std::vector<DataFileDescription::ChunkVertex>& line, const float suqare_half_width )
+// GPU index type is selected by map file. Indices are built as 32-bit and packed, if map file requires only 16-bit indices.
+static GLenum GetVertexIndexType( const size_t vertex_index_size )
 {
-	// TODO - fix equal points in source data.
-	PM_ASSERT( line.size() >= 1u );
+	return vertex_index_size == sizeof(uint16_t) ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+}
 
-	const int32_t square_half_width_int= std::max( 1, int32_t(suqare_half_width) );
-	const auto last_vertex= line.back();
+static uint32_t GetPrimitiveRestartIndex( const size_t vertex_index_size )
+{
+	return vertex_index_size == sizeof(uint16_t) ? 65535u : c_primitive_restart_index;
+}
 
-	line.erase(
-		std::unique(
-			line.begin(), line.end(),
-			[square_half_width_int]( const DataFileDescription::ChunkVertex& v0, const DataFileDescription::ChunkVertex& v1 ) -> bool
-			{
-				//return v0 == v1;
-				const int32_t dx= int32_t(v1.x) - int32_t(v0.x);
-				const int32_t dy= int32_t(v1.y) - int32_t(v0.y);
-				return dx * dx + dy * dy < square_half_width_int;
-			}),
-		line.end() );
-
-	// keep last vertex.
-	const int32_t dx= int32_t(last_vertex.x) - int32_t(line.back().x);
-	const int32_t dy= int32_t(last_vertex.y) - int32_t(line.back().y);
-	const int32_t square_dist= dx * dx + dy * dy;
-	if( square_dist != 0 && square_dist < square_half_width_int )
+// Converts indices into 16-bit in place. Result is placed at start of vector storage, vector size is not changed.
+static void PackIndicesTo16Bit( std::vector<VertexIndex>& indices )
+{
+	unsigned char* const dst= reinterpret_cast<unsigned char*>( indices.data() );
+	for( size_t i= 0u; i < indices.size(); ++i )
 	{
-		if( line.size() <= 1u )
-			line.push_back(last_vertex);
-		else
-			line.back()= last_vertex;
+		PM_ASSERT( indices[i] == c_primitive_restart_index || indices[i] < 65535u );
+		// Primitive restart index is converted into 16-bit restart index.
+		const uint16_t index= static_cast<uint16_t>( indices[i] );
+		std::memcpy( dst + i * sizeof(uint16_t), &index, sizeof(uint16_t) );
 	}
 }
 
-// Creates triangle strip mesh.
-template< bool generate_2d_tex_coord >
-void CreatePolygonalLine(
-	const DataFileDescription::ChunkVertex* const in_vertices,
-	const size_t vertex_count,
-	const uint32_t color_index,
-	const float half_width,
-	const float tex_coord_scale,
-	std::vector<PolygonalLinearObjectVertex>& out_vertices,
-	std::vector<uint16_t>& out_indices )
+struct MapDrawer::BufferPools
 {
-	PM_ASSERT( vertex_count != 0u );
+	BufferPools( const size_t max_free_size_per_pool, const GLenum vertex_index_type )
+		: point_objects(
+			sizeof(PointObjectVertex), 0u, GL_POINTS,
+			[]( r_PolygonBuffer& buffer )
+			{
+				buffer.VertexAttribPointer( 0, 2, GL_UNSIGNED_SHORT, false, 0 );
+				buffer.VertexAttribPointer( 1, 1, GL_UNSIGNED_BYTE, false, sizeof(uint16_t) * 2 );
+			},
+			max_free_size_per_pool )
+		, linear_objects(
+			sizeof(LinearObjectVertex), vertex_index_type, GL_LINE_STRIP,
+			[]( r_PolygonBuffer& buffer )
+			{
+				buffer.VertexAttribPointer( 0, 2, GL_UNSIGNED_SHORT, false, 0 );
+				buffer.VertexAttribPointer( 1, 1, GL_UNSIGNED_BYTE, false, sizeof(uint16_t) * 2 );
+			},
+			max_free_size_per_pool )
+		, linear_objects_as_triangles(
+			sizeof(PolygonalLinearObjectVertex), vertex_index_type, GL_TRIANGLE_STRIP,
+			[]( r_PolygonBuffer& buffer )
+			{
+				buffer.VertexAttribPointer( 0, 2, GL_UNSIGNED_SHORT, false, 0 );
+				buffer.VertexAttribPointer( 1, 2, GL_UNSIGNED_BYTE, false, sizeof(uint16_t) * 2 );
+				buffer.VertexAttribPointer( 2, 1, GL_UNSIGNED_SHORT, true, sizeof(uint16_t) * 2 + sizeof(uint8_t) * 2 );
+				buffer.VertexAttribPointer( 3, 1, GL_FLOAT, false, sizeof(uint16_t) * 3 + sizeof(uint8_t) * 2 );
+			},
+			max_free_size_per_pool )
+		, linear_objects_extruded(
+			sizeof(ExtrudedLinearObjectVertex), vertex_index_type, GL_TRIANGLE_STRIP,
+			[]( r_PolygonBuffer& buffer )
+			{
+				buffer.VertexAttribPointer( 0, 2, GL_UNSIGNED_SHORT, false, 0 );
+				buffer.VertexAttribPointer( 1, 2, GL_SHORT, false, sizeof(uint16_t) * 2 );
+				buffer.VertexAttribPointer( 2, 1, GL_UNSIGNED_BYTE, false, sizeof(uint16_t) * 2 + sizeof(int16_t) * 2 );
+			},
+			max_free_size_per_pool )
+		, areal_objects(
+			sizeof(ArealObjectVertex), vertex_index_type, GL_TRIANGLES,
+			[]( r_PolygonBuffer& buffer )
+			{
+				buffer.VertexAttribPointer( 0, 2, GL_UNSIGNED_SHORT, false, 0 );
+				buffer.VertexAttribPointer( 1, 1, GL_UNSIGNED_BYTE, false, sizeof(uint16_t) * 2 );
+			},
+			max_free_size_per_pool )
+	{}
 
-	float tex_coord_y= 0.0f, cup_tex_coord_add, tex_coord_left, tex_coord_lefter, tex_coord_center, tex_coord_right, tex_coord_righter;
-	if( generate_2d_tex_coord )
+	void SetMaxFreeSizePerPool( const size_t max_free_size_per_pool )
 	{
-		tex_coord_left= 0.0f;
-		tex_coord_lefter= 0.25f;
-		tex_coord_center= 0.5f;
-		tex_coord_righter= 0.75f;
-		tex_coord_right= 1.0f;
-		cup_tex_coord_add= 0.5f * half_width * tex_coord_scale;
+		point_objects.SetMaxFreeSize( max_free_size_per_pool );
+		linear_objects.SetMaxFreeSize( max_free_size_per_pool );
+		linear_objects_as_triangles.SetMaxFreeSize( max_free_size_per_pool );
+		linear_objects_extruded.SetMaxFreeSize( max_free_size_per_pool );
+		areal_objects.SetMaxFreeSize( max_free_size_per_pool );
 	}
-	else
+
+	size_t GetFreeSize() const
 	{
-		cup_tex_coord_add= 0.0f;
-		tex_coord_left= tex_coord_lefter= tex_coord_center= tex_coord_righter= tex_coord_right= float(color_index);
+		return
+			point_objects.GetFreeSize() +
+			linear_objects.GetFreeSize() +
+			linear_objects_as_triangles.GetFreeSize() +
+			linear_objects_extruded.GetFreeSize() +
+			areal_objects.GetFreeSize();
 	}
 
-	if( vertex_count == 1u )
+	PolygonBufferPool point_objects;
+	PolygonBufferPool linear_objects;
+	PolygonBufferPool linear_objects_as_triangles;
+	PolygonBufferPool linear_objects_extruded;
+	PolygonBufferPool areal_objects;
+};
+
+// Tessellation of lines is selected for power of two scale buckets, buckets beyond this range give no difference.
+static const int32_t c_min_tessellation_scale_bucket= -8;
+static const int32_t c_max_tessellation_scale_bucket= 16;
+
+// Returns log2 of units in pixel, rounded down. Use finest tessellation of scale range, for which bucket is selected.
+static int32_t GetTessellationScaleBucket( const float scale, const size_t zoom_level_log2 )
+{
+	const float units_in_pixel= scale / float( 1u << zoom_level_log2 );
+	const int32_t bucket= int32_t( std::floor( std::log2( units_in_pixel ) ) );
+	return std::max( c_min_tessellation_scale_bucket, std::min( bucket, c_max_tessellation_scale_bucket ) );
+}
+
+// Zoom level is selected, if scale multiplied by this factor is greater, than scale of zoom level.
+static float GetZoomLevelSelectionFactor( const SystemWindow& system_window )
+{
+	const float c_default_pixels_in_m= 3779.0f;
+	// Scale factor for mobile device is less, because user is closer to mobile device screen, then to PC screen.
+#ifdef __ANDROID__
+	const float c_factor= 0.25f;
+#else
+	const float c_factor= 0.5f;
+#endif
+
+	const float pixel_density_scaler= system_window.GetPixelsInScreenMeter() / c_default_pixels_in_m;
+	return c_factor * pixel_density_scaler;
+}
+
+struct MapDrawer::Chunk
+{
+public:
+	struct GroupCullingInfo
 	{
-		// Line was too simplifyed, draw only caps.
-		const m_Vec2 vert( float(in_vertices[0u].x), float(in_vertices[0u].y) );
-		const m_Vec2 edge_shift( 0.0f, half_width );
-
-		// Cup0
-		out_indices.push_back( static_cast<uint16_t>(out_vertices.size()) );
-		out_vertices.push_back(
-			PolygonalLinearObjectVertex{ {
-					vert.x + edge_shift.y,
-					vert.y - edge_shift.x },
-				{ tex_coord_center, tex_coord_y } } );
-		tex_coord_y+= cup_tex_coord_add;
-		out_indices.push_back( static_cast<uint16_t>(out_vertices.size()) );
-		out_vertices.push_back(
-			PolygonalLinearObjectVertex{ {
-					vert.x + edge_shift.x * c_cos_minus_45 - edge_shift.y * c_sin_minus_45,
-					vert.y + edge_shift.x * c_sin_minus_45 + edge_shift.y * c_cos_minus_45 },
-				{ tex_coord_lefter, tex_coord_y } } );
-		out_indices.push_back( static_cast<uint16_t>(out_vertices.size()) );
-		out_vertices.push_back(
-			PolygonalLinearObjectVertex{ {
-					vert.x - edge_shift.x * c_cos_plus_45 + edge_shift.y * c_sin_plus_45,
-					vert.y - edge_shift.x * c_sin_plus_45 - edge_shift.y * c_cos_plus_45 },
-				{ tex_coord_righter, tex_coord_y } } );
-		// Center.
-		tex_coord_y+= cup_tex_coord_add;
-		out_indices.push_back( static_cast<uint16_t>(out_vertices.size()) );
-		out_vertices.push_back(
-			PolygonalLinearObjectVertex{ {
-					vert.x + edge_shift.x,
-					vert.y + edge_shift.y },
-				{ tex_coord_left, tex_coord_y } } );
-		out_indices.push_back( static_cast<uint16_t>(out_vertices.size()) );
-		out_vertices.push_back(
-			PolygonalLinearObjectVertex{ {
-					vert.x - edge_shift.x,
-					vert.y - edge_shift.y },
-				{ tex_coord_right, tex_coord_y } } );
-		// Cup1
-		tex_coord_y+= cup_tex_coord_add;
-		out_indices.push_back( static_cast<uint16_t>(out_vertices.size()) );
-		out_vertices.push_back(
-			PolygonalLinearObjectVertex{ {
-					vert.x + edge_shift.x * c_cos_plus_45 - edge_shift.y * c_sin_plus_45,
-					vert.y + edge_shift.x * c_sin_plus_45 + edge_shift.y * c_cos_plus_45 },
-				{ tex_coord_lefter, tex_coord_y } } );
-		out_indices.push_back( static_cast<uint16_t>(out_vertices.size()) );
-		out_vertices.push_back(
-			PolygonalLinearObjectVertex{ {
-					vert.x - edge_shift.x * c_cos_minus_45 + edge_shift.y * c_sin_minus_45,
-					vert.y - edge_shift.x * c_sin_minus_45 - edge_shift.y * c_cos_minus_45 },
-				{ tex_coord_righter, tex_coord_y } } );
-		tex_coord_y+= cup_tex_coord_add;
-		out_indices.push_back( static_cast<uint16_t>(out_vertices.size()) );
-		out_vertices.push_back(
-			PolygonalLinearObjectVertex{ {
-					vert.x - edge_shift.y,
-					vert.y + edge_shift.x },
-				{ tex_coord_center, tex_coord_y } } );
-
-		out_indices.push_back( c_primitive_restart_index );
-		return;
-	}
+		// Bounding box, relative to chunk coord start.
+		int32_t min_x;
+		int32_t min_y;
+		int32_t max_x;
+		int32_t max_y;
+		// Group is not drawn, if this size (in units) is less, than pixel.
+		float visible_size;
+	};
 
-	// Use float coordinates, because uint16_t is too low for polygonal lines with small width.
-	m_Vec2 prev_edge_base_vec;
+	struct LinearObjectsGroup
 	{
-		const m_Vec2 vert0( float(in_vertices[0u].x), float(in_vertices[0u].y) );
-
-		const m_Vec2 edge_dir( float(in_vertices[1u].x) - vert0.x, float(in_vertices[1u].y) - vert0.y );
-		const float edge_length= edge_dir.Length();
-		PM_ASSERT( edge_length > 0.0f );
-		const float edge_inv_length= 1.0f / edge_length;
-		const m_Vec2 edge_base_vec( edge_dir.y * edge_inv_length, -edge_dir.x * edge_inv_length );
-
-		const m_Vec2 edge_shift= edge_base_vec * half_width;
-
-		// Cup.
-		out_indices.push_back( static_cast<uint16_t>(out_vertices.size()) );
-		out_vertices.push_back(
-			PolygonalLinearObjectVertex{ {
-					vert0.x + edge_shift.y,
-					vert0.y - edge_shift.x },
-				{ tex_coord_center, tex_coord_y } } );
-		tex_coord_y+= cup_tex_coord_add;
-		out_indices.push_back( static_cast<uint16_t>(out_vertices.size()) );
-		out_vertices.push_back(
-			PolygonalLinearObjectVertex{ {
-					vert0.x + edge_shift.x * c_cos_minus_45 - edge_shift.y * c_sin_minus_45,
-					vert0.y + edge_shift.x * c_sin_minus_45 + edge_shift.y * c_cos_minus_45 },
-				{ tex_coord_lefter, tex_coord_y } } );
-		out_indices.push_back( static_cast<uint16_t>(out_vertices.size()) );
-		out_vertices.push_back(
-			PolygonalLinearObjectVertex{ {
-					vert0.x - edge_shift.x * c_cos_plus_45 + edge_shift.y * c_sin_plus_45,
-					vert0.y - edge_shift.x * c_sin_plus_45 - edge_shift.y * c_cos_plus_45 },
-				{ tex_coord_righter, tex_coord_y } } );
-
-		// Start of line.
-		tex_coord_y+= cup_tex_coord_add;
-		out_indices.push_back( static_cast<uint16_t>(out_vertices.size()) );
-		out_vertices.push_back(
-			PolygonalLinearObjectVertex{ {
-					vert0.x + edge_shift.x,
-					vert0.y + edge_shift.y },
-				{ tex_coord_left, tex_coord_y } } );
-		out_indices.push_back( static_cast<uint16_t>(out_vertices.size()) );
-		out_vertices.push_back(
-			PolygonalLinearObjectVertex{ {
-					vert0.x - edge_shift.x,
-					vert0.y - edge_shift.y },
-				{ tex_coord_right, tex_coord_y } } );
-
-		prev_edge_base_vec= edge_base_vec;
-		if( generate_2d_tex_coord )
-			tex_coord_y+= edge_length * tex_coord_scale;
-	}
+		size_t first_index;
+		size_t index_count;
+		GLenum primitive_type;
+		uint8_t style_index;
+		uint8_t z_level;
+		GroupCullingInfo culling_info;
+	};
+	struct ArealObjectsGroup
+	{
+		size_t first_index;
+		size_t index_count;
+		uint8_t z_level;
+		GroupCullingInfo culling_info;
+	};
+
 
-	for( size_t i= 1u; i < vertex_count - 1u; ++i )
+	enum class GPUDataState
 	{
-		const m_Vec2 vert( float(in_vertices[i].x), float(in_vertices[i].y) );
-		const m_Vec2 edge_dir( float(in_vertices[i+1u].x) - vert.x, float(in_vertices[i+1u].y) - vert.y );
-		const float edge_length= edge_dir.Length();
-		PM_ASSERT( edge_length > 0.0f );
-		const float edge_inv_length= 1.0f / edge_length;
-		const m_Vec2 edge_base_vec( edge_dir.y * edge_inv_length, -edge_dir.x * edge_inv_length );
+		None,
+		Preparing, // Vertices and indices are building in background.
+		Ready,
+	};
 
-		const m_Vec2 vertex_base_vec= ( prev_edge_base_vec + edge_base_vec ) * 0.5f;
-		const float vertex_base_vec_inv_square_len= 1.0f / std::max( 0.1f, vertex_base_vec.SquareLength() );
+	// Vertices and indices of chunk, ready for upload into GPU buffers.
+	struct CPUData
+	{
+		std::vector<PointObjectVertex> point_objects_vertices;
 
-		const float edges_dir_dot= prev_edge_base_vec * edge_base_vec;
+		std::vector<LinearObjectVertex> linear_objects_vertices;
+		std::vector<VertexIndex> linear_objects_indicies;
 
-		const float c_rounding_ange= float(Constants::pi / 5.0);
-		const float c_rounding_ange_cos= std::cos(c_rounding_ange);
-		if( edges_dir_dot >= c_rounding_ange_cos )
-		{
-			const m_Vec2 vertex_shift= vertex_base_vec * ( half_width * vertex_base_vec_inv_square_len );
-
-			out_indices.push_back( static_cast<uint16_t>(out_vertices.size()) );
-			out_vertices.push_back(
-				PolygonalLinearObjectVertex{ {
-						vert.x + vertex_shift.x,
-						vert.y + vertex_shift.y },
-					{ tex_coord_left, tex_coord_y } } );
-			out_indices.push_back( static_cast<uint16_t>(out_vertices.size()) );
-			out_vertices.push_back(
-				PolygonalLinearObjectVertex{ {
-						vert.x - vertex_shift.x,
-						vert.y - vertex_shift.y },
-					{ tex_coord_right, tex_coord_y } } );
-		}
-		else
-		{
-			const float angle= std::atan2( mVec2Cross( prev_edge_base_vec, edge_base_vec ), edges_dir_dot );
-			const float angle_abs= std::abs(angle);
-			const size_t rounding_edges= std::max( size_t(1u), size_t(angle_abs / c_rounding_ange) );
-
-			const float sign= angle > 0.0f ? 1.0f : -1.0f;
-
-			const uint16_t corner_vertex_index= static_cast<uint16_t>(out_vertices.size());
-			out_vertices.push_back(
-				PolygonalLinearObjectVertex{ {
-						vert.x - vertex_base_vec.x * ( half_width * vertex_base_vec_inv_square_len * sign ),
-						vert.y - vertex_base_vec.y * ( half_width * vertex_base_vec_inv_square_len * sign ) },
-					{ sign > 0.0f ? tex_coord_right : tex_coord_left, tex_coord_y } } );
-
-			const m_Vec2 vertex_shift= prev_edge_base_vec * ( half_width * sign );
-			const float angle_step= angle / float(rounding_edges);
-			for( size_t i= 0u; i <= rounding_edges; ++i )
-			{
-				// Create one normal and one degenerated triangle.
-				if( sign > 0.0f )
-				{
-					out_indices.push_back( static_cast<uint16_t>(out_vertices.size()) );
-					out_indices.push_back( corner_vertex_index );
-				}
-				else
-				{
-					out_indices.push_back( corner_vertex_index );
-					out_indices.push_back( static_cast<uint16_t>(out_vertices.size()) );
-				}
+		std::vector<PolygonalLinearObjectVertex> linear_objects_as_triangles_vertices;
+		std::vector<VertexIndex> linear_objects_as_triangles_indicies;
 
-				const float vert_angle= angle_step * float(i);
-				const float vert_angle_cos= std::cos(vert_angle);
-				const float vert_angle_sin= std::sin(vert_angle);
+		std::vector<ExtrudedLinearObjectVertex> linear_objects_extruded_vertices;
+		std::vector<VertexIndex> linear_objects_extruded_indicies;
 
-				out_vertices.push_back(
-					PolygonalLinearObjectVertex{ {
-							vert.x + vertex_shift.x * vert_angle_cos - vertex_shift.y * vert_angle_sin,
-							vert.y + vertex_shift.x * vert_angle_sin + vertex_shift.y * vert_angle_cos },
-						{ sign > 0.0f ? tex_coord_left : tex_coord_right, tex_coord_y } } );
-			}
-		}
-		prev_edge_base_vec= edge_base_vec;
-		if( generate_2d_tex_coord )
-			tex_coord_y+= edge_length * tex_coord_scale;
-	}
+		std::vector<ArealObjectVertex> areal_objects_vertices;
+		std::vector<VertexIndex> areal_objects_indicies;
 
-	{
-		const m_Vec2 vert_last( float(in_vertices[vertex_count-1u].x), float(in_vertices[vertex_count-1u].y) );
-		const m_Vec2 edge_shift= prev_edge_base_vec * half_width;
-
-		// End of line
-		out_indices.push_back( static_cast<uint16_t>(out_vertices.size()) );
-		out_vertices.push_back(
-			PolygonalLinearObjectVertex{ {
-					vert_last.x + edge_shift.x,
-					vert_last.y + edge_shift.y },
-				{ tex_coord_left, tex_coord_y } } );
-		out_indices.push_back( static_cast<uint16_t>(out_vertices.size()) );
-		out_vertices.push_back(
-			PolygonalLinearObjectVertex{ {
-					vert_last.x - edge_shift.x,
-					vert_last.y - edge_shift.y },
-				{ tex_coord_right, tex_coord_y } } );
-
-		// Cup.
-		tex_coord_y+= cup_tex_coord_add;
-		out_indices.push_back( static_cast<uint16_t>(out_vertices.size()) );
-		out_vertices.push_back(
-			PolygonalLinearObjectVertex{ {
-					vert_last.x + edge_shift.x * c_cos_plus_45 - edge_shift.y * c_sin_plus_45,
-					vert_last.y + edge_shift.x * c_sin_plus_45 + edge_shift.y * c_cos_plus_45 },
-				{ tex_coord_lefter, tex_coord_y } } );
-		out_indices.push_back( static_cast<uint16_t>(out_vertices.size()) );
-		out_vertices.push_back(
-			PolygonalLinearObjectVertex{ {
-					vert_last.x - edge_shift.x * c_cos_minus_45 + edge_shift.y * c_sin_minus_45,
-					vert_last.y - edge_shift.x * c_sin_minus_45 - edge_shift.y * c_cos_minus_45 },
-				{ tex_coord_righter, tex_coord_y } } );
-		tex_coord_y+= cup_tex_coord_add;
-		out_indices.push_back( static_cast<uint16_t>(out_vertices.size()) );
-		out_vertices.push_back(
-			PolygonalLinearObjectVertex{ {
-					vert_last.x - edge_shift.y,
-					vert_last.y + edge_shift.x },
-				{ tex_coord_center, tex_coord_y } } );
-	}
-	out_indices.push_back( c_primitive_restart_index );
-}
+		std::vector<LinearObjectsGroup> linear_objects_groups;
+		std::vector<ArealObjectsGroup> areal_objects_groups;
 
-static bool TextureShaderRequired( const DataFileDescription::LinearObjectStyle& style )
-{
-	return
-		std::memcmp( style.color, style.color2, sizeof(DataFileDescription::ColorRGBA) ) != 0 ||
-		( style.texture_width > 0u && style.texture_height > 0u );
-}
+		int32_t tessellation_scale_bucket;
+		// True, if chunk contains textured wide lines, tessellation of which depends on scale.
+		bool tessellation_depends_on_scale;
+		// Size of index for GPU. If it is 2, indices are packed into 16 bit.
+		size_t vertex_index_size;
+
+		size_t GetSize() const
+		{
+			return
+				point_objects_vertices.size() * sizeof(PointObjectVertex) +
+				linear_objects_vertices.size() * sizeof(LinearObjectVertex) +
+				linear_objects_indicies.size() * vertex_index_size +
+				linear_objects_as_triangles_vertices.size() * sizeof(PolygonalLinearObjectVertex) +
+				linear_objects_as_triangles_indicies.size() * vertex_index_size +
+				linear_objects_extruded_vertices.size() * sizeof(ExtrudedLinearObjectVertex) +
+				linear_objects_extruded_indicies.size() * vertex_index_size +
+				areal_objects_vertices.size() * sizeof(ArealObjectVertex) +
+				areal_objects_indicies.size() * vertex_index_size;
+		}
+	};
 
-struct MapDrawer::Chunk
-{
 public:
 	Chunk(
 		const DataFileDescription::Chunk& in_chunk,
 		const DataFileDescription::LinearObjectStyle* const linear_styles,
-		const DataFileDescription::ArealObjectStyle* const areal_styles )
+		const DataFileDescription::ArealObjectStyle* const areal_styles,
+		const int32_t extruded_lines_tessellation_scale_bucket )
 		: src_chunk_(in_chunk), linear_styles_(linear_styles), areal_styles_(areal_styles)
+		, extruded_lines_tessellation_scale_bucket_(extruded_lines_tessellation_scale_bucket)
 		, coord_start_x_(in_chunk.coord_start_x), coord_start_y_(in_chunk.coord_start_y)
 		, bb_min_x_(in_chunk.min_x), bb_min_y_(in_chunk.min_y), bb_max_x_(in_chunk.max_x), bb_max_y_(in_chunk.max_y)
 	{
 	}
 
-	void PrepareGPUData()
+	// Builds vertices and indices, reads only memory mapped data file. May be called from any thread.
+	// Textured wide lines are tessellated for given scale bucket, extruded wide lines - for fixed bucket of zoom level.
+	CPUData PrepareCPUData( const int32_t tessellation_scale_bucket, const size_t vertex_index_size ) const
 	{
-		if( gpu_data_prepared_ )
-			return;
-		gpu_data_prepared_= true;
+		CPUData result;
+		result.tessellation_scale_bucket= tessellation_scale_bucket;
+		result.tessellation_depends_on_scale= false;
+		result.vertex_index_size= vertex_index_size;
+		const float units_in_pixel= std::ldexp( 1.0f, tessellation_scale_bucket );
+		const float extruded_lines_units_in_pixel= std::ldexp( 1.0f, extruded_lines_tessellation_scale_bucket_ );
+		std::vector<PointObjectVertex>& point_objects_vertices= result.point_objects_vertices;
+		std::vector<LinearObjectVertex>& linear_objects_vertices= result.linear_objects_vertices;
+		std::vector<VertexIndex>& linear_objects_indicies= result.linear_objects_indicies;
+		std::vector<PolygonalLinearObjectVertex>& linear_objects_as_triangles_vertices= result.linear_objects_as_triangles_vertices;
+		std::vector<VertexIndex>& linear_objects_as_triangles_indicies= result.linear_objects_as_triangles_indicies;
+		std::vector<ExtrudedLinearObjectVertex>& linear_objects_extruded_vertices= result.linear_objects_extruded_vertices;
+		std::vector<VertexIndex>& linear_objects_extruded_indicies= result.linear_objects_extruded_indicies;
+		std::vector<ArealObjectVertex>& areal_objects_vertices= result.areal_objects_vertices;
+		std::vector<VertexIndex>& areal_objects_indicies= result.areal_objects_indicies;
+		std::vector<LinearObjectsGroup>& linear_objects_groups= result.linear_objects_groups;
+		std::vector<ArealObjectsGroup>& areal_objects_groups= result.areal_objects_groups;
 
 		const unsigned char* const chunk_data= reinterpret_cast<const unsigned char*>(&src_chunk_);
 		const auto vertices= reinterpret_cast<const DataFileDescription::ChunkVertex*>( chunk_data + src_chunk_.vertices_offset );
+		const auto indices= reinterpret_cast<const uint16_t*>( chunk_data + src_chunk_.indices_offset );
 		const auto point_object_groups= reinterpret_cast<const DataFileDescription::Chunk::PointObjectGroup*>( chunk_data + src_chunk_.point_object_groups_offset );
 		const auto linear_object_groups= reinterpret_cast<const DataFileDescription::Chunk::LinearObjectGroup*>( chunk_data + src_chunk_.linear_object_groups_offset );
 		const auto areal_object_groups= reinterpret_cast<const DataFileDescription::Chunk::ArealObjectGroup*>( chunk_data + src_chunk_.areal_object_groups_offset );
-		std::vector<PointObjectVertex> point_objects_vertices;
-
-		std::vector<LinearObjectVertex> linear_objects_vertices;
-		std::vector<uint16_t> linear_objects_indicies;
-
-		std::vector<PolygonalLinearObjectVertex> linear_objects_as_triangles_vertices;
-		std::vector<uint16_t> linear_objects_as_triangles_indicies;
-
-		std::vector<ArealObjectVertex> areal_objects_vertices;
-		std::vector<uint16_t> areal_objects_indicies;
 
 		for( uint16_t i= 0u; i < src_chunk_.point_object_groups_count; ++i )
 		{
 			const DataFileDescription::Chunk::PointObjectGroup group= point_object_groups[i];
-			for( uint16_t v= group.first_vertex; v < group.first_vertex + group.vertex_count; ++v )
+			for( uint32_t v= group.first_vertex; v < group.first_vertex + group.vertex_count; ++v )
 			{
 				const DataFileDescription::ChunkVertex& vertex= vertices[v];
 				PointObjectVertex out_vertex;
 				out_vertex.xy[0]= vertex.x;
 				out_vertex.xy[1]= vertex.y;
 				out_vertex.color_index= group.style_index;
+				std::memset( out_vertex.reserved, 0, sizeof(out_vertex.reserved) );
 				point_objects_vertices.push_back( out_vertex );
 			}
 		}
 
 		// Draw polylines, using "GL_LINE_STRIP" primitive with primitive restart index.
-		// Or draw it as "GL_TRIANGLE_STRIP".
+		// Or draw it as "GL_TRIANGLE_STRIP". Non-textured wide lines are extruded in vertex shader,
+		// textured lines are extruded on CPU, because texture coordinates depend on width.
 		std::vector<DataFileDescription::ChunkVertex> tmp_vertices;
+		LineTessellationCache line_tessellation_cache;
 		for( uint16_t i= 0u; i < src_chunk_.linear_object_groups_count; ++i )
 		{
 			const DataFileDescription::Chunk::LinearObjectGroup group= linear_object_groups[i];
 			LinearObjectsGroup out_group;
 			out_group.style_index= group.style_index;
 			out_group.z_level= uint8_t( group.z_level );
+			out_group.culling_info= GetGroupCullingInfo( group.bounding_box, float(group.visible_size) );
+			// Line with zero length is still visible, if it is wide.
+			out_group.culling_info.visible_size=
+				std::max( out_group.culling_info.visible_size, float(linear_styles_[group.style_index].width_mul_256) / 256.0f );
+			// Bounding box contains only center lines, extend it by half width of line.
+			if( linear_styles_[group.style_index].width_mul_256 > 0 )
+			{
+				const int32_t half_width= int32_t( ( linear_styles_[group.style_index].width_mul_256 + 511u ) / 512u );
+				out_group.culling_info.min_x-= half_width;
+				out_group.culling_info.min_y-= half_width;
+				out_group.culling_info.max_x+= half_width;
+				out_group.culling_info.max_y+= half_width;
+			}
 
 			if( linear_styles_[group.style_index].width_mul_256 > 0 )
 			{
-				out_group.first_index= linear_objects_as_triangles_indicies.size();
+				const bool textured= TextureShaderRequired( linear_styles_[group.style_index] );
+				out_group.first_index= textured ? linear_objects_as_triangles_indicies.size() : linear_objects_extruded_indicies.size();
 
 				const float half_width= float(linear_styles_[group.style_index].width_mul_256) / ( 256.0f * 2.0f );
 				const float square_half_width= half_width * half_width;
+				const float pixel_half_width= half_width / ( textured ? units_in_pixel : extruded_lines_units_in_pixel );
+				if( textured )
+					result.tessellation_depends_on_scale= true;
 
 				const float tex_coord_scale= 256.0f / float(linear_styles_[group.style_index].dash_size_mul_256);
-				for( uint16_t v= group.first_vertex; v < group.first_vertex + group.vertex_count; ++v )
+				for( uint32_t v= group.first_vertex; v < group.first_vertex + group.vertex_count; ++v )
 				{
 					const DataFileDescription::ChunkVertex& vertex= vertices[v];
 					if( vertex.x == 65535u )
@@ -434,24 +352,24 @@ public:
 						SimplifyLine( tmp_vertices, square_half_width );
 						if( !tmp_vertices.empty() )
 						{
-							if( TextureShaderRequired( linear_styles_[group.style_index]) )
-								CreatePolygonalLine<true>( tmp_vertices.data(), tmp_vertices.size(), group.style_index, half_width, tex_coord_scale, linear_objects_as_triangles_vertices, linear_objects_as_triangles_indicies );
+							if( textured )
+								CreateTexturedPolygonalLine( tmp_vertices.data(), tmp_vertices.size(), half_width, pixel_half_width, tex_coord_scale, line_tessellation_cache, linear_objects_as_triangles_vertices, linear_objects_as_triangles_indicies );
 							else
-								CreatePolygonalLine<false>( tmp_vertices.data(), tmp_vertices.size(), group.style_index, half_width, 0.0f, linear_objects_as_triangles_vertices, linear_objects_as_triangles_indicies );
+								CreateExtrudedPolygonalLine( tmp_vertices.data(), tmp_vertices.size(), group.style_index, pixel_half_width, line_tessellation_cache, linear_objects_extruded_vertices, linear_objects_extruded_indicies );
 						}
 						tmp_vertices.clear();
 					}
 					else
 						tmp_vertices.push_back(vertex);
 				}
-				out_group.index_count= linear_objects_as_triangles_indicies.size() - out_group.first_index;
+				out_group.index_count= ( textured ? linear_objects_as_triangles_indicies.size() : linear_objects_extruded_indicies.size() ) - out_group.first_index;
 				out_group.primitive_type= GL_TRIANGLE_STRIP;
 			}
 			else
 			{
 				out_group.first_index= linear_objects_indicies.size();
 
-				for( uint16_t v= group.first_vertex; v < group.first_vertex + group.vertex_count; ++v )
+				for( uint32_t v= group.first_vertex; v < group.first_vertex + group.vertex_count; ++v )
 				{
 					const DataFileDescription::ChunkVertex& vertex= vertices[v];
 					if( vertex.x  == 65535u )
@@ -461,95 +379,157 @@ public:
 						LinearObjectVertex out_vertex;
 						out_vertex.xy[0]= vertex.x;
 						out_vertex.xy[1]= vertex.y;
-						out_vertex.tex_coord[0]= group.style_index;
-						linear_objects_indicies.push_back( static_cast<uint16_t>( linear_objects_vertices.size() ) );
+						out_vertex.color_index= group.style_index;
+						std::memset( out_vertex.reserved, 0, sizeof(out_vertex.reserved) );
+						linear_objects_indicies.push_back( static_cast<VertexIndex>( linear_objects_vertices.size() ) );
 						linear_objects_vertices.push_back( out_vertex );
 					}
 				}
 				out_group.index_count= linear_objects_indicies.size() - out_group.first_index;
 				out_group.primitive_type= GL_LINE_STRIP;
 			}
-			linear_objects_groups_.push_back( out_group );
+			linear_objects_groups.push_back( out_group );
 		}
 
-		// Areal objects must be convex polygons.
-		// Draw convex polygons, using "GL_TRIANGLE_FAN" primitive with primitive restart index.
-		size_t prev_polygon_start_vertex_index= 0u;
+		// Areal objects are indexed triangle lists.
+		// Style groups with same z_level are adjacent, draw them together.
 		for( uint16_t i= 0u; i < src_chunk_.areal_object_groups_count; ++i )
 		{
 			const DataFileDescription::Chunk::ArealObjectGroup group= areal_object_groups[i];
-			ArealObjectsGroup out_group;
-			out_group.first_index= areal_objects_indicies.size();
-			out_group.z_level= uint8_t( group.z_level );
-			for( uint16_t v= group.first_vertex; v < group.first_vertex + group.vertex_count; ++v )
+
+			const size_t first_vertex= areal_objects_vertices.size();
+			for( uint32_t v= group.first_vertex; v < group.first_vertex + group.vertex_count; ++v )
 			{
-				const DataFileDescription::ChunkVertex& vertex= vertices[v];
-				if( vertex.x == 65535u )
-				{
-					areal_objects_indicies.push_back( c_primitive_restart_index );
-					for( size_t i= prev_polygon_start_vertex_index; i < areal_objects_vertices.size(); ++i )
-						areal_objects_vertices[i].color_index= vertex.y;
-					prev_polygon_start_vertex_index= areal_objects_vertices.size();
-				}
-				else
-				{
-					ArealObjectVertex out_vertex;
-					out_vertex.xy[0]= vertex.x;
-					out_vertex.xy[1]= vertex.y;
-					areal_objects_indicies.push_back( static_cast<uint16_t>( areal_objects_vertices.size() ) );
-					areal_objects_vertices.push_back( out_vertex );
-				}
+				ArealObjectVertex out_vertex;
+				out_vertex.xy[0]= vertices[v].x;
+				out_vertex.xy[1]= vertices[v].y;
+				out_vertex.color_index= group.style_index;
+				std::memset( out_vertex.reserved, 0, sizeof(out_vertex.reserved) );
+				areal_objects_vertices.push_back( out_vertex );
 			}
 
-			out_group.index_count= areal_objects_indicies.size() - out_group.first_index;
-			areal_objects_groups_.push_back(out_group);
+			if( areal_objects_groups.empty() || areal_objects_groups.back().z_level != group.z_level )
+			{
+				ArealObjectsGroup out_group;
+				out_group.first_index= areal_objects_indicies.size();
+				out_group.index_count= 0u;
+				out_group.z_level= uint8_t( group.z_level );
+				out_group.culling_info= GetGroupCullingInfo( group.bounding_box, float(group.visible_size) );
+				areal_objects_groups.push_back(out_group);
+			}
+			else
+			{
+				// Merge culling info. Visible size is square root of area, so, add areas.
+				GroupCullingInfo& culling_info= areal_objects_groups.back().culling_info;
+				const GroupCullingInfo group_culling_info= GetGroupCullingInfo( group.bounding_box, float(group.visible_size) );
+				culling_info.min_x= std::min( culling_info.min_x, group_culling_info.min_x );
+				culling_info.min_y= std::min( culling_info.min_y, group_culling_info.min_y );
+				culling_info.max_x= std::max( culling_info.max_x, group_culling_info.max_x );
+				culling_info.max_y= std::max( culling_info.max_y, group_culling_info.max_y );
+				culling_info.visible_size=
+					std::sqrt(
+						culling_info.visible_size * culling_info.visible_size +
+						group_culling_info.visible_size * group_culling_info.visible_size );
+			}
+
+			for( uint32_t index= group.first_index; index < group.first_index + group.index_count; ++index )
+				areal_objects_indicies.push_back( static_cast<VertexIndex>( first_vertex + indices[index] ) );
+			areal_objects_groups.back().index_count= areal_objects_indicies.size() - areal_objects_groups.back().first_index;
 		}
 
-		point_objects_polygon_buffer_.VertexData( point_objects_vertices.data(), point_objects_vertices.size() * sizeof(PointObjectVertex), sizeof(PointObjectVertex) );
-		point_objects_polygon_buffer_.SetPrimitiveType( GL_POINTS );
-		point_objects_polygon_buffer_.VertexAttribPointer( 0, 2, GL_UNSIGNED_SHORT, false, 0 );
-		point_objects_polygon_buffer_.VertexAttribPointer( 1, 1, GL_UNSIGNED_INT, false, sizeof(uint16_t) * 2 );
-
-		PM_ASSERT( linear_objects_vertices.size() < 65535u );
-		linear_objects_polygon_buffer_.VertexData( linear_objects_vertices.data(), linear_objects_vertices.size() * sizeof(LinearObjectVertex), sizeof(LinearObjectVertex) );
-		linear_objects_polygon_buffer_.IndexData( linear_objects_indicies.data(), linear_objects_indicies.size() * sizeof(uint16_t), GL_UNSIGNED_SHORT, GL_LINE_STRIP );
-		linear_objects_polygon_buffer_.VertexAttribPointer( 0, 2, GL_UNSIGNED_SHORT, false, 0 );
-		linear_objects_polygon_buffer_.VertexAttribPointer( 1, 2, GL_UNSIGNED_SHORT, false, sizeof(uint16_t) * 2 );
-
-		PM_ASSERT( linear_objects_as_triangles_vertices.size() < 65535u );
-		linear_objects_as_triangles_buffer_.VertexData( linear_objects_as_triangles_vertices.data(), linear_objects_as_triangles_vertices.size() * sizeof(PolygonalLinearObjectVertex), sizeof(PolygonalLinearObjectVertex) );
-		linear_objects_as_triangles_buffer_.IndexData( linear_objects_as_triangles_indicies.data(), linear_objects_as_triangles_indicies.size() * sizeof(uint16_t), GL_UNSIGNED_SHORT, GL_TRIANGLE_STRIP );
-		linear_objects_as_triangles_buffer_.VertexAttribPointer( 0, 2, GL_FLOAT, true, 0 );
-		linear_objects_as_triangles_buffer_.VertexAttribPointer( 1, 2, GL_FLOAT, false, sizeof(float) * 2 );
-
-		PM_ASSERT( areal_objects_vertices.size() < 65535u );
-		areal_objects_polygon_buffer_.VertexData( areal_objects_vertices.data(), areal_objects_vertices.size() * sizeof(ArealObjectVertex), sizeof(ArealObjectVertex) );
-		areal_objects_polygon_buffer_.IndexData( areal_objects_indicies.data(), areal_objects_indicies.size() * sizeof(uint16_t), GL_UNSIGNED_SHORT, GL_TRIANGLE_FAN );
-		areal_objects_polygon_buffer_.VertexAttribPointer( 0, 2, GL_UNSIGNED_SHORT, false, 0 );
-		areal_objects_polygon_buffer_.VertexAttribPointer( 1, 1, GL_UNSIGNED_INT, false, sizeof(uint16_t) * 2 );
+		if( vertex_index_size == sizeof(uint16_t) )
+		{
+			PackIndicesTo16Bit( linear_objects_indicies );
+			PackIndicesTo16Bit( linear_objects_as_triangles_indicies );
+			PackIndicesTo16Bit( linear_objects_extruded_indicies );
+			PackIndicesTo16Bit( areal_objects_indicies );
+		}
 
+		return result;
+	}
+
+	// Creates GPU buffers. Must be called from thread with OpenGL context.
+	void UploadGPUData( CPUData& data, BufferPools& buffer_pools )
+	{
+		PM_ASSERT( gpu_data_state_ != GPUDataState::Ready );
+		gpu_data_state_= GPUDataState::Ready;
+
+		const size_t vertex_index_size= data.vertex_index_size;
+		const uint32_t primitive_restart_index= GetPrimitiveRestartIndex( vertex_index_size );
+
+		const std::vector<PointObjectVertex>& point_objects_vertices= data.point_objects_vertices;
+		const std::vector<LinearObjectVertex>& linear_objects_vertices= data.linear_objects_vertices;
+		const std::vector<VertexIndex>& linear_objects_indicies= data.linear_objects_indicies;
+		const std::vector<PolygonalLinearObjectVertex>& linear_objects_as_triangles_vertices= data.linear_objects_as_triangles_vertices;
+		const std::vector<VertexIndex>& linear_objects_as_triangles_indicies= data.linear_objects_as_triangles_indicies;
+		const std::vector<ExtrudedLinearObjectVertex>& linear_objects_extruded_vertices= data.linear_objects_extruded_vertices;
+		const std::vector<VertexIndex>& linear_objects_extruded_indicies= data.linear_objects_extruded_indicies;
+		const std::vector<ArealObjectVertex>& areal_objects_vertices= data.areal_objects_vertices;
+		const std::vector<VertexIndex>& areal_objects_indicies= data.areal_objects_indicies;
+		linear_objects_groups_= std::move( data.linear_objects_groups );
+		areal_objects_groups_= std::move( data.areal_objects_groups );
+		tessellation_scale_bucket_= data.tessellation_scale_bucket;
+		tessellation_depends_on_scale_= data.tessellation_depends_on_scale;
+
+		point_objects_polygon_buffer_=
+			buffer_pools.point_objects.Acquire(
+				point_objects_vertices.data(), point_objects_vertices.size() * sizeof(PointObjectVertex),
+				nullptr, 0u );
+
+		PM_ASSERT( linear_objects_vertices.size() < primitive_restart_index );
+		linear_objects_polygon_buffer_=
+			buffer_pools.linear_objects.Acquire(
+				linear_objects_vertices.data(), linear_objects_vertices.size() * sizeof(LinearObjectVertex),
+				linear_objects_indicies.data(), linear_objects_indicies.size() * vertex_index_size );
+
+		PM_ASSERT( linear_objects_as_triangles_vertices.size() < primitive_restart_index );
+		linear_objects_as_triangles_buffer_=
+			buffer_pools.linear_objects_as_triangles.Acquire(
+				linear_objects_as_triangles_vertices.data(), linear_objects_as_triangles_vertices.size() * sizeof(PolygonalLinearObjectVertex),
+				linear_objects_as_triangles_indicies.data(), linear_objects_as_triangles_indicies.size() * vertex_index_size );
+
+		PM_ASSERT( linear_objects_extruded_vertices.size() < primitive_restart_index );
+		linear_objects_extruded_buffer_=
+			buffer_pools.linear_objects_extruded.Acquire(
+				linear_objects_extruded_vertices.data(), linear_objects_extruded_vertices.size() * sizeof(ExtrudedLinearObjectVertex),
+				linear_objects_extruded_indicies.data(), linear_objects_extruded_indicies.size() * vertex_index_size );
+
+		PM_ASSERT( areal_objects_vertices.size() < primitive_restart_index );
+		areal_objects_polygon_buffer_=
+			buffer_pools.areal_objects.Acquire(
+				areal_objects_vertices.data(), areal_objects_vertices.size() * sizeof(ArealObjectVertex),
+				areal_objects_indicies.data(), areal_objects_indicies.size() * vertex_index_size );
+
+		// Count real size of GPU buffers, not only used part.
 		gpu_data_size_= 0u;
-		gpu_data_size_+= point_objects_polygon_buffer_.GetVertexDataSize();
-		gpu_data_size_+= point_objects_polygon_buffer_.GetIndexDataSize();
-		gpu_data_size_+= linear_objects_polygon_buffer_.GetVertexDataSize();
-		gpu_data_size_+= linear_objects_polygon_buffer_.GetIndexDataSize();
-		gpu_data_size_+= linear_objects_as_triangles_buffer_.GetVertexDataSize();
-		gpu_data_size_+= linear_objects_as_triangles_buffer_.GetIndexDataSize();
-		gpu_data_size_+= areal_objects_polygon_buffer_.GetVertexDataSize();
-		gpu_data_size_+= areal_objects_polygon_buffer_.GetIndexDataSize();
+		gpu_data_size_+= point_objects_polygon_buffer_.vertex_capacity + point_objects_polygon_buffer_.index_capacity;
+		gpu_data_size_+= linear_objects_polygon_buffer_.vertex_capacity + linear_objects_polygon_buffer_.index_capacity;
+		gpu_data_size_+= linear_objects_as_triangles_buffer_.vertex_capacity + linear_objects_as_triangles_buffer_.index_capacity;
+		gpu_data_size_+= linear_objects_extruded_buffer_.vertex_capacity + linear_objects_extruded_buffer_.index_capacity;
+		gpu_data_size_+= areal_objects_polygon_buffer_.vertex_capacity + areal_objects_polygon_buffer_.index_capacity;
 	}
 
-	void ClearGPUData()
+	// Returns GPU buffers into pools.
+	void ClearGPUData( BufferPools& buffer_pools )
 	{
-		if( !gpu_data_prepared_ )
+		if( gpu_data_state_ != GPUDataState::Ready )
 			return;
 
-		gpu_data_prepared_= false;
+		gpu_data_state_= GPUDataState::None;
+		// Result of rebuild in progress is not needed anymore, it will be dropped on upload.
+		if( preparation_in_progress_ )
+		{
+			preparation_in_progress_= false;
+			++preparation_generation_;
+		}
 		gpu_data_size_= 0u;
-		point_objects_polygon_buffer_= r_PolygonBuffer();
-		linear_objects_polygon_buffer_= r_PolygonBuffer();
-		linear_objects_as_triangles_buffer_= r_PolygonBuffer();
-		areal_objects_polygon_buffer_= r_PolygonBuffer();
+		buffer_pools.point_objects.Release( point_objects_polygon_buffer_ );
+		buffer_pools.linear_objects.Release( linear_objects_polygon_buffer_ );
+		buffer_pools.linear_objects_as_triangles.Release( linear_objects_as_triangles_buffer_ );
+		buffer_pools.linear_objects_extruded.Release( linear_objects_extruded_buffer_ );
+		buffer_pools.areal_objects.Release( areal_objects_polygon_buffer_ );
+		linear_objects_groups_.clear();
+		areal_objects_groups_.clear();
 	}
 
 	size_t GetGPUDataSize() const
@@ -563,21 +543,17 @@ public:
 	Chunk& operator=( const Chunk& )= delete;
 	Chunk& operator=( Chunk&& )= delete;
 
-public:
-	struct LinearObjectsGroup
-	{
-		size_t first_index;
-		size_t index_count;
-		GLenum primitive_type;
-		uint8_t style_index;
-		uint8_t z_level;
-	};
-	struct ArealObjectsGroup
+private:
+	static GroupCullingInfo GetGroupCullingInfo( const DataFileDescription::Chunk::GroupBoundingBox& bounding_box, const float visible_size )
 	{
-		size_t first_index;
-		size_t index_count;
-		uint8_t z_level;
-	};
+		GroupCullingInfo result;
+		result.min_x= bounding_box.min_x;
+		result.min_y= bounding_box.min_y;
+		result.max_x= bounding_box.max_x;
+		result.max_y= bounding_box.max_y;
+		result.visible_size= visible_size;
+		return result;
+	}
 
 public:
 	// References to memory mapped data file.
@@ -585,6 +561,7 @@ public:
 	const DataFileDescription::Chunk& src_chunk_;
 	const DataFileDescription::LinearObjectStyle* const linear_styles_;
 	const DataFileDescription::ArealObjectStyle* const areal_styles_;
+	const int32_t extruded_lines_tessellation_scale_bucket_;
 
 	const int32_t coord_start_x_;
 	const int32_t coord_start_y_;
@@ -593,12 +570,22 @@ public:
 	const int32_t bb_max_x_;
 	const int32_t bb_max_y_;
 
-	bool gpu_data_prepared_= false;
+	GPUDataState gpu_data_state_= GPUDataState::None;
+	int32_t tessellation_scale_bucket_= 0;
+	bool tessellation_depends_on_scale_= false;
+	// Only one preparation task of chunk is valid - with current generation. Results of other tasks are dropped on upload.
+	// In "Ready" state this means, that data for other scale bucket is preparing and current data is still drawn.
+	bool preparation_in_progress_= false;
+	uint32_t preparation_generation_= 0u;
+	// Position in list of chunks with GPU data, valid only in "Ready" state.
+	std::list<Chunk*>::iterator resident_chunks_iterator_;
+	size_t last_used_frame_= 0u;
 	size_t gpu_data_size_= 0u;
-	r_PolygonBuffer point_objects_polygon_buffer_;
-	r_PolygonBuffer linear_objects_polygon_buffer_;
-	r_PolygonBuffer linear_objects_as_triangles_buffer_;
-	r_PolygonBuffer areal_objects_polygon_buffer_;
+	PolygonBufferPool::Buffer point_objects_polygon_buffer_;
+	PolygonBufferPool::Buffer linear_objects_polygon_buffer_;
+	PolygonBufferPool::Buffer linear_objects_as_triangles_buffer_;
+	PolygonBufferPool::Buffer linear_objects_extruded_buffer_;
+	PolygonBufferPool::Buffer areal_objects_polygon_buffer_;
 
 	std::vector<LinearObjectsGroup> linear_objects_groups_;
 	std::vector<ArealObjectsGroup> areal_objects_groups_;
@@ -607,7 +594,7 @@ public:
 struct MapDrawer::ZoomLevel
 {
 public:
-	ZoomLevel( const DataFileDescription::ZoomLevel& in_zoom_level, const unsigned char* const file_content )
+	ZoomLevel( const DataFileDescription::ZoomLevel& in_zoom_level, const unsigned char* const file_content, const int32_t extruded_lines_tessellation_scale_bucket )
 		: zoom_level_log2(in_zoom_level.zoom_level_log2)
 	{
 		const auto point_styles= reinterpret_cast<const DataFileDescription::PointObjectStyle*>( file_content + in_zoom_level.point_styles_offset );
@@ -621,7 +608,7 @@ public:
 			const size_t chunk_offset= chunks_description[chunk_index].offset;
 			const unsigned char* const chunk_data= file_content + chunk_offset;
 			const DataFileDescription::Chunk& chunk= *reinterpret_cast<const DataFileDescription::Chunk*>(chunk_data);
-			chunks.emplace_back( chunk, linear_styles, areal_styles );
+			chunks.emplace_back( chunk, linear_styles, areal_styles, extruded_lines_tessellation_scale_bucket );
 		}
 
 		// Extract linear styles
@@ -644,6 +631,10 @@ public:
 			for( uint32_t x= 0u; x < in_zoom_level.linear_styles_count; ++x )
 			for( uint32_t y= 0u; y < texture_with_colors_height; ++y )
 				std::memcpy( texture_data[ x + y * texture_with_colors_width ], linear_styles[x].color, sizeof(DataFileDescription::ColorRGBA) );
+			// Second row contains widths of lines, extruded in shader.
+			for( uint32_t x= 0u; x < in_zoom_level.linear_styles_count; ++x )
+			for( uint32_t i= 0u; i < 4u; ++i )
+				texture_data[ x + texture_with_colors_width ][i]= static_cast<unsigned char>( linear_styles[x].width_mul_256 >> ( i * 8u ) );
 			linear_objects_texture= r_Texture( r_Texture::PixelFormat::RGBA8, texture_with_colors_width, texture_with_colors_height, reinterpret_cast<const unsigned char*>( texture_data ) );
 			linear_objects_texture.SetFiltration( r_Texture::Filtration::Nearest, r_Texture::Filtration::Nearest );
 
@@ -770,11 +761,85 @@ struct MapDrawer::ChunkToDraw
 	m_Mat4 matrix;
 };
 
+struct MapDrawer::DrawCommand
+{
+	uint32_t sort_key;
+	const ChunkToDraw* chunk_to_draw;
+	size_t first_index;
+	size_t index_count;
+	GLenum primitive_type;
+	uint8_t style_index;
+	bool is_linear;
+};
+
+struct MapDrawer::PreparedChunk
+{
+	Chunk* chunk;
+	uint32_t generation;
+	Chunk::CPUData data;
+	bool prefetched;
+};
+
+#ifdef __ANDROID__
+static const size_t c_default_gpu_memory_limit=  64u * 1024u * 1024u;
+#else
+static const size_t c_default_gpu_memory_limit= 128u * 1024u * 1024u;
+#endif
+
+// Released buffers of evicted chunks are kept for reuse, until this part of GPU memory limit for each pool.
+static const size_t c_free_buffers_size_per_pool_limit_divider= 32u;
+
+// Prefetch chunks, which will be visible after this time, if camera continues motion.
+static const float c_prefetch_time_s= 0.5f;
+// CPU budget for prefetch - maximum number of chunks in background preparation (including visible chunks).
+static const size_t c_prefetch_max_chunks_in_preparation= 8u;
+// GPU budget for prefetch - do not prefetch anything, if GPU data is bigger, than this part of GPU memory limit.
+static const size_t c_prefetch_gpu_memory_limit_divider= 2u;
+// Camera velocity is reset, if frames are rarer.
+static const float c_camera_velocity_max_time_delta_s= 0.25f;
+
+struct ViewportBoundingBox
+{
+	// In zoom level units.
+	int32_t min_x;
+	int32_t min_y;
+	int32_t max_x;
+	int32_t max_y;
+};
+
+static ViewportBoundingBox GetViewportBoundingBox( const m_Vec2& cam_pos, const float scale, const ViewportSize& viewport_size, const size_t zoom_level_log2 )
+{
+	const int32_t bb_extend_eps= 16;
+	const int32_t viewport_half_size_x_world_space= int32_t( float(viewport_size.width  ) * 0.5f * scale ) + bb_extend_eps;
+	const int32_t viewport_half_size_y_world_space= int32_t( float(viewport_size.height ) * 0.5f * scale ) + bb_extend_eps;
+	const int32_t cam_pos_x_world_space= int32_t(cam_pos.x);
+	const int32_t cam_pos_y_world_space= int32_t(cam_pos.y);
+
+	ViewportBoundingBox result;
+	result.min_x= ( cam_pos_x_world_space - viewport_half_size_x_world_space ) >> zoom_level_log2;
+	result.max_x= ( cam_pos_x_world_space + viewport_half_size_x_world_space ) >> zoom_level_log2;
+	result.min_y= ( cam_pos_y_world_space - viewport_half_size_y_world_space ) >> zoom_level_log2;
+	result.max_y= ( cam_pos_y_world_space + viewport_half_size_y_world_space ) >> zoom_level_log2;
+	return result;
+}
+
+static size_t GetWorkerThreadCount()
+{
+	// Environment variable allows to disable background chunks preparation ("0") or set number of threads.
+	if( const char* const threads_env= std::getenv( "PANZER_MAPS_WORKER_THREADS" ) )
+		return size_t( std::min( std::max( std::atoi( threads_env ), 0 ), 16 ) );
+
+	// Keep one core for render thread.
+	const unsigned int hardware_threads= std::thread::hardware_concurrency();
+	return hardware_threads > 2u ? std::min( hardware_threads - 1u, 4u ) : 1u;
+}
+
 MapDrawer::MapDrawer( const SystemWindow& system_window, UiDrawer& ui_drawer, const char* const map_file )
 	: viewport_size_(system_window.GetViewportSize())
 	, system_window_(system_window)
 	, ui_drawer_(ui_drawer)
 	, data_file_( MemoryMappedFile::Create( map_file ) )
+	, gpu_memory_limit_( c_default_gpu_memory_limit )
 {
 	if( data_file_ == nullptr )
 	{
@@ -801,9 +866,37 @@ MapDrawer::MapDrawer( const SystemWindow& system_window, UiDrawer& ui_drawer, co
 		return;
 	}
 
+#ifdef PM_OPENGL_ES
+	if( data_file.vertex_index_size != sizeof(uint16_t) )
+	{
+		Log::FatalError( "Map file requires ", data_file.vertex_index_size * 8u, "-bit indices, which are not supported on this platform. Export map without \"--32-bit-indices\"." );
+		return;
+	}
+#else
+	if( data_file.vertex_index_size != sizeof(uint16_t) && data_file.vertex_index_size != sizeof(uint32_t) )
+	{
+		Log::FatalError( "Unsupported vertex index size: ", data_file.vertex_index_size, "." );
+		return;
+	}
+#endif
+	vertex_index_size_= data_file.vertex_index_size;
+	vertex_index_type_= GetVertexIndexType( vertex_index_size_ );
+	buffer_pools_.reset( new BufferPools( gpu_memory_limit_ / c_free_buffers_size_per_pool_limit_divider, vertex_index_type_ ) );
+
 	const auto zoom_levels= reinterpret_cast<const DataFileDescription::ZoomLevel*>( file_content + data_file.zoom_levels_offset );
 	for( uint32_t zoom_level_index= 0u; zoom_level_index < data_file.zoom_level_count; ++zoom_level_index )
-		zoom_levels_.emplace_back( zoom_levels[zoom_level_index], file_content );
+	{
+		// Zoom level is selected for known range of scales. Tessellate extruded lines once, for finest scale of this range,
+		// because rebuilding of chunks while zooming is more expensive, than few extra vertices in joins of lines.
+		const float min_scale=
+			std::max(
+				float( 1u << zoom_levels[0].zoom_level_log2 ),
+				zoom_level_index == 0u ? 0.0f : float( 1u << zoom_levels[zoom_level_index].zoom_level_log2 ) / GetZoomLevelSelectionFactor( system_window ) );
+		zoom_levels_.emplace_back(
+			zoom_levels[zoom_level_index],
+			file_content,
+			GetTessellationScaleBucket( min_scale, zoom_levels[zoom_level_index].zoom_level_log2 ) );
+	}
 
 	std::memcpy( background_color_, data_file.common_style.background_color, sizeof(background_color_) );
 
@@ -827,14 +920,22 @@ MapDrawer::MapDrawer( const SystemWindow& system_window, UiDrawer& ui_drawer, co
 
 	linear_objets_shader_.ShaderSource( Shaders::linear_fragment, Shaders::linear_vertex );
 	linear_objets_shader_.SetAttribLocation( "pos", 0 );
-	linear_objets_shader_.SetAttribLocation( "tex_coord", 1 );
+	linear_objets_shader_.SetAttribLocation( "color_index", 1 );
 	linear_objets_shader_.Create();
 
 	linear_textured_objets_shader_.ShaderSource( Shaders::linear_textured_fragment, Shaders::linear_textured_vertex );
 	linear_textured_objets_shader_.SetAttribLocation( "pos", 0 );
-	linear_textured_objets_shader_.SetAttribLocation( "tex_coord", 1 );
+	linear_textured_objets_shader_.SetAttribLocation( "pos_fraction", 1 );
+	linear_textured_objets_shader_.SetAttribLocation( "tex_coord_x", 2 );
+	linear_textured_objets_shader_.SetAttribLocation( "tex_coord_y", 3 );
 	linear_textured_objets_shader_.Create();
 
+	linear_extruded_objets_shader_.ShaderSource( Shaders::linear_fragment, Shaders::linear_extruded_vertex );
+	linear_extruded_objets_shader_.SetAttribLocation( "pos", 0 );
+	linear_extruded_objets_shader_.SetAttribLocation( "extrude", 1 );
+	linear_extruded_objets_shader_.SetAttribLocation( "color_index", 2 );
+	linear_extruded_objets_shader_.Create();
+
 	areal_objects_shader_.ShaderSource( Shaders::areal_fragment, Shaders::areal_vertex );
 	areal_objects_shader_.SetAttribLocation( "pos", 0 );
 	areal_objects_shader_.SetAttribLocation( "color_index", 1 );
@@ -843,6 +944,18 @@ MapDrawer::MapDrawer( const SystemWindow& system_window, UiDrawer& ui_drawer, co
 	gps_marker_shader_.ShaderSource( Shaders::gps_marker_fragment, Shaders::gps_marker_vertex );
 	gps_marker_shader_.Create();
 
+	// Texture unit is same for all frames, so, set it once. Look up per-chunk uniform once, instead of lookup by name for each chunk.
+	for( const r_GLSLProgram* const shader : { &point_objets_shader_, &linear_objets_shader_, &linear_textured_objets_shader_, &linear_extruded_objets_shader_, &areal_objects_shader_ } )
+	{
+		shader->Bind();
+		shader->Uniform( "tex", 0 );
+	}
+	point_objets_view_matrix_uniform_= GLint( point_objets_shader_.GetUniformId( "view_matrix" ) );
+	linear_objets_view_matrix_uniform_= GLint( linear_objets_shader_.GetUniformId( "view_matrix" ) );
+	linear_textured_objets_view_matrix_uniform_= GLint( linear_textured_objets_shader_.GetUniformId( "view_matrix" ) );
+	linear_extruded_objets_view_matrix_uniform_= GLint( linear_extruded_objets_shader_.GetUniformId( "view_matrix" ) );
+	areal_objects_view_matrix_uniform_= GLint( areal_objects_shader_.GetUniformId( "view_matrix" ) );
+
 	// Setup camera
 	const m_Vec2 scene_size=
 		m_Vec2( float( data_file.max_x - data_file.min_x ), float( data_file.max_y - data_file.min_y ) ) /
@@ -854,6 +967,8 @@ MapDrawer::MapDrawer( const SystemWindow& system_window, UiDrawer& ui_drawer, co
 	min_scale_= float( 1 << int(zoom_levels_.front().zoom_level_log2 ) );
 	max_scale_= 2.0f * std::max( scene_size.x, scene_size.y ) / float( std::max( viewport_size_.width, viewport_size_.height ) );
 	scale_= max_scale_;
+	prev_cam_pos_= cam_pos_;
+	prev_scale_= scale_;
 
 	IProjectionPtr base_projection;
 	switch( data_file.projection )
@@ -871,21 +986,32 @@ MapDrawer::MapDrawer( const SystemWindow& system_window, UiDrawer& ui_drawer, co
 
 	if( base_projection != nullptr )
 		projection_.reset( new LinearProjectionTransformation( std::move(base_projection), GeoPoint{ data_file.projection_min_lon, data_file.projection_min_lat }, GeoPoint{ data_file.projection_max_lon, data_file.projection_max_lat }, data_file.unit_size ) );
+
+	const size_t worker_thread_count= GetWorkerThreadCount();
+	Log::Info( "Chunks preparation worker threads: ", worker_thread_count );
+	if( worker_thread_count > 0u )
+		worker_pool_.reset( new WorkerPool( worker_thread_count ) );
 }
 
 MapDrawer::~MapDrawer()
 {
+	// Stop workers before destruction of chunks.
+	worker_pool_.reset();
 }
 
 void MapDrawer::Draw()
 {
+	const auto frame_start_time= std::chrono::steady_clock::now();
+	std::chrono::steady_clock::duration chunks_preparation_time( 0 );
+
 	readraw_required_= false;
 
 #ifdef PM_OPENGL_ES
 	const auto enable_primitive_restart= [] { glEnable( GL_PRIMITIVE_RESTART_FIXED_INDEX ); };
 	const auto disable_primitive_restart= [] { glDisable( GL_PRIMITIVE_RESTART_FIXED_INDEX ); };
 #else
-	const auto enable_primitive_restart= [] { glEnable( GL_PRIMITIVE_RESTART ); glPrimitiveRestartIndex( c_primitive_restart_index ); };
+	const GLuint primitive_restart_index= GetPrimitiveRestartIndex( vertex_index_size_ );
+	const auto enable_primitive_restart= [primitive_restart_index] { glEnable( GL_PRIMITIVE_RESTART ); glPrimitiveRestartIndex( primitive_restart_index ); };
 	const auto disable_primitive_restart= [] { glDisable( GL_PRIMITIVE_RESTART ); };
 #endif
 
@@ -893,7 +1019,15 @@ void MapDrawer::Draw()
 	glClearColor( float(background_color_[0]) / 255.0f, float(background_color_[1]) / 255.0f, float(background_color_[2]) / 255.0f, float(background_color_[3]) / 255.0f );
 	glClear( GL_COLOR_BUFFER_BIT );
 
-	ZoomLevel& zoom_level= SelectZoomLevel();
+	{
+		const auto preparation_start_time= std::chrono::steady_clock::now();
+		UploadPreparedChunks();
+		chunks_preparation_time+= std::chrono::steady_clock::now() - preparation_start_time;
+	}
+
+	UpdateCameraVelocity();
+
+	ZoomLevel& zoom_level= SelectZoomLevel( scale_ );
 
 	// Calculate view matrix.
 	// TODO - maybe use m_Mat3?
@@ -905,124 +1039,304 @@ void MapDrawer::Draw()
 	view_matrix= zoom_level_matrix * translate_matrix * scale_matrix * aspect_matrix;
 
 	// Calculate viewport bounding box.
-	const int32_t bb_extend_eps= 16;
-	const int32_t viewport_half_size_x_world_space= int32_t( float(viewport_size_.width  ) * 0.5f * scale_ ) + bb_extend_eps;
-	const int32_t viewport_half_size_y_world_space= int32_t( float(viewport_size_.height ) * 0.5f * scale_ ) + bb_extend_eps;
-	const int32_t cam_pos_x_world_space= int32_t(cam_pos_.x);
-	const int32_t cam_pos_y_world_space= int32_t(cam_pos_.y);
-	const int32_t bb_min_x= ( cam_pos_x_world_space - viewport_half_size_x_world_space ) >> zoom_level.zoom_level_log2;
-	const int32_t bb_max_x= ( cam_pos_x_world_space + viewport_half_size_x_world_space ) >> zoom_level.zoom_level_log2;
-	const int32_t bb_min_y= ( cam_pos_y_world_space - viewport_half_size_y_world_space ) >> zoom_level.zoom_level_log2;
-	const int32_t bb_max_y= ( cam_pos_y_world_space + viewport_half_size_y_world_space ) >> zoom_level.zoom_level_log2;
+	const ViewportBoundingBox viewport_bounding_box= GetViewportBoundingBox( cam_pos_, scale_, viewport_size_, zoom_level.zoom_level_log2 );
+	const int32_t bb_min_x= viewport_bounding_box.min_x;
+	const int32_t bb_max_x= viewport_bounding_box.max_x;
+	const int32_t bb_min_y= viewport_bounding_box.min_y;
+	const int32_t bb_max_y= viewport_bounding_box.max_y;
+
+	// Skip groups of objects outside viewport or smaller, than pixel.
+	const float units_in_pixel= scale_ / float( 1u << zoom_level.zoom_level_log2 );
+	const auto group_is_visible=
+	[&]( const Chunk& chunk, const Chunk::GroupCullingInfo& culling_info ) -> bool
+	{
+		return
+			culling_info.visible_size >= units_in_pixel &&
+			chunk.coord_start_x_ + culling_info.min_x <= bb_max_x &&
+			chunk.coord_start_y_ + culling_info.min_y <= bb_max_y &&
+			chunk.coord_start_x_ + culling_info.max_x >= bb_min_x &&
+			chunk.coord_start_y_ + culling_info.max_y >= bb_min_y;
+	};
+
+	// Wide lines are tessellated according to scale, rebuild chunks, when scale changes significantly.
+	const int32_t tessellation_scale_bucket= GetTessellationScaleBucket( scale_, zoom_level.zoom_level_log2 );
 
 	// Setup chunks list, calculate matrices.
 	std::vector<ChunkToDraw> visible_chunks;
-	uint16_t min_z_level= 100u, max_z_level= 0u;
 	for( Chunk& chunk : zoom_level.chunks )
 	{
 		if( chunk.bb_min_x_ >= bb_max_x || chunk.bb_min_y_ >= bb_max_y ||
 			chunk.bb_max_x_ <= bb_min_x || chunk.bb_max_y_ <= bb_min_y )
 			continue;
 
-		chunk.PrepareGPUData();
+		if( chunk.gpu_data_state_ == Chunk::GPUDataState::None )
+		{
+			const auto preparation_start_time= std::chrono::steady_clock::now();
+			RequestChunkGPUData( chunk, tessellation_scale_bucket );
+			chunks_preparation_time+= std::chrono::steady_clock::now() - preparation_start_time;
+		}
+		if( chunk.gpu_data_state_ != Chunk::GPUDataState::Ready )
+		{
+			// Chunk is not ready yet, draw it in one of next frames.
+			readraw_required_= true;
+			continue;
+		}
+		if( chunk.tessellation_depends_on_scale_ && !chunk.preparation_in_progress_ &&
+			chunk.tessellation_scale_bucket_ != tessellation_scale_bucket )
+		{
+			// Draw old data, until new data is ready.
+			const auto preparation_start_time= std::chrono::steady_clock::now();
+			RequestChunkGPUData( chunk, tessellation_scale_bucket );
+			chunks_preparation_time+= std::chrono::steady_clock::now() - preparation_start_time;
+		}
+		TouchChunk( chunk );
 
 		m_Mat4 coords_shift_matrix, chunk_view_matrix;
 		coords_shift_matrix.Translate( m_Vec3( float(chunk.coord_start_x_), float(chunk.coord_start_y_), 0.0f ) );
 		chunk_view_matrix= coords_shift_matrix * view_matrix;
 
 		visible_chunks.push_back( ChunkToDraw{ chunk, chunk_view_matrix } );
-
-		min_z_level= std::min( min_z_level, chunk.src_chunk_.min_z_level );
-		max_z_level= std::max( max_z_level, chunk.src_chunk_.max_z_level );
 	}
 
-	// Draw chunks.
-	size_t draw_calls= 0u;
-	size_t primitive_count= 0u;
-
-	// Draw areal and linear objects ordered by z_level.
-	for( uint16_t z_level= min_z_level; z_level <= max_z_level; ++z_level )
+	// Visible chunks are requested first, prefetch after them.
 	{
-		// -- Areal --
-
-		areal_objects_shader_.Bind();
-		areal_objects_shader_.Uniform( "tex", 0 );
-
-		zoom_level.areal_objects_texture.Bind(0);
+		const auto preparation_start_time= std::chrono::steady_clock::now();
+		PrefetchChunks();
+		chunks_preparation_time+= std::chrono::steady_clock::now() - preparation_start_time;
+	}
 
-		enable_primitive_restart();
-		for( const ChunkToDraw& chunk_to_draw : visible_chunks )
+	// Collect draw commands for areal and linear objects.
+	// Sort them by z_level, areal objects before linear, linear objects by style order.
+	// Linear objects are sorted by style but not by chunk, because linear objects of neighboring chunks may overlap.
+	// Stable sort keeps chunks order inside each key.
+	uint32_t linear_style_rank[256u];
+	std::fill( std::begin(linear_style_rank), std::end(linear_style_rank), ~0u );
+	for( size_t i= 0u; i < zoom_level.linear_styles_order.size(); ++i )
+		linear_style_rank[ zoom_level.linear_styles_order[i] ]= static_cast<uint32_t>(i);
+
+	draw_commands_.clear();
+	for( const ChunkToDraw& chunk_to_draw : visible_chunks )
+	{
+		const Chunk& chunk= chunk_to_draw.chunk;
+		for( const Chunk::ArealObjectsGroup& group : chunk.areal_objects_groups_ )
 		{
-			if( chunk_to_draw.chunk.areal_objects_polygon_buffer_.GetVertexDataSize() == 0u )
-				continue;
-
-			areal_objects_shader_.Uniform( "view_matrix", chunk_to_draw.matrix );
-
-			for( const Chunk::ArealObjectsGroup& group : chunk_to_draw.chunk.areal_objects_groups_ )
+			if( group.index_count > 0u && group_is_visible( chunk, group.culling_info ) )
 			{
-				if( group.z_level == z_level && group.index_count > 0u )
-				{
-					chunk_to_draw.chunk.areal_objects_polygon_buffer_.Bind();
-					glDrawElements( GL_TRIANGLE_FAN, static_cast<int>(group.index_count), GL_UNSIGNED_SHORT, reinterpret_cast<GLsizei*>( group.first_index * sizeof(uint16_t) ) );
-					++draw_calls;
-					primitive_count+= group.index_count;
-				}
+				DrawCommand command;
+				command.sort_key= uint32_t(group.z_level) << 16u;
+				command.chunk_to_draw= &chunk_to_draw;
+				command.first_index= group.first_index;
+				command.index_count= group.index_count;
+				command.primitive_type= GL_TRIANGLES;
+				command.style_index= 0u;
+				command.is_linear= false;
+				draw_commands_.push_back( command );
 			}
 		}
-		disable_primitive_restart();
-
-		// -- linear --
-
-		enable_primitive_restart();
-
-		// Draw linear objects ordered by style and z_level but not by chunk, because linear objects of neighboring chunks may overlap.
-		for( const uint8_t style_index : zoom_level.linear_styles_order )
+		for( const Chunk::LinearObjectsGroup& group : chunk.linear_objects_groups_ )
 		{
-			for( const ChunkToDraw& chunk_to_draw : visible_chunks )
+			if( group.index_count > 0u && linear_style_rank[group.style_index] != ~0u && group_is_visible( chunk, group.culling_info ) )
 			{
-				if( chunk_to_draw.chunk.linear_objects_polygon_buffer_.GetVertexDataSize() == 0u &&
-					chunk_to_draw.chunk.linear_objects_as_triangles_buffer_.GetVertexDataSize() == 0u )
-					continue;
+				DrawCommand command;
+				command.sort_key= ( uint32_t(group.z_level) << 16u ) | ( 1u << 15u ) | linear_style_rank[group.style_index];
+				command.chunk_to_draw= &chunk_to_draw;
+				command.first_index= group.first_index;
+				command.index_count= group.index_count;
+				command.primitive_type= group.primitive_type;
+				command.style_index= group.style_index;
+				command.is_linear= true;
+				draw_commands_.push_back( command );
+			}
+		}
+	}
+	std::stable_sort(
+		draw_commands_.begin(), draw_commands_.end(),
+		[]( const DrawCommand& l, const DrawCommand& r ) { return l.sort_key < r.sort_key; } );
+	// Order of chunks inside run of commands with same key does not matter.
+	// Reverse it in each second run, so, last chunk of run is usually first chunk of next run and its commands may be merged.
+	{
+		bool reverse_run= false;
+		for( size_t run_start= 0u; run_start < draw_commands_.size(); )
+		{
+			size_t run_end= run_start + 1u;
+			while( run_end < draw_commands_.size() && draw_commands_[run_end].sort_key == draw_commands_[run_start].sort_key )
+				++run_end;
+			if( reverse_run )
+				std::reverse( draw_commands_.begin() + std::ptrdiff_t(run_start), draw_commands_.begin() + std::ptrdiff_t(run_end) );
+			reverse_run= !reverse_run;
+			run_start= run_end;
+		}
+	}
 
-				for( const Chunk::LinearObjectsGroup& group : chunk_to_draw.chunk.linear_objects_groups_ )
+	// Execute draw commands. Change OpenGL state only if it is really changed.
+	// Merge commands for adjacent index ranges of same buffer with same state into one draw call.
+	// On desktop merge also commands for not adjacent ranges, using glMultiDrawElements.
+	size_t draw_calls= 0u;
+	size_t state_changes= 0u;
+	size_t primitive_count= 0u;
+	{
+		const r_GLSLProgram* current_shader= nullptr;
+		const ChunkToDraw* current_shader_chunk= nullptr;
+		const r_Texture* current_texture= nullptr;
+		const r_PolygonBuffer* current_buffer= nullptr;
+		bool blend_enabled= false;
+		bool primitive_restart_enabled= false;
+
+		for( size_t command_index= 0u; command_index < draw_commands_.size(); )
+		{
+			const DrawCommand& command= draw_commands_[command_index];
+			const Chunk& chunk= command.chunk_to_draw->chunk;
+
+			const r_GLSLProgram* shader;
+			GLint view_matrix_uniform;
+			const r_Texture* texture;
+			const r_PolygonBuffer* buffer;
+			bool blend;
+			if( command.is_linear )
+			{
+				const auto tex_it= zoom_level.textured_lines_textures.find( command.style_index );
+				if( tex_it != zoom_level.textured_lines_textures.end() )
+				{
+					shader= &linear_textured_objets_shader_;
+					view_matrix_uniform= linear_textured_objets_view_matrix_uniform_;
+					texture= &tex_it->second;
+					blend= true;
+				}
+				else
 				{
-					if( group.style_index == style_index && group.z_level == z_level && group.index_count > 0u )
+					if( command.primitive_type == GL_LINE_STRIP )
 					{
-						const auto tex_it= zoom_level.textured_lines_textures.find( group.style_index );
-						if( tex_it != zoom_level.textured_lines_textures.end() )
-						{
-							linear_textured_objets_shader_.Bind();
-							linear_textured_objets_shader_.Uniform( "tex", 0 );
-							linear_textured_objets_shader_.Uniform( "view_matrix", chunk_to_draw.matrix );
-							tex_it->second.Bind(0);
-
-							glEnable( GL_BLEND );
-						}
-						else
-						{
-							linear_objets_shader_.Bind();
-							linear_objets_shader_.Uniform( "tex", 0 );
-							linear_objets_shader_.Uniform( "view_matrix", chunk_to_draw.matrix );
-							zoom_level.linear_objects_texture.Bind(0);
+						shader= &linear_objets_shader_;
+						view_matrix_uniform= linear_objets_view_matrix_uniform_;
+					}
+					else
+					{
+						shader= &linear_extruded_objets_shader_;
+						view_matrix_uniform= linear_extruded_objets_view_matrix_uniform_;
+					}
+					texture= &zoom_level.linear_objects_texture;
+					blend= zoom_level.linear_styles[command.style_index].color[3] != 255u;
+				}
+				if( command.primitive_type == GL_LINE_STRIP )
+					buffer= &chunk.linear_objects_polygon_buffer_.polygon_buffer;
+				else if( shader == &linear_textured_objets_shader_ )
+					buffer= &chunk.linear_objects_as_triangles_buffer_.polygon_buffer;
+				else
+					buffer= &chunk.linear_objects_extruded_buffer_.polygon_buffer;
+			}
+			else
+			{
+				shader= &areal_objects_shader_;
+				view_matrix_uniform= areal_objects_view_matrix_uniform_;
+				texture= &zoom_level.areal_objects_texture;
+				blend= false;
+				buffer= &chunk.areal_objects_polygon_buffer_.polygon_buffer;
+			}
 
-							if( zoom_level.linear_styles[style_index].color[3] != 255u )
-								glEnable( GL_BLEND );
-						}
+			// Merge next commands with same state.
+			size_t index_count= command.index_count;
+			primitive_count+= command.index_count;
+#ifndef PM_OPENGL_ES
+			size_t range_first_index= command.first_index;
+			draw_ranges_counts_.clear();
+			draw_ranges_offsets_.clear();
+#endif
+			size_t next_command_index= command_index + 1u;
+			while( next_command_index < draw_commands_.size() )
+			{
+				const DrawCommand& next_command= draw_commands_[next_command_index];
+				if( next_command.chunk_to_draw != command.chunk_to_draw ||
+					next_command.is_linear != command.is_linear ||
+					next_command.primitive_type != command.primitive_type )
+					break;
+#ifdef PM_OPENGL_ES
+				if( next_command.first_index != command.first_index + index_count )
+					break;
+#endif
+				if( command.is_linear &&
+					( zoom_level.textured_lines_textures.count( next_command.style_index ) > 0u ||
+					  zoom_level.textured_lines_textures.count( command.style_index ) > 0u ||
+					  ( zoom_level.linear_styles[next_command.style_index].color[3] != 255u ) != blend ) )
+					break;
+#ifndef PM_OPENGL_ES
+				if( next_command.first_index != range_first_index + index_count )
+				{
+					draw_ranges_counts_.push_back( static_cast<GLsizei>(index_count) );
+					draw_ranges_offsets_.push_back( reinterpret_cast<const void*>( range_first_index * vertex_index_size_ ) );
+					range_first_index= next_command.first_index;
+					index_count= 0u;
+				}
+#endif
+				index_count+= next_command.index_count;
+				primitive_count+= next_command.index_count;
+				++next_command_index;
+			}
 
-						if( group.primitive_type == GL_LINE_STRIP )
-							chunk_to_draw.chunk.linear_objects_polygon_buffer_.Bind();
-						else
-							chunk_to_draw.chunk.linear_objects_as_triangles_buffer_.Bind();
-						glDrawElements( group.primitive_type, static_cast<int>(group.index_count), GL_UNSIGNED_SHORT, reinterpret_cast<GLsizei*>( group.first_index * sizeof(uint16_t) ) );
-						++draw_calls;
-						primitive_count+= group.index_count;
+			if( shader != current_shader )
+			{
+				shader->Bind();
+				current_shader= shader;
+				current_shader_chunk= nullptr;
+				++state_changes;
+			}
+			if( command.chunk_to_draw != current_shader_chunk )
+			{
+				glUniformMatrix4fv( view_matrix_uniform, 1, GL_FALSE, command.chunk_to_draw->matrix.value );
+				current_shader_chunk= command.chunk_to_draw;
+				++state_changes;
+			}
+			if( texture != current_texture )
+			{
+				texture->Bind(0);
+				current_texture= texture;
+				++state_changes;
+			}
+			if( buffer != current_buffer )
+			{
+				buffer->Bind();
+				current_buffer= buffer;
+				++state_changes;
+			}
+			if( blend != blend_enabled )
+			{
+				if( blend )
+					glEnable( GL_BLEND );
+				else
+					glDisable( GL_BLEND );
+				blend_enabled= blend;
+				++state_changes;
+			}
+			if( command.is_linear != primitive_restart_enabled )
+			{
+				if( command.is_linear )
+					enable_primitive_restart();
+				else
+					disable_primitive_restart();
+				primitive_restart_enabled= command.is_linear;
+				++state_changes;
+			}
 
-						glDisable( GL_BLEND );
-					}
-				}
+#ifdef PM_OPENGL_ES
+			glDrawElements( command.primitive_type, static_cast<int>(index_count), vertex_index_type_, reinterpret_cast<GLsizei*>( command.first_index * vertex_index_size_ ) );
+#else
+			if( draw_ranges_counts_.empty() )
+				glDrawElements( command.primitive_type, static_cast<int>(index_count), vertex_index_type_, reinterpret_cast<GLsizei*>( range_first_index * vertex_index_size_ ) );
+			else
+			{
+				draw_ranges_counts_.push_back( static_cast<GLsizei>(index_count) );
+				draw_ranges_offsets_.push_back( reinterpret_cast<const void*>( range_first_index * vertex_index_size_ ) );
+				glMultiDrawElements( command.primitive_type, draw_ranges_counts_.data(), vertex_index_type_, draw_ranges_offsets_.data(), static_cast<GLsizei>( draw_ranges_counts_.size() ) );
 			}
+#endif
+			++draw_calls;
+
+			command_index= next_command_index;
 		}
-		disable_primitive_restart();
+
+		if( blend_enabled )
+			glDisable( GL_BLEND );
+		if( primitive_restart_enabled )
+			disable_primitive_restart();
 	}
 	// Point objects.
 	const auto& point_objects_icons_atlas=
@@ -1032,7 +1346,6 @@ void MapDrawer::Draw()
 	if( !point_objects_icons_atlas.texture.IsEmpty() )
 	{
 		point_objets_shader_.Bind();
-		point_objets_shader_.Uniform( "tex", 0 );
 		point_objets_shader_.Uniform( "point_size", point_objects_icons_atlas.size );
 		point_objets_shader_.Uniform( "icon_tc_step", point_objects_icons_atlas.tc_step );
 		point_objets_shader_.Uniform( "icon_tc_scale", point_objects_icons_atlas.tc_scale );
@@ -1042,13 +1355,17 @@ void MapDrawer::Draw()
 		glEnable( GL_BLEND );
 		for( const ChunkToDraw& chunk_to_draw : visible_chunks )
 		{
-			if( chunk_to_draw.chunk.point_objects_polygon_buffer_.GetVertexDataSize() == 0u )
+			const PolygonBufferPool::Buffer& buffer= chunk_to_draw.chunk.point_objects_polygon_buffer_;
+			if( buffer.vertex_data_size == 0u )
 				continue;
 
-			point_objets_shader_.Uniform( "view_matrix", chunk_to_draw.matrix );
-			chunk_to_draw.chunk.point_objects_polygon_buffer_.Draw();
+			// Buffer capacity may be greater, than data size, so, draw only actual vertices.
+			const size_t vertex_count= buffer.vertex_data_size / sizeof(PointObjectVertex);
+			glUniformMatrix4fv( point_objets_view_matrix_uniform_, 1, GL_FALSE, chunk_to_draw.matrix.value );
+			buffer.polygon_buffer.Bind();
+			glDrawArrays( GL_POINTS, 0, static_cast<int>(vertex_count) );
 			++draw_calls;
-			primitive_count+= chunk_to_draw.chunk.point_objects_polygon_buffer_.GetVertexDataSize() / sizeof(PointObjectVertex);
+			primitive_count+= vertex_count;
 		}
 		glDisable( GL_BLEND );
 	}
@@ -1115,21 +1432,43 @@ void MapDrawer::Draw()
 	ClearGPUData();
 
 	if( ( frame_number_ & 63u ) == 0u )
-		Log::User( "Visible chunks: ", visible_chunks.size(), " draw calls: ", draw_calls, " index count: ", primitive_count );
+		Log::User( "Visible chunks: ", visible_chunks.size(), " draw commands: ", draw_commands_.size(), " draw calls: ", draw_calls, " state changes: ", state_changes, " index count: ", primitive_count );
 
 	if( ( frame_number_ & 255u ) == 0u )
 	{
-		// Calculate GPU statistics.
-		size_t total_gpu_data_size= 0u;
-		for( const ZoomLevel& zoom_level : zoom_levels_ )
+		const GPUMemoryStatistics statistics= GetGPUMemoryStatistics();
+		Log::Info(
+			"GPU data size: ", statistics.gpu_data_size / 1024u, "kb of ", statistics.gpu_memory_limit / 1024u, "kb",
+			" resident chunks: ", statistics.resident_chunks,
+			" per chunk: ", statistics.resident_chunks == 0u ? 0u : statistics.gpu_data_size / statistics.resident_chunks, "b",
+			" in preparation: ", statistics.chunks_in_preparation,
+			" free buffers: ", statistics.free_buffers_size / 1024u, "kb",
+			" uploaded: ", statistics.uploaded_chunks,
+			" evicted: ", statistics.evicted_chunks,
+			" dropped: ", statistics.dropped_chunks );
+	}
+
+	// Frame time statistics. Time of GPU work and buffers swapping is not included.
+	const std::chrono::steady_clock::duration frame_time= std::chrono::steady_clock::now() - frame_start_time;
+	frame_time_sum_+= frame_time;
+	frame_time_max_= std::max( frame_time_max_, frame_time );
+	chunks_preparation_time_sum_+= chunks_preparation_time;
+	++frame_time_frames_;
+	if( ( frame_number_ & 63u ) == 0u )
+	{
+		const auto to_ms=
+		[]( const std::chrono::steady_clock::duration duration ) -> float
 		{
-			size_t zoom_level_gpu_data_size= 0u;
-			for( const Chunk& chunk : zoom_level.chunks )
-				zoom_level_gpu_data_size+= chunk.GetGPUDataSize();
-			Log::Info( "Zoom level ", &zoom_level - zoom_levels_.data(), " GPU data size: ", zoom_level_gpu_data_size / 1024u, "kb" );
-			total_gpu_data_size+= zoom_level_gpu_data_size;
-		}
-		Log::Info( "Total GPU data size: ", total_gpu_data_size / 1024u, "kb = ", total_gpu_data_size / 1024u / 1024, "mb" );
+			return float( std::chrono::duration_cast<std::chrono::microseconds>( duration ).count() ) / 1000.0f;
+		};
+		Log::User(
+			"Frame time avg: ", to_ms( frame_time_sum_ ) / float(frame_time_frames_), "ms",
+			" max: ", to_ms( frame_time_max_ ), "ms",
+			" chunks preparation avg: ", to_ms( chunks_preparation_time_sum_ ) / float(frame_time_frames_), "ms",
+			" (", worker_pool_ == nullptr ? "without" : "with", " worker threads)" );
+
+		frame_time_sum_= frame_time_max_= chunks_preparation_time_sum_= std::chrono::steady_clock::duration( 0 );
+		frame_time_frames_= 0u;
 	}
 
 	++frame_number_;
@@ -1178,80 +1517,264 @@ void MapDrawer::SetGPSMarkerPosition( const GeoPoint& gps_marker_position )
 	}
 }
 
-MapDrawer::ZoomLevel& MapDrawer::SelectZoomLevel()
+void MapDrawer::RequestChunkGPUData( Chunk& chunk, const int32_t tessellation_scale_bucket, const bool prefetch )
 {
-	const float c_default_pixels_in_m= 3779.0f;
-	// Scale factor for mobile device is less, because user is closer to mobile device screen, then to PC screen.
-#ifdef __ANDROID__
-	const float c_factor= 0.25f;
-#else
-	const float c_factor= 0.5f;
-#endif
+	PM_ASSERT( chunk.gpu_data_state_ != Chunk::GPUDataState::Preparing );
+	PM_ASSERT( !chunk.preparation_in_progress_ );
 
-	const float pixel_density_scaler= system_window_.GetPixelsInScreenMeter() / c_default_pixels_in_m;
+	// Invalidate results of previous tasks, if they are still running.
+	++chunk.preparation_generation_;
+	chunk.preparation_in_progress_= true;
+	const uint32_t generation= chunk.preparation_generation_;
 
-	for( size_t i= 1u; i < zoom_levels_.size(); ++i )
-		if( scale_ * c_factor * pixel_density_scaler < float( 1u << zoom_levels_[i].zoom_level_log2 ) )
-			return zoom_levels_[i-1u];
+	if( worker_pool_ == nullptr )
+	{
+		PreparedChunk prepared_chunk{ &chunk, generation, chunk.PrepareCPUData( tessellation_scale_bucket, vertex_index_size_ ), false };
+		UploadChunk( prepared_chunk );
+		return;
+	}
 
-	return zoom_levels_.back();
+	// Ready chunk is rebuilt for other scale bucket. It keeps its GPU data until new data is uploaded.
+	if( chunk.gpu_data_state_ != Chunk::GPUDataState::Ready )
+		chunk.gpu_data_state_= Chunk::GPUDataState::Preparing;
+	++chunks_in_preparation_;
+
+	Chunk* const chunk_ptr= &chunk;
+	worker_pool_->Push(
+		[this, chunk_ptr, generation, tessellation_scale_bucket, prefetch]
+		{
+			PreparedChunk prepared_chunk{ chunk_ptr, generation, chunk_ptr->PrepareCPUData( tessellation_scale_bucket, vertex_index_size_ ), prefetch };
+			std::lock_guard<std::mutex> lock( prepared_chunks_mutex_ );
+			prepared_chunks_.push_back( std::move(prepared_chunk) );
+		},
+		prefetch ? WorkerPool::Priority::Low : WorkerPool::Priority::High );
 }
 
-void MapDrawer::ClearGPUData()
+void MapDrawer::UpdateCameraVelocity()
 {
-	size_t total_gpu_data_size= 0u;
-	for( const ZoomLevel& zoom_level : zoom_levels_ )
-		for( const Chunk& chunk : zoom_level.chunks )
-			total_gpu_data_size+= chunk.GetGPUDataSize();
+	const auto current_time= std::chrono::steady_clock::now();
+	const float time_delta_s= float( std::chrono::duration_cast<std::chrono::microseconds>( current_time - prev_camera_time_ ).count() ) * 1.0e-6f;
 
-#ifdef __ANDROID__
-	const size_t c_gpu_memory_limit=  64u * 1024u * 1024u;
-#else
-	const size_t c_gpu_memory_limit= 128u * 1024u * 1024u;
-#endif
+	if( time_delta_s > c_camera_velocity_max_time_delta_s )
+	{
+		cam_velocity_= m_Vec2( 0.0f, 0.0f );
+		scale_log2_velocity_= 0.0f;
+	}
+	else if( time_delta_s > 0.0f )
+	{
+		// Smooth velocity, because frame time is not stable.
+		const float inv_time_delta= 1.0f / time_delta_s;
+		cam_velocity_= ( cam_velocity_ + ( cam_pos_ - prev_cam_pos_ ) * inv_time_delta ) * 0.5f;
+		scale_log2_velocity_= ( scale_log2_velocity_ + std::log2( scale_ / prev_scale_ ) * inv_time_delta ) * 0.5f;
+	}
 
-	if( total_gpu_data_size <= c_gpu_memory_limit )
+	prev_camera_time_= current_time;
+	prev_cam_pos_= cam_pos_;
+	prev_scale_= scale_;
+}
+
+void MapDrawer::PrefetchChunks()
+{
+	// Prefetch only in background, synchronous preparation of invisible chunks slows down drawing.
+	if( worker_pool_ == nullptr || chunks_in_preparation_ >= c_prefetch_max_chunks_in_preparation )
+		return;
+
+	// Predict camera position and scale.
+	m_Vec2 predicted_cam_pos= cam_pos_ + cam_velocity_ * c_prefetch_time_s;
+	predicted_cam_pos.x= std::max( min_cam_pos_.x, std::min( predicted_cam_pos.x, max_cam_pos_.x ) );
+	predicted_cam_pos.y= std::max( min_cam_pos_.y, std::min( predicted_cam_pos.y, max_cam_pos_.y ) );
+	const float predicted_scale= std::max( min_scale_, std::min( scale_ * std::exp2( scale_log2_velocity_ * c_prefetch_time_s ), max_scale_ ) );
+
+	ZoomLevel& zoom_level= SelectZoomLevel( scale_ );
+	ZoomLevel& predicted_zoom_level= SelectZoomLevel( predicted_scale );
+	if( &predicted_zoom_level == &zoom_level && predicted_scale <= scale_ * 1.01f &&
+		std::abs( predicted_cam_pos.x - cam_pos_.x ) < scale_ && std::abs( predicted_cam_pos.y - cam_pos_.y ) < scale_ )
+		return; // Camera moves less, than pixel, all visible chunks are already requested.
+
+	if( gpu_data_size_ >= gpu_memory_limit_ / c_prefetch_gpu_memory_limit_divider )
 		return;
 
-	size_t current_zoom_level_log2= SelectZoomLevel().zoom_level_log2;
+	// Use union of current and predicted viewport, because camera may stop before reaching of predicted position.
+	// Also prefetch chunks of next zoom level, if zooming is heading to it.
+	const ViewportBoundingBox current_bb= GetViewportBoundingBox( cam_pos_, scale_, viewport_size_, predicted_zoom_level.zoom_level_log2 );
+	const ViewportBoundingBox predicted_bb= GetViewportBoundingBox( predicted_cam_pos, predicted_scale, viewport_size_, predicted_zoom_level.zoom_level_log2 );
+	const int32_t bb_min_x= std::min( current_bb.min_x, predicted_bb.min_x );
+	const int32_t bb_min_y= std::min( current_bb.min_y, predicted_bb.min_y );
+	const int32_t bb_max_x= std::max( current_bb.max_x, predicted_bb.max_x );
+	const int32_t bb_max_y= std::max( current_bb.max_y, predicted_bb.max_y );
 
-	// Try clear GPU data of some chunks.
-	// Chunks, with greater distance to camera removed firstly.
-	// Chunks of zoom levels, different, from current, removed firstly.
-	struct QueueChunk
+	struct PrefetchCandidate
 	{
 		Chunk* chunk;
-		int32_t weight;
+		int64_t square_distance;
 	};
-	std::vector< QueueChunk > chunks_queue;
-
-	for( ZoomLevel& zoom_level : zoom_levels_ )
-	for( Chunk& chunk : zoom_level.chunks )
+	std::vector<PrefetchCandidate> candidates;
+	for( Chunk& chunk : predicted_zoom_level.chunks )
 	{
-		const int32_t center_x= ( ( chunk.bb_min_x_ + chunk.bb_max_x_ ) >> 1 ) << zoom_level.zoom_level_log2;
-		const int32_t center_y= ( ( chunk.bb_min_y_ + chunk.bb_max_y_ ) >> 1 ) << zoom_level.zoom_level_log2;
-		const int64_t dx= center_x - int32_t(cam_pos_.x);
-		const int64_t dy= center_y - int32_t(cam_pos_.y);
-		const int32_t distance= int32_t( std::sqrt( double( dx * dx + dy * dy ) ) ) >> zoom_level.zoom_level_log2;
-		const int32_t weight=
-		65535 * std::abs( int32_t(zoom_level.zoom_level_log2) - int32_t(current_zoom_level_log2) ) +
-			1 * distance;
-		PM_ASSERT( weight >= 0 );
-
-		chunks_queue.emplace_back( QueueChunk{ &chunk, weight } );
+		if( chunk.gpu_data_state_ != Chunk::GPUDataState::None ||
+			chunk.bb_min_x_ >= bb_max_x || chunk.bb_min_y_ >= bb_max_y ||
+			chunk.bb_max_x_ <= bb_min_x || chunk.bb_max_y_ <= bb_min_y )
+			continue;
+
+		const int64_t dx= int64_t( ( chunk.bb_min_x_ + chunk.bb_max_x_ ) >> 1 ) - int64_t( int32_t(predicted_cam_pos.x) >> predicted_zoom_level.zoom_level_log2 );
+		const int64_t dy= int64_t( ( chunk.bb_min_y_ + chunk.bb_max_y_ ) >> 1 ) - int64_t( int32_t(predicted_cam_pos.y) >> predicted_zoom_level.zoom_level_log2 );
+		candidates.push_back( PrefetchCandidate{ &chunk, dx * dx + dy * dy } );
 	}
 
-	// Sort by weight in descent order.
+	const int32_t predicted_tessellation_scale_bucket= GetTessellationScaleBucket( predicted_scale, predicted_zoom_level.zoom_level_log2 );
+
+	// Nearest to predicted camera position first.
 	std::sort(
-		chunks_queue.begin(), chunks_queue.end(),
-		[](const QueueChunk& l, const QueueChunk& r) { return l.weight > r.weight; });
+		candidates.begin(), candidates.end(),
+		[]( const PrefetchCandidate& l, const PrefetchCandidate& r )
+		{
+			return l.square_distance < r.square_distance;
+		});
+
+	for( const PrefetchCandidate& candidate : candidates )
+	{
+		if( chunks_in_preparation_ >= c_prefetch_max_chunks_in_preparation )
+			break;
+		RequestChunkGPUData( *candidate.chunk, predicted_tessellation_scale_bucket, true );
+	}
+}
+
+void MapDrawer::UploadPreparedChunks()
+{
+	// Limit size of uploaded per frame data, for prevention of long frames.
+#ifdef __ANDROID__
+	const size_t c_upload_budget= 2u * 1024u * 1024u;
+#else
+	const size_t c_upload_budget= 8u * 1024u * 1024u;
+#endif
+
+	{
+		std::lock_guard<std::mutex> lock( prepared_chunks_mutex_ );
+		for( PreparedChunk& prepared_chunk : prepared_chunks_ )
+			chunks_to_upload_.push_back( std::move(prepared_chunk) );
+		prepared_chunks_.clear();
+	}
+
+	// Upload requested for drawing chunks before prefetched chunks.
+	std::stable_partition(
+		chunks_to_upload_.begin(), chunks_to_upload_.end(),
+		[]( const PreparedChunk& prepared_chunk ) { return !prepared_chunk.prefetched; } );
+
+	// Upload at least one chunk per frame.
+	size_t uploaded_size= 0u;
+	size_t uploaded_count= 0u;
+	while( uploaded_count < chunks_to_upload_.size() && uploaded_size < c_upload_budget )
+	{
+		PreparedChunk& prepared_chunk= chunks_to_upload_[uploaded_count];
+		uploaded_size+= prepared_chunk.data.GetSize();
+		UploadChunk( prepared_chunk );
+		++uploaded_count;
+	}
+	PM_ASSERT( chunks_in_preparation_ >= uploaded_count );
+	chunks_in_preparation_-= uploaded_count;
+	chunks_to_upload_.erase( chunks_to_upload_.begin(), chunks_to_upload_.begin() + std::ptrdiff_t(uploaded_count) );
+
+	if( !chunks_to_upload_.empty() )
+		readraw_required_= true;
+}
+
+void MapDrawer::UploadChunk( PreparedChunk& prepared_chunk )
+{
+	Chunk& chunk= *prepared_chunk.chunk;
+	// Chunk was evicted or requested again after start of this task.
+	if( prepared_chunk.generation != chunk.preparation_generation_ )
+	{
+		++gpu_memory_statistics_.dropped_chunks;
+		return;
+	}
+	PM_ASSERT( chunk.preparation_in_progress_ );
+	chunk.preparation_in_progress_= false;
+
+	// Replace old data of rebuilt chunk.
+	if( chunk.gpu_data_state_ == Chunk::GPUDataState::Ready )
+		EvictChunk( chunk );
+
+	// Reused free buffers are already counted in GPU data size.
+	const size_t free_buffers_size_before= buffer_pools_->GetFreeSize();
+	chunk.UploadGPUData( prepared_chunk.data, *buffer_pools_ );
+	gpu_data_size_= gpu_data_size_ + chunk.GetGPUDataSize() - ( free_buffers_size_before - buffer_pools_->GetFreeSize() );
+	++gpu_memory_statistics_.uploaded_chunks;
+	chunk.resident_chunks_iterator_= resident_chunks_.insert( resident_chunks_.end(), &chunk );
+	chunk.last_used_frame_= frame_number_;
+}
+
+void MapDrawer::TouchChunk( Chunk& chunk )
+{
+	PM_ASSERT( chunk.gpu_data_state_ == Chunk::GPUDataState::Ready );
+
+	// Move to end of LRU list.
+	resident_chunks_.splice( resident_chunks_.end(), resident_chunks_, chunk.resident_chunks_iterator_ );
+	chunk.last_used_frame_= frame_number_;
+}
+
+void MapDrawer::EvictChunk( Chunk& chunk )
+{
+	PM_ASSERT( chunk.gpu_data_state_ == Chunk::GPUDataState::Ready );
+	PM_ASSERT( gpu_data_size_ >= chunk.GetGPUDataSize() );
+
+	// Buffers, kept in pools for reuse, are still counted in GPU data size.
+	const size_t free_buffers_size_before= buffer_pools_->GetFreeSize();
+	gpu_data_size_-= chunk.GetGPUDataSize();
+	++gpu_memory_statistics_.evicted_chunks;
+	resident_chunks_.erase( chunk.resident_chunks_iterator_ );
+	chunk.ClearGPUData( *buffer_pools_ );
+	gpu_data_size_+= buffer_pools_->GetFreeSize() - free_buffers_size_before;
+}
+
+void MapDrawer::SetGPUMemoryLimit( const size_t limit )
+{
+	gpu_memory_limit_= limit;
+
+	const size_t free_buffers_size_before= buffer_pools_->GetFreeSize();
+	buffer_pools_->SetMaxFreeSizePerPool( gpu_memory_limit_ / c_free_buffers_size_per_pool_limit_divider );
+	gpu_data_size_-= free_buffers_size_before - buffer_pools_->GetFreeSize();
+}
+
+size_t MapDrawer::GetGPUMemoryLimit() const
+{
+	return gpu_memory_limit_;
+}
+
+MapDrawer::GPUMemoryStatistics MapDrawer::GetGPUMemoryStatistics() const
+{
+	GPUMemoryStatistics result= gpu_memory_statistics_;
+	result.gpu_data_size= gpu_data_size_;
+	result.gpu_memory_limit= gpu_memory_limit_;
+	result.resident_chunks= resident_chunks_.size();
+	result.chunks_in_preparation= chunks_in_preparation_;
+	result.free_buffers_size= buffer_pools_->GetFreeSize();
+	return result;
+}
+
+MapDrawer::ZoomLevel& MapDrawer::SelectZoomLevel( const float scale )
+{
+	const float factor= GetZoomLevelSelectionFactor( system_window_ );
+	for( size_t i= 1u; i < zoom_levels_.size(); ++i )
+		if( scale * factor < float( 1u << zoom_levels_[i].zoom_level_log2 ) )
+			return zoom_levels_[i-1u];
+
+	return zoom_levels_.back();
+}
+
+void MapDrawer::ClearGPUData()
+{
+	if( gpu_data_size_ <= gpu_memory_limit_ )
+		return;
 
-	for( const QueueChunk& queue_chunk : chunks_queue )
+	// Clear GPU data of least recently drawn chunks.
+	// Chunks of zoom levels, different from current, and chunks far from camera are not drawn, so, they are cleared first.
+	// Do not clear chunks, drawn in current frame.
+	while( !resident_chunks_.empty() && gpu_data_size_ > gpu_memory_limit_ * 3u / 4u )
 	{
-		total_gpu_data_size-= queue_chunk.chunk->GetGPUDataSize();
-		queue_chunk.chunk->ClearGPUData();
-		if( total_gpu_data_size <= c_gpu_memory_limit * 3u / 4u )
+		Chunk& chunk= *resident_chunks_.front();
+		if( chunk.last_used_frame_ == frame_number_ )
 			break;
+		EvictChunk( chunk );
 	}
 }
 
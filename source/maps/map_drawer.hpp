@@ -1,4 +1,7 @@
 #pragma once
+#include <chrono>
+#include <list>
+#include <mutex>
 #include "../common/coordinates_conversion.hpp"
 #include "../common/memory_mapped_file.hpp"
 #include "../panzer_ogl_lib/glsl_program.hpp"
@@ -6,6 +9,7 @@
 #include "../panzer_ogl_lib/texture.hpp"
 #include "system_window.hpp"
 #include "ui_drawer.hpp"
+#include "worker_pool.hpp"
 
 namespace PanzerMaps
 {
@@ -29,13 +33,49 @@ public:
 
 	void SetGPSMarkerPosition( const GeoPoint& gps_marker_position );
 
+	// Limit of size of chunks GPU data, including free buffers, kept for reuse. Chunks, not used for long time, are cleared, if limit is exceeded.
+	void SetGPUMemoryLimit( size_t limit );
+	size_t GetGPUMemoryLimit() const;
+
+	struct GPUMemoryStatistics
+	{
+		size_t gpu_data_size= 0u; // Includes free buffers.
+		size_t gpu_memory_limit= 0u;
+		size_t resident_chunks= 0u;
+		size_t chunks_in_preparation= 0u;
+		size_t free_buffers_size= 0u; // Size of buffers, released by evicted chunks, waiting for reuse.
+		// Total counters, since start.
+		size_t uploaded_chunks= 0u;
+		size_t evicted_chunks= 0u;
+		size_t dropped_chunks= 0u; // Prepared chunks with stale data, not uploaded.
+	};
+	GPUMemoryStatistics GetGPUMemoryStatistics() const;
+
 private:
 	struct Chunk;
 	struct ZoomLevel;
 	struct ChunkToDraw;
+	struct DrawCommand;
+	struct PreparedChunk;
+	struct BufferPools;
 
 private:
-	ZoomLevel& SelectZoomLevel();
+	// Prepare chunk data in background, if worker threads exist, or immediately.
+	// Chunk with GPU data is rebuilt, if it was prepared for other tessellation scale bucket.
+	void RequestChunkGPUData( Chunk& chunk, int32_t tessellation_scale_bucket, bool prefetch= false );
+	void UpdateCameraVelocity();
+	// Request chunks, which will be visible soon, according to camera motion.
+	void PrefetchChunks();
+	// Upload data of chunks, prepared in background. Must be called from render thread.
+	void UploadPreparedChunks();
+
+	// Create GPU buffers and register chunk in list of chunks with GPU data.
+	void UploadChunk( PreparedChunk& prepared_chunk );
+	// Mark chunk as recently used.
+	void TouchChunk( Chunk& chunk );
+	void EvictChunk( Chunk& chunk );
+
+	ZoomLevel& SelectZoomLevel( float scale );
 	void ClearGPUData();
 
 private:
@@ -46,12 +86,25 @@ private:
 	r_GLSLProgram point_objets_shader_;
 	r_GLSLProgram linear_objets_shader_;
 	r_GLSLProgram linear_textured_objets_shader_;
+	r_GLSLProgram linear_extruded_objets_shader_;
 	r_GLSLProgram areal_objects_shader_;
 	r_GLSLProgram gps_marker_shader_;
+	// Locations of per-chunk uniforms, requested once after shaders creation.
+	GLint point_objets_view_matrix_uniform_= -1;
+	GLint linear_objets_view_matrix_uniform_= -1;
+	GLint linear_textured_objets_view_matrix_uniform_= -1;
+	GLint linear_extruded_objets_view_matrix_uniform_= -1;
+	GLint areal_objects_view_matrix_uniform_= -1;
 	r_Texture copyright_texture_;
 	r_Texture north_arrow_texture_;
 
 	std::vector<ZoomLevel> zoom_levels_;
+	std::vector<DrawCommand> draw_commands_; // Reused between frames.
+#ifndef PM_OPENGL_ES
+	// Index ranges for glMultiDrawElements. Reused between frames.
+	std::vector<GLsizei> draw_ranges_counts_;
+	std::vector<const void*> draw_ranges_offsets_;
+#endif
 
 	size_t frame_number_= 0u;
 	bool readraw_required_= true;
@@ -71,6 +124,39 @@ private:
 	GeoPoint gps_marker_position_{ 1000.0, 1000.0 };
 
 	unsigned char background_color_[4]= {0};
+
+	// Camera motion, for chunks prefetch.
+	std::chrono::steady_clock::time_point prev_camera_time_;
+	m_Vec2 prev_cam_pos_;
+	float prev_scale_;
+	m_Vec2 cam_velocity_{ 0.0f, 0.0f }; // Map units per second.
+	float scale_log2_velocity_= 0.0f;
+
+	// GPU memory manager. Chunks with GPU data are ordered from least to most recently used.
+	size_t gpu_memory_limit_;
+	size_t gpu_data_size_= 0u; // Data of resident chunks and free buffers in pools.
+	std::list<Chunk*> resident_chunks_;
+	GPUMemoryStatistics gpu_memory_statistics_;
+	std::unique_ptr<BufferPools> buffer_pools_;
+	// Index format of GPU buffers, selected by map file.
+	size_t vertex_index_size_= sizeof(uint16_t);
+	GLenum vertex_index_type_= GL_UNSIGNED_SHORT;
+
+	// Number of chunks in background preparation or waiting for upload.
+	size_t chunks_in_preparation_= 0u;
+	// Chunks, prepared by workers. Access only under mutex.
+	std::mutex prepared_chunks_mutex_;
+	std::vector<PreparedChunk> prepared_chunks_;
+	// Prepared chunks, waiting for upload. Accessed only from render thread.
+	std::vector<PreparedChunk> chunks_to_upload_;
+
+	std::chrono::steady_clock::duration frame_time_sum_{0};
+	std::chrono::steady_clock::duration frame_time_max_{0};
+	std::chrono::steady_clock::duration chunks_preparation_time_sum_{0};
+	size_t frame_time_frames_= 0u;
+
+	// Null, if chunks are prepared synchronously. Must be destroyed before chunks.
+	std::unique_ptr<WorkerPool> worker_pool_;
 };
 
 } // namespace PanzerMaps
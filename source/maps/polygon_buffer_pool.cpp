@@ -0,0 +1,117 @@
+#include "../common/assert.hpp"
+#include "polygon_buffer_pool.hpp"
+
+namespace PanzerMaps
+{
+
+static const uint32_t c_min_buffer_capacity_log2= 10u; // 1kb
+// Capacity is rounded up to one of 4 steps inside each power of two, so, capacity is at most 25% bigger, than data.
+static const uint32_t c_capacity_classes_per_power_of_two_log2= 2u;
+
+PolygonBufferPool::PolygonBufferPool(
+	const size_t vertex_size,
+	const GLenum index_type,
+	const GLenum primitive_type,
+	BufferSetupFunction setup_function,
+	const size_t max_free_size )
+	: vertex_size_(vertex_size), index_type_(index_type), primitive_type_(primitive_type)
+	, setup_function_(std::move(setup_function)), max_free_size_(max_free_size)
+{}
+
+PolygonBufferPool::Buffer PolygonBufferPool::Acquire( const void* const vertex_data, const size_t vertex_data_size, const void* const index_data, const size_t index_data_size )
+{
+	Buffer result;
+	if( vertex_data_size == 0u )
+		return result;
+
+	const uint32_t vertex_capacity_class= GetCapacityClass( vertex_data_size );
+	const uint32_t index_capacity_class= index_type_ == 0u ? 0u : GetCapacityClass( index_data_size );
+	const size_t vertex_capacity= GetClassCapacity( vertex_capacity_class );
+	const size_t index_capacity= index_type_ == 0u ? 0u : GetClassCapacity( index_capacity_class );
+
+	const auto it= free_buffers_.find( vertex_capacity_class | ( index_capacity_class << 16u ) );
+	if( it != free_buffers_.end() && !it->second.empty() )
+	{
+		result= std::move( it->second.back() );
+		it->second.pop_back();
+		free_size_-= result.vertex_capacity + result.index_capacity;
+
+		result.polygon_buffer.VertexSubData( vertex_data, vertex_data_size, 0u );
+		if( index_type_ != 0u && index_data_size > 0u )
+			result.polygon_buffer.IndexSubData( index_data, index_data_size, 0u );
+	}
+	else
+	{
+		// Allocate storage with full capacity, than upload data.
+		result.vertex_capacity= vertex_capacity;
+		result.index_capacity= index_capacity;
+		result.polygon_buffer.VertexData( nullptr, vertex_capacity, vertex_size_ );
+		result.polygon_buffer.VertexSubData( vertex_data, vertex_data_size, 0u );
+		if( index_type_ != 0u )
+		{
+			result.polygon_buffer.IndexData( nullptr, index_capacity, index_type_, primitive_type_ );
+			if( index_data_size > 0u )
+				result.polygon_buffer.IndexSubData( index_data, index_data_size, 0u );
+		}
+		else
+			result.polygon_buffer.SetPrimitiveType( primitive_type_ );
+		setup_function_( result.polygon_buffer );
+	}
+
+	result.vertex_data_size= vertex_data_size;
+	result.index_data_size= index_data_size;
+	return result;
+}
+
+void PolygonBufferPool::Release( Buffer& buffer )
+{
+	if( buffer.vertex_capacity == 0u )
+		return;
+
+	const size_t capacity= buffer.vertex_capacity + buffer.index_capacity;
+	if( free_size_ + capacity <= max_free_size_ )
+	{
+		const SizeClass size_class=
+			GetCapacityClass( buffer.vertex_capacity ) |
+			( index_type_ == 0u ? 0u : GetCapacityClass( buffer.index_capacity ) << 16u );
+		free_size_+= capacity;
+		free_buffers_[ size_class ].push_back( std::move(buffer) );
+	}
+	// Else - buffer is destroyed.
+
+	buffer= Buffer();
+}
+
+void PolygonBufferPool::SetMaxFreeSize( const size_t max_free_size )
+{
+	max_free_size_= max_free_size;
+	for( auto& size_class_buffers : free_buffers_ )
+	{
+		std::vector<Buffer>& buffers= size_class_buffers.second;
+		while( free_size_ > max_free_size_ && !buffers.empty() )
+		{
+			free_size_-= buffers.back().vertex_capacity + buffers.back().index_capacity;
+			buffers.pop_back();
+		}
+	}
+}
+
+// Class is power of two log2 in high bits and step inside power of two in low bits.
+uint32_t PolygonBufferPool::GetCapacityClass( const size_t data_size )
+{
+	uint32_t capacity_class= c_min_buffer_capacity_log2 << c_capacity_classes_per_power_of_two_log2;
+	while( GetClassCapacity( capacity_class ) < data_size )
+		++capacity_class;
+	PM_ASSERT( capacity_class < 65536u );
+	return capacity_class;
+}
+
+size_t PolygonBufferPool::GetClassCapacity( const uint32_t capacity_class )
+{
+	// Capacity is ( steps + step ) * 2^( log2 - steps_log2 ), where step is in range [0; steps).
+	const uint32_t log2= capacity_class >> c_capacity_classes_per_power_of_two_log2;
+	const uint32_t step= capacity_class & ( ( 1u << c_capacity_classes_per_power_of_two_log2 ) - 1u );
+	return size_t( ( 1u << c_capacity_classes_per_power_of_two_log2 ) + step ) << ( log2 - c_capacity_classes_per_power_of_two_log2 );
+}
+
+} // namespace PanzerMaps
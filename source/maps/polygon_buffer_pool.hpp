@@ -0,0 +1,62 @@
+#pragma once
+#include <cstdint>
+#include <functional>
+#include <unordered_map>
+#include <vector>
+#include "../panzer_ogl_lib/polygon_buffer.hpp"
+
+namespace PanzerMaps
+{
+
+// Pool of polygon buffers with same vertex format.
+// Buffers are allocated with capacity, rounded up to one of 4 size classes per power of two, and reused after release.
+// Data of reused buffers is updated via "glBufferSubData", so, driver does not allocate memory again.
+class PolygonBufferPool final
+{
+public:
+	// Sets vertex attributes and primitive type of new buffer. Called after vertex and index data allocation.
+	using BufferSetupFunction= std::function<void( r_PolygonBuffer& buffer )>;
+
+	// Buffer with actual data size. Capacity may be greater.
+	struct Buffer
+	{
+		r_PolygonBuffer polygon_buffer;
+		size_t vertex_data_size= 0u;
+		size_t index_data_size= 0u;
+		size_t vertex_capacity= 0u;
+		size_t index_capacity= 0u;
+	};
+
+	// "index_type" is zero for buffers without indices.
+	PolygonBufferPool( size_t vertex_size, GLenum index_type, GLenum primitive_type, BufferSetupFunction setup_function, size_t max_free_size );
+
+	PolygonBufferPool( const PolygonBufferPool& )= delete;
+	PolygonBufferPool& operator=( const PolygonBufferPool& )= delete;
+
+	// Returns empty buffer without GPU objects for empty data.
+	Buffer Acquire( const void* vertex_data, size_t vertex_data_size, const void* index_data, size_t index_data_size );
+	void Release( Buffer& buffer );
+
+	// Size of released buffers, waiting for reuse.
+	size_t GetFreeSize() const { return free_size_; }
+	// Destroys free buffers, if their size exceeds new limit.
+	void SetMaxFreeSize( size_t max_free_size );
+
+private:
+	using SizeClass= uint32_t; // Vertex capacity class in low bits, index capacity class in high bits.
+
+	static uint32_t GetCapacityClass( size_t data_size );
+	static size_t GetClassCapacity( uint32_t capacity_class );
+
+private:
+	const size_t vertex_size_;
+	const GLenum index_type_;
+	const GLenum primitive_type_;
+	const BufferSetupFunction setup_function_;
+	size_t max_free_size_;
+
+	std::unordered_map< SizeClass, std::vector<Buffer> > free_buffers_;
+	size_t free_size_= 0u;
+};
+
+} // namespace PanzerMaps
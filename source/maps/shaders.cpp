@@ -48,11 +48,11 @@ R"(
 	uniform sampler2D tex;
 	uniform highp mat4 view_matrix;
 	in highp vec2 pos;
-	in highp vec2 tex_coord;
+	in highp float color_index;
 	out lowp vec4 f_color;
 	void main()
 	{
-		f_color= texelFetch( tex, ivec2( int(tex_coord.x), 0 ), 0 );
+		f_color= texelFetch( tex, ivec2( int(color_index), 0 ), 0 );
 		gl_Position= view_matrix * vec4( pos, 0.0, 1.0 );
 	}
 )";
@@ -68,17 +68,40 @@ R"(
 	}
 )";
 
+const char linear_extruded_vertex[]=
+GLSL_VERSION
+R"(
+	uniform sampler2D tex;
+	uniform highp mat4 view_matrix;
+	in highp vec2 pos;
+	in highp vec2 extrude;
+	in highp float color_index;
+	out lowp vec4 f_color;
+	void main()
+	{
+		// First texture row contains colors, second - line widths, multiplied by 256, in bytes of texel.
+		f_color= texelFetch( tex, ivec2( int(color_index), 0 ), 0 );
+		highp vec4 width_bytes= floor( texelFetch( tex, ivec2( int(color_index), 1 ), 0 ) * 255.0 + vec4( 0.5 ) );
+		highp float width= dot( width_bytes, vec4( 1.0, 256.0, 65536.0, 16777216.0 ) ) / 256.0;
+		// Extrusion vector is scaled by 8192, width is converted into half width.
+		gl_Position= view_matrix * vec4( pos + extrude * ( width / 16384.0 ), 0.0, 1.0 );
+	}
+)";
+
 const char linear_textured_vertex[]=
 GLSL_VERSION
 R"(
 	uniform highp mat4 view_matrix;
 	in highp vec2 pos;
-	in highp vec2 tex_coord;
+	in highp vec2 pos_fraction;
+	in mediump float tex_coord_x;
+	in highp float tex_coord_y;
 	out mediump vec2 f_tex_coord;
 	void main()
 	{
-		f_tex_coord= tex_coord;
-		gl_Position= view_matrix * vec4( pos, 0.0, 1.0 );
+		f_tex_coord= vec2( tex_coord_x, tex_coord_y );
+		// Position is fixed point, with 8 bits of fraction.
+		gl_Position= view_matrix * vec4( pos + pos_fraction / 256.0, 0.0, 1.0 );
 	}
 )";
 
@@ -12,6 +12,8 @@ extern const char point_fragment[];
 extern const char linear_vertex[];
 extern const char linear_fragment[];
 
+extern const char linear_extruded_vertex[];
+
 extern const char linear_textured_vertex[];
 extern const char linear_textured_fragment[];
 
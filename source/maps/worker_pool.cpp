@@ -0,0 +1,55 @@
+#include "worker_pool.hpp"
+
+namespace PanzerMaps
+{
+
+WorkerPool::WorkerPool( const size_t thread_count )
+{
+	threads_.reserve( thread_count );
+	for( size_t i= 0u; i < thread_count; ++i )
+		threads_.emplace_back( &WorkerPool::ThreadFunc, this );
+}
+
+WorkerPool::~WorkerPool()
+{
+	{
+		std::lock_guard<std::mutex> lock( mutex_ );
+		quit_= true;
+		high_priority_tasks_.clear();
+		low_priority_tasks_.clear();
+	}
+	condition_.notify_all();
+
+	for( std::thread& thread : threads_ )
+		thread.join();
+}
+
+void WorkerPool::Push( Task task, const Priority priority )
+{
+	{
+		std::lock_guard<std::mutex> lock( mutex_ );
+		( priority == Priority::High ? high_priority_tasks_ : low_priority_tasks_ ).push_back( std::move(task) );
+	}
+	condition_.notify_one();
+}
+
+void WorkerPool::ThreadFunc()
+{
+	while(true)
+	{
+		Task task;
+		{
+			std::unique_lock<std::mutex> lock( mutex_ );
+			condition_.wait( lock, [this] { return quit_ || !high_priority_tasks_.empty() || !low_priority_tasks_.empty(); } );
+			if( quit_ )
+				return;
+
+			std::deque<Task>& tasks= high_priority_tasks_.empty() ? low_priority_tasks_ : high_priority_tasks_;
+			task= std::move( tasks.front() );
+			tasks.pop_front();
+		}
+		task();
+	}
+}
+
+} // namespace PanzerMaps
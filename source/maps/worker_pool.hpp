@@ -0,0 +1,46 @@
+#pragma once
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace PanzerMaps
+{
+
+// Simple pool of threads for background tasks.
+// Tasks with same priority are executed in order of pushing. Not started tasks are discarded on pool destruction.
+class WorkerPool final
+{
+public:
+	using Task= std::function<void()>;
+
+	enum class Priority
+	{
+		High,
+		Low, // Low priority tasks are started only if there are no high priority tasks.
+	};
+
+	explicit WorkerPool( size_t thread_count );
+	~WorkerPool();
+
+	WorkerPool( const WorkerPool& )= delete;
+	WorkerPool& operator=( const WorkerPool& )= delete;
+
+	void Push( Task task, Priority priority= Priority::High );
+
+private:
+	void ThreadFunc();
+
+private:
+	std::mutex mutex_;
+	std::condition_variable condition_;
+	std::deque<Task> high_priority_tasks_;
+	std::deque<Task> low_priority_tasks_;
+	bool quit_= false;
+
+	std::vector<std::thread> threads_;
+};
+
+} // namespace PanzerMaps